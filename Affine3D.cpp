@@ -0,0 +1,30 @@
+// Created by liorP.
+//
+
+#include "Affine3D.h"
+#include "Transform.h"
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the batched Affine3D apply.
+// --------------------------------------------------------------------------------------
+
+/**
+* out[i] = transform * in[i], in a single pass
+* @param transform to apply
+* @param in points to transform
+* @param out transformed points, same size as in. may be the same range as in
+*/
+void apply_batch(const Affine3D &transform, const Span<const Vector3D> in, const Span<Vector3D> out)
+{
+    transform_batch(transform.linear(), transform.translation(), in, out);
+}
+
+/**
+* points[i] = transform * points[i], in a single pass
+* @param transform to apply
+* @param points points to transform in place
+*/
+void apply_batch(const Affine3D &transform, const Span<Vector3D> points)
+{
+    apply_batch(transform, points, points);
+}
@@ -0,0 +1,157 @@
+// Created by liorP.
+//
+
+#ifndef EX1_AFFINE3D_H
+#define EX1_AFFINE3D_H
+
+#include "Quaternion.h"
+#include "Span.h"
+
+// --------------------------------------------------------------------------------------
+// An affine transform, x -> linear * x + translation, as a Matrix3D and a Vector3D.
+// The batched apply is the transform kernel with the translation folded into its first fma,
+// one pass over the points instead of a transform_batch and a second pass adding the
+// translation. A rigid transform (a rotation linear part) inverts with a transpose.
+// --------------------------------------------------------------------------------------
+
+/**
+ * An Affine3D class.
+ * This class represents the transform x -> linear * x + translation. a * b applies b then a,
+ * like the product of matrices.
+ */
+class Affine3D
+{
+public:
+    /**
+     * A default constructor - the identity transform.
+     */
+    constexpr Affine3D() : _linear(1.0), _translation() {}
+
+    /**
+     * A constructor.
+     * @param linear the linear part
+     * @param translation added after the linear part
+     */
+    constexpr Affine3D(const Matrix3D &linear, const Vector3D &translation) : _linear(linear),
+                                                                             _translation(translation) {}
+
+    /**
+     * A constructor - a rigid transform.
+     * @param rotation unit quaternion of the rotation
+     * @param translation added after the rotation
+     */
+    constexpr Affine3D(const Quaternion &rotation, const Vector3D &translation) : _linear(rotation.matrix()),
+                                                                                 _translation(translation) {}
+
+    /**
+     * @return the linear part
+     */
+    constexpr const Matrix3D &linear() const { return _linear; }
+
+    /**
+     * @return the translation
+     */
+    constexpr const Vector3D &translation() const { return _translation; }
+
+    /**
+     * * operator overload as the composition of transforms
+     * @param other the transform applied first
+     * @return the composition
+     */
+    constexpr Affine3D operator*(const Affine3D &other) const;
+
+    /**
+     * *= operator overload, *this = *this * other
+     * @param other the transform applied first
+     * @return reference to this transform
+     */
+    constexpr Affine3D &operator*=(const Affine3D &other);
+
+    /**
+     * * operator overload, transforms a point
+     * @param point to transform
+     * @return linear * point + translation
+     */
+    constexpr Vector3D operator*(const Vector3D &point) const { return _linear * point + _translation; }
+
+    /**
+     * the inverse of a rigid transform, by transposing the rotation.
+     * @return the inverse, for a linear part that is a rotation
+     */
+    constexpr Affine3D rigid_inverse() const;
+
+    /**
+     * the inverse of any invertible transform. reports an error if the linear part is singular,
+     * and the result is then that of Matrix::inverse (see Errors.h).
+     * @param tolerance of the singularity test, see Matrix::is_singular
+     * @return the inverse
+     */
+    constexpr Affine3D inverse(double tolerance = SINGULAR_TOLERANCE) const;
+
+private:
+    Matrix3D _linear; /**< the linear part. */
+    Vector3D _translation; /**< the translation. */
+
+};
+
+// copied as raw bytes, like Matrix3D
+static_assert(is_trivially_copyable<Affine3D>::value, "Affine3D is copied with memcpy");
+
+/**
+* * operator overload as the composition of transforms
+* @param other the transform applied first
+* @return the composition
+*/
+constexpr Affine3D Affine3D::operator*(const Affine3D &other) const
+{
+    return Affine3D(_linear * other._linear, _linear * other._translation + _translation);
+}
+
+/**
+* *= operator overload, *this = *this * other
+* @param other the transform applied first
+* @return reference to this transform
+*/
+constexpr Affine3D &Affine3D::operator*=(const Affine3D &other)
+{
+    return *this = *this * other;
+}
+
+/**
+* the inverse of a rigid transform, by transposing the rotation.
+* @return the inverse, for a linear part that is a rotation
+*/
+constexpr Affine3D Affine3D::rigid_inverse() const
+{
+    Matrix3D rotation = _linear.transpose();
+    return Affine3D(rotation, - (rotation * _translation));
+}
+
+/**
+* the inverse of any invertible transform. reports an error if the linear part is singular,
+* and the result is then that of Matrix::inverse (see Errors.h).
+* @param tolerance of the singularity test, see Matrix::is_singular
+* @return the inverse
+*/
+constexpr Affine3D Affine3D::inverse(const double tolerance) const
+{
+    Matrix3D linear = _linear.inverse(tolerance);
+    return Affine3D(linear, - (linear * _translation));
+}
+
+/**
+ * out[i] = transform * in[i], in a single pass
+ * @param transform to apply
+ * @param in points to transform
+ * @param out transformed points, same size as in. may be the same range as in
+ */
+void apply_batch(const Affine3D &transform, Span<const Vector3D> in, Span<Vector3D> out);
+
+/**
+ * points[i] = transform * points[i], in a single pass
+ * @param transform to apply
+ * @param points points to transform in place
+ */
+void apply_batch(const Affine3D &transform, Span<Vector3D> points);
+
+#endif //EX1_AFFINE3D_H
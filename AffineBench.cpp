@@ -0,0 +1,102 @@
+// Created by liorP.
+//
+
+#include "Affine3D.h"
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "Transform.h"
+
+/**
+ * number of points of the cache resident runs.
+ */
+#define CACHED (1 << 12)
+
+/**
+ * number of points of the memory bound runs.
+ */
+#define AFFINE_POINTS (BENCH_ARRAY * 4)
+
+// --------------------------------------------------------------------------------------
+// Benchmarks of applying a Matrix3D and a translation to arrays of points: the two passes
+// of a transform_batch followed by adding the translation, a loop over Affine3D * Vector3D,
+// and the single pass apply_batch. The memory bound runs are where the second pass costs a
+// second trip through memory.
+// --------------------------------------------------------------------------------------
+
+/**
+ * benchmarks the ways to apply an affine transform to points.
+ * @param bench to measure with
+ */
+static void affineApply(Bench &bench)
+{
+    const Affine3D transform(bench_matrices(1)[0], bench_points(1, 5)[0]);
+    for (size_t count : {(size_t) CACHED, (size_t) AFFINE_POINTS})
+    {
+        const vector<Vector3D> points = bench_points(count);
+        vector<Vector3D> out(count);
+        const string suffix = "/" + to_string(count);
+        bench.measure("transform_batch + translation loop" + suffix, count, [&]() {
+            transform_batch(transform.linear(), points, out);
+            for (Vector3D &p : out)
+            {
+                p += transform.translation();
+            }
+            keep(out);
+        });
+        bench.measure("loop Affine3D * Vector3D" + suffix, count, [&]() {
+            for (size_t i = 0; i < count; ++ i)
+            {
+                out[i] = transform * points[i];
+            }
+            keep(out);
+        });
+        bench.measure("apply_batch" + suffix, count, [&]() {
+            apply_batch(transform, points, out);
+            keep(out);
+        });
+        bench.measure("apply_batch in place" + suffix, count, [&]() {
+            apply_batch(transform, out);
+            keep(out);
+        });
+    }
+}
+
+/**
+ * benchmarks composing and inverting transforms.
+ * @param bench to measure with
+ */
+static void affineAlgebra(Bench &bench)
+{
+    const vector<Matrix3D> matrices = bench_matrices(CACHED);
+    const vector<Vector3D> translations = bench_points(CACHED);
+    vector<Affine3D> transforms(CACHED), rigid(CACHED), out(CACHED);
+    for (size_t i = 0; i < CACHED; ++ i)
+    {
+        transforms[i] = Affine3D(matrices[i], translations[i]);
+        rigid[i] = Affine3D(Quaternion::from_axis_angle(translations[i], 1), translations[i]);
+    }
+    bench.measure("loop Affine3D * Affine3D", CACHED, [&]() {
+        for (size_t i = 0; i + 1 < CACHED; ++ i)
+        {
+            out[i] = transforms[i] * transforms[i + 1];
+        }
+        keep(out);
+    });
+    bench.measure("loop Affine3D::inverse", CACHED, [&]() {
+        for (size_t i = 0; i < CACHED; ++ i)
+        {
+            out[i] = rigid[i].inverse();
+        }
+        keep(out);
+    });
+    bench.measure("loop Affine3D::rigid_inverse", CACHED, [&]() {
+        for (size_t i = 0; i < CACHED; ++ i)
+        {
+            out[i] = rigid[i].rigid_inverse();
+        }
+        keep(out);
+    });
+}
+
+BENCHMARK(affineApply);
+BENCHMARK(affineAlgebra);
@@ -0,0 +1,184 @@
+// Created by liorP.
+//
+
+#include <cstdint>
+#include <new>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "Arena.h"
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the class Arena.
+// --------------------------------------------------------------------------------------
+
+/**
+ * size of a transparent huge page.
+ */
+#define HUGE_PAGE ((size_t) 2 << 20)
+
+/**
+ * offset of the memory of a block from its start, keeps the first allocation aligned.
+ */
+#define BLOCK_HEADER ((sizeof(Block) + SIMD_ALIGN - 1) / SIMD_ALIGN * SIMD_ALIGN)
+
+/**
+ * @param value to round up
+ * @param alignment a power of 2
+ * @return value rounded up to a multiple of alignment
+ */
+static size_t alignUp(size_t value, size_t alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * maps memory for a block. blocks of a huge page or more are huge page aligned, so the
+ * kernel can back them with huge pages.
+ * @param bytes size of the block, a multiple of the page size
+ * @return the memory
+ */
+static void *mapBlock(size_t bytes)
+{
+    size_t slack = bytes >= HUGE_PAGE ? HUGE_PAGE : 0;
+    void *map = mmap(nullptr, bytes + slack, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, - 1, 0);
+    if (map == MAP_FAILED)
+    {
+        throw bad_alloc();
+    }
+    char *start = static_cast<char *>(map);
+    if (slack != 0)
+    {
+        // trims the mapping to the aligned range
+        char *aligned = reinterpret_cast<char *>(alignUp(reinterpret_cast<size_t>(start), HUGE_PAGE));
+        if (aligned != start)
+        {
+            munmap(start, (size_t) (aligned - start));
+        }
+        if (aligned + bytes != start + bytes + slack)
+        {
+            munmap(aligned + bytes, (size_t) (start + bytes + slack - (aligned + bytes)));
+        }
+        start = aligned;
+        madvise(start, bytes, MADV_HUGEPAGE);
+    }
+    return start;
+}
+
+// ------------------ Constructors ------------------------
+
+/**
+* A constructor - maps nothing until the first allocation.
+* @param block size of a block, rounded up to whole pages
+*/
+Arena::Arena(const size_t block) : _first(nullptr), _current(nullptr), _next(nullptr), _end(nullptr),
+                                   _block(alignUp(max(block, BLOCK_HEADER + SIMD_ALIGN), (size_t) getpagesize())),
+                                   _used(0), _reserved(0)
+{
+}
+
+/**
+* A destructor - unmaps the blocks.
+*/
+Arena::~Arena()
+{
+    release();
+}
+
+// ------------------ Methods ------------------------
+
+/**
+* frees everything allocated from the arena, in O(1). the blocks stay mapped.
+*/
+void Arena::reset()
+{
+    if (_first != nullptr)
+    {
+        use(_first);
+    }
+    _used = 0;
+}
+
+/**
+* frees everything allocated from the arena and unmaps the blocks.
+*/
+void Arena::release()
+{
+    while (_first != nullptr)
+    {
+        Block *next = _first->next;
+        munmap(_first, _first->size);
+        _first = next;
+    }
+    _current = nullptr;
+    _next = _end = nullptr;
+    _used = _reserved = 0;
+}
+
+/**
+* allocates from the current block, or moves to the next one.
+* @param bytes to allocate
+* @param alignment of the memory, at least SIMD_ALIGN is used
+* @return the memory
+*/
+void *Arena::do_allocate(const size_t bytes, size_t alignment)
+{
+    alignment = max(alignment, (size_t) SIMD_ALIGN);
+    char *memory = reinterpret_cast<char *>(alignUp(reinterpret_cast<size_t>(_next), alignment));
+    if (_next == nullptr || memory > _end || bytes > (size_t) (_end - memory))
+    {
+        return grow(bytes, alignment);
+    }
+    _used += (size_t) (memory + bytes - _next);
+    _next = memory + bytes;
+    return memory;
+}
+
+/**
+* moves to a block with room for bytes, the next one or a new one. throws bad_alloc if the
+* block would not fit a size_t of bytes.
+* @param bytes to allocate
+* @param alignment of the memory
+* @return the memory
+*/
+void *Arena::grow(const size_t bytes, const size_t alignment)
+{
+    // the size is rounded up to pages, and mapBlock may add a huge page of slack
+    const size_t page = (size_t) getpagesize(), limit = SIZE_MAX - BLOCK_HEADER - HUGE_PAGE - page;
+    if (alignment > limit || bytes > limit - alignment)
+    {
+        throw bad_alloc();
+    }
+    size_t needed = BLOCK_HEADER + alignment + bytes;
+    Block *next = _current == nullptr ? _first : _current->next;
+    if (next == nullptr || next->size < needed)
+    {
+        // a new block, linked in after the current one
+        size_t size = max(_block, alignUp(needed, page));
+        auto block = static_cast<Block *>(mapBlock(size));
+        block->size = size;
+        block->next = next;
+        if (_current == nullptr)
+        {
+            _first = block;
+        }
+        else
+        {
+            _current->next = block;
+        }
+        _reserved += size;
+        next = block;
+    }
+    use(next);
+    return do_allocate(bytes, alignment);
+}
+
+/**
+* makes block the current block.
+* @param block to allocate from
+*/
+void Arena::use(Block *block)
+{
+    _current = block;
+    _next = reinterpret_cast<char *>(block) + BLOCK_HEADER;
+    _end = reinterpret_cast<char *>(block) + block->size;
+}
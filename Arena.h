@@ -0,0 +1,135 @@
+// Created by liorP.
+//
+
+#ifndef EX1_ARENA_H
+#define EX1_ARENA_H
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+#include "Matrix3D.h"
+#include "Simd.h"
+
+// --------------------------------------------------------------------------------------
+// A scratch arena for the short lived buffers of a frame, as a std::pmr memory resource.
+// Allocation bumps a pointer through large blocks mapped straight from the system (2 MiB
+// aligned and marked for transparent huge pages), deallocation does nothing, and reset()
+// makes all the blocks free again in O(1). The blocks are kept for the next frame, so a
+// steady state frame loop makes no system calls at all.
+// The pmr containers below allocate from any memory resource: an Arena, a
+// std::pmr::unsynchronized_pool_resource, or by default new and delete.
+// --------------------------------------------------------------------------------------
+
+/**
+ * default size of an arena block, a huge page.
+ */
+#define ARENA_BLOCK (2 << 20)
+
+/**
+ * a vector of Vector3D that allocates from a memory resource.
+ */
+typedef pmr::vector<Vector3D> Vector3DBuffer;
+
+/**
+ * a vector of Matrix3D that allocates from a memory resource.
+ */
+typedef pmr::vector<Matrix3D> Matrix3DBuffer;
+
+/**
+ * A bump allocator with O(1) reset. Not thread safe: an arena per thread or per frame.
+ */
+class Arena : public pmr::memory_resource
+{
+public:
+    /**
+     * A constructor - maps nothing until the first allocation.
+     * @param block size of a block, rounded up to whole pages
+     */
+    explicit Arena(size_t block = ARENA_BLOCK);
+
+    Arena(const Arena &other) = delete;
+
+    Arena &operator=(const Arena &other) = delete;
+
+    /**
+     * A destructor - unmaps the blocks.
+     */
+    ~Arena() override;
+
+    /**
+     * frees everything allocated from the arena, in O(1). the blocks stay mapped.
+     * memory allocated before must not be used (or deallocated) anymore.
+     */
+    void reset();
+
+    /**
+     * frees everything allocated from the arena and unmaps the blocks.
+     */
+    void release();
+
+    /**
+     * @return bytes allocated since the last reset, alignment padding included
+     */
+    size_t used() const { return _used; }
+
+    /**
+     * @return bytes of the mapped blocks
+     */
+    size_t reserved() const { return _reserved; }
+
+protected:
+    /**
+     * allocates from the current block, or moves to the next one.
+     * @param bytes to allocate
+     * @param alignment of the memory, at least SIMD_ALIGN is used
+     * @return the memory
+     */
+    void *do_allocate(size_t bytes, size_t alignment) override;
+
+    /**
+     * does nothing, the memory is freed by reset.
+     */
+    void do_deallocate(void *, size_t, size_t) override {}
+
+    /**
+     * @param other resource to compare with
+     * @return true if other is this arena
+     */
+    bool do_is_equal(const pmr::memory_resource &other) const noexcept override { return this == &other; }
+
+private:
+    /**
+     * The header at the start of a block.
+     */
+    struct Block
+    {
+        Block *next; /**< the next block of the chain. */
+        size_t size; /**< bytes of the block, the header included. */
+    };
+
+    /**
+     * moves to a block with room for bytes, the next one or a new one. throws bad_alloc if the
+     * block would not fit a size_t of bytes.
+     * @param bytes to allocate
+     * @param alignment of the memory
+     * @return the memory
+     */
+    void *grow(size_t bytes, size_t alignment);
+
+    /**
+     * makes block the current block.
+     * @param block to allocate from
+     */
+    void use(Block *block);
+
+    Block *_first; /**< the first block of the chain. */
+    Block *_current; /**< the block allocated from. */
+    char *_next; /**< the free memory of the current block. */
+    char *_end; /**< end of the current block. */
+    size_t _block; /**< size of a block. */
+    size_t _used; /**< bytes allocated since the last reset. */
+    size_t _reserved; /**< bytes of the mapped blocks. */
+
+};
+
+#endif //EX1_ARENA_H
@@ -0,0 +1,102 @@
+// Created by liorP.
+//
+
+#include "Arena.h"
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "Transform.h"
+
+/**
+ * number of scratch buffers a frame makes.
+ */
+#define FRAME_BUFFERS 1024
+
+/**
+ * number of scratch buffers of a frame alive at the same time in the short lived runs.
+ */
+#define FRAME_LIVE 8
+
+/**
+ * number of points of the largest scratch buffer.
+ */
+#define FRAME_MAX_POINTS 1024
+
+// --------------------------------------------------------------------------------------
+// Allocator churn benchmarks: a frame makes FRAME_BUFFERS point buffers of mixed sizes and
+// as many matrix buffers, and fills them with the batch kernels. The point buffers either
+// die young (FRAME_LIVE alive at a time), or all live to the end of the frame.
+// The same frame runs over vector (new and delete), over pmr buffers from a pool resource,
+// and over pmr buffers from an Arena that is reset per frame.
+// --------------------------------------------------------------------------------------
+
+/**
+ * @param i index of a buffer in the frame
+ * @return number of points of the buffer, 16 to FRAME_MAX_POINTS
+ */
+static size_t bufferPoints(size_t i)
+{
+    return (size_t) 16 << (i * 5 % 7);
+}
+
+/**
+ * runs a frame.
+ * @param source points to transform
+ * @param matrices FRAME_MAX_POINTS matrices to multiply
+ * @param alive number of point buffers alive at a time
+ * @param resource the memory resource of the buffers, none for vector
+ * @return a point of every buffer, summed
+ */
+template<typename Points, typename Matrices, typename... Resource>
+static Vector3D frame(Span<const Vector3D> source, Span<const Matrix3D> matrices, size_t alive, Resource... resource)
+{
+    Vector3D sum;
+    vector<Points> live;
+    live.reserve(alive);
+    for (size_t i = 0; i < FRAME_BUFFERS; ++ i)
+    {
+        size_t count = bufferPoints(i);
+        if (live.size() == alive)
+        {
+            live.erase(live.begin());
+        }
+        live.emplace_back(count, resource...);
+        transform_batch(matrices[i], source.subspan(0, count), live.back());
+        Matrices products(count / 16, resource...);
+        multiply_batch(matrices.subspan(0, count / 16), matrices.subspan(count / 16, count / 16), products);
+        sum += live.back()[count - 1] + products[0][0];
+    }
+    return sum;
+}
+
+/**
+ * benchmarks the frame over the allocators.
+ * @param bench to measure with
+ */
+static void arenaFrames(Bench &bench)
+{
+    vector<Vector3D> source = bench_points(FRAME_MAX_POINTS);
+    vector<Matrix3D> matrices = bench_matrices(FRAME_MAX_POINTS);
+    pmr::unsynchronized_pool_resource pool;
+    Arena arena;
+    for (size_t alive : {(size_t) FRAME_LIVE, (size_t) FRAME_BUFFERS})
+    {
+        const string lives = alive == FRAME_BUFFERS ? ", all live" : ", " + to_string(alive) + " live";
+        bench.measure("vector" + lives, FRAME_BUFFERS, [&]() {
+            keep(frame<vector<Vector3D>, vector<Matrix3D>>(source, matrices, alive));
+        });
+        bench.measure("pmr, unsynchronized_pool_resource" + lives, FRAME_BUFFERS, [&]() {
+            keep(frame<Vector3DBuffer, Matrix3DBuffer>(source, matrices, alive, &pool));
+        });
+        bench.measure("pmr, Arena, reset per frame" + lives, FRAME_BUFFERS, [&]() {
+            keep(frame<Vector3DBuffer, Matrix3DBuffer>(source, matrices, alive, &arena));
+            arena.reset();
+        });
+    }
+    Arena reused;
+    bench.measure("Arena::reset", 1, [&]() {
+        keep(reused.allocate(sizeof(Vector3D) * FRAME_MAX_POINTS));
+        reused.reset();
+    });
+}
+
+BENCHMARK(arenaFrames);
@@ -0,0 +1,413 @@
+// Created by liorP.
+//
+
+#ifndef EX1_ARRAYEXPR_H
+#define EX1_ARRAYEXPR_H
+
+#include <algorithm>
+#include "Simd.h"
+#include "Vector3DArray.h"
+
+#define ARRAY_SIZE_ERR "Array sizes differ"
+
+// --------------------------------------------------------------------------------------
+// Lazy expression templates over Vector3DArray.
+// An arithmetic expression over arrays (e.g. a + b * 2.0 - c, or m * (a - b)) builds a small
+// tree of nodes instead of computing anything. Assigning the tree to a Vector3DArray then
+// evaluates the whole expression in a single fused SIMD pass, with no intermediate arrays.
+// The nodes keep references to the arrays they read, so an expression must be assigned
+// before those arrays go away. All the arrays of an expression must have the same size:
+// otherwise the assignment prints an error and leaves the target as it was.
+//
+// Every node provides:
+//   size_t size() const                                  number of vectors (0 for constants)
+//   bool sized(size_t n) const                           true if every array read has n vectors
+//   void simd(size_t i, simd_t &x, simd_t &y, simd_t &z)  vectors i ... i + SIMD_WIDTH - 1
+//   void scalar(size_t i, double &x, double &y, double &z)  vector i
+// --------------------------------------------------------------------------------------
+
+/**
+ * The base of all the expression nodes (CRTP), what the operators below accept.
+ */
+template<typename E>
+struct ArrayExpr
+{
+    /**
+     * @return the node as its real type
+     */
+    const E &self() const { return static_cast<const E &>(*this); }
+};
+
+/**
+ * A leaf - reads an existing array.
+ */
+struct ArrayLeaf : ArrayExpr<ArrayLeaf>
+{
+    const double *x; /**< the x stream. */
+    const double *y; /**< the y stream. */
+    const double *z; /**< the z stream. */
+    size_t count; /**< number of vectors. */
+
+    /**
+     * A constructor.
+     * @param array to read
+     */
+    explicit ArrayLeaf(const Vector3DArray &array) : x(array.x()), y(array.y()), z(array.z()),
+                                                     count(array.size()) {}
+
+    size_t size() const { return count; }
+
+    bool sized(size_t n) const { return count == n; }
+
+    void simd(size_t i, simd_t &vx, simd_t &vy, simd_t &vz) const
+    {
+        vx = simd_load(x + i);
+        vy = simd_load(y + i);
+        vz = simd_load(z + i);
+    }
+
+    void scalar(size_t i, double &vx, double &vy, double &vz) const
+    {
+        vx = x[i];
+        vy = y[i];
+        vz = z[i];
+    }
+};
+
+/**
+ * A leaf - the same vector for every index.
+ */
+struct ArrayConstant : ArrayExpr<ArrayConstant>
+{
+    double value[3]; /**< the vector. */
+
+    /**
+     * A constructor.
+     * @param vector to broadcast
+     */
+    explicit ArrayConstant(const Vector3D &vector) : value{vector[0], vector[1], vector[2]} {}
+
+    size_t size() const { return 0; }
+
+    bool sized(size_t) const { return true; }
+
+    void simd(size_t, simd_t &vx, simd_t &vy, simd_t &vz) const
+    {
+        vx = simd_set(value[0]);
+        vy = simd_set(value[1]);
+        vz = simd_set(value[2]);
+    }
+
+    void scalar(size_t, double &vx, double &vy, double &vz) const
+    {
+        vx = value[0];
+        vy = value[1];
+        vz = value[2];
+    }
+};
+
+/**
+ * left[i] + right[i], or left[i] - right[i].
+ */
+template<typename L, typename R, bool Subtract>
+struct ArraySum : ArrayExpr<ArraySum<L, R, Subtract>>
+{
+    L left; /**< the left operand. */
+    R right; /**< the right operand. */
+
+    ArraySum(const L &l, const R &r) : left(l), right(r) {}
+
+    size_t size() const { return max(left.size(), right.size()); }
+
+    bool sized(size_t n) const { return left.sized(n) && right.sized(n); }
+
+    void simd(size_t i, simd_t &x, simd_t &y, simd_t &z) const
+    {
+        simd_t rx, ry, rz;
+        left.simd(i, x, y, z);
+        right.simd(i, rx, ry, rz);
+        x = Subtract ? simd_sub(x, rx) : simd_add(x, rx);
+        y = Subtract ? simd_sub(y, ry) : simd_add(y, ry);
+        z = Subtract ? simd_sub(z, rz) : simd_add(z, rz);
+    }
+
+    void scalar(size_t i, double &x, double &y, double &z) const
+    {
+        double rx, ry, rz;
+        left.scalar(i, x, y, z);
+        right.scalar(i, rx, ry, rz);
+        x = Subtract ? x - rx : x + rx;
+        y = Subtract ? y - ry : y + ry;
+        z = Subtract ? z - rz : z + rz;
+    }
+};
+
+/**
+ * operand[i] * factor. negation and division by a scalar are scaling too.
+ */
+template<typename E>
+struct ArrayScaled : ArrayExpr<ArrayScaled<E>>
+{
+    E operand; /**< the scaled expression. */
+    double factor; /**< the scalar. */
+
+    ArrayScaled(const E &e, double f) : operand(e), factor(f) {}
+
+    size_t size() const { return operand.size(); }
+
+    bool sized(size_t n) const { return operand.sized(n); }
+
+    void simd(size_t i, simd_t &x, simd_t &y, simd_t &z) const
+    {
+        simd_t f = simd_set(factor);
+        operand.simd(i, x, y, z);
+        x = simd_mul(x, f);
+        y = simd_mul(y, f);
+        z = simd_mul(z, f);
+    }
+
+    void scalar(size_t i, double &x, double &y, double &z) const
+    {
+        operand.scalar(i, x, y, z);
+        x *= factor;
+        y *= factor;
+        z *= factor;
+    }
+};
+
+/**
+ * matrix * operand[i]
+ */
+template<typename E>
+struct ArrayTransformed : ArrayExpr<ArrayTransformed<E>>
+{
+    E operand; /**< the transformed expression. */
+    double m[9]; /**< element (row, col) at m[3 * row + col]. */
+
+    ArrayTransformed(const Matrix3D &matrix, const E &e) : operand(e), m{}
+    {
+        for (int row = 0; row < 3; ++ row)
+        {
+            for (int col = 0; col < 3; ++ col)
+            {
+                m[3 * row + col] = matrix[row][col];
+            }
+        }
+    }
+
+    size_t size() const { return operand.size(); }
+
+    bool sized(size_t n) const { return operand.sized(n); }
+
+    void simd(size_t i, simd_t &x, simd_t &y, simd_t &z) const
+    {
+        simd_t vx, vy, vz;
+        operand.simd(i, vx, vy, vz);
+        x = simd_fmadd(simd_set(m[2]), vz, simd_fmadd(simd_set(m[1]), vy, simd_mul(simd_set(m[0]), vx)));
+        y = simd_fmadd(simd_set(m[5]), vz, simd_fmadd(simd_set(m[4]), vy, simd_mul(simd_set(m[3]), vx)));
+        z = simd_fmadd(simd_set(m[8]), vz, simd_fmadd(simd_set(m[7]), vy, simd_mul(simd_set(m[6]), vx)));
+    }
+
+    void scalar(size_t i, double &x, double &y, double &z) const
+    {
+        double vx, vy, vz;
+        operand.scalar(i, vx, vy, vz);
+        x = m[0] * vx + m[1] * vy + m[2] * vz;
+        y = m[3] * vx + m[4] * vy + m[5] * vz;
+        z = m[6] * vx + m[7] * vy + m[8] * vz;
+    }
+};
+
+// ------------------ Operands ------------------------
+
+/**
+ * true for the types that start or extend an expression: arrays and expression nodes.
+ */
+template<typename T>
+struct is_array_operand : is_base_of<ArrayExpr<T>, T> {};
+
+template<>
+struct is_array_operand<Vector3DArray> : true_type {};
+
+/**
+ * @param array an array
+ * @return the leaf reading it
+ */
+inline ArrayLeaf as_expr(const Vector3DArray &array)
+{
+    return ArrayLeaf(array);
+}
+
+/**
+ * @param vector a single vector
+ * @return the leaf broadcasting it
+ */
+inline ArrayConstant as_expr(const Vector3D &vector)
+{
+    return ArrayConstant(vector);
+}
+
+/**
+ * @param expr an expression node
+ * @return the node itself
+ */
+template<typename E>
+const E &as_expr(const ArrayExpr<E> &expr)
+{
+    return expr.self();
+}
+
+/**
+ * the node type of an operand.
+ */
+template<typename T>
+using expr_t = decay_t<decltype(as_expr(declval<const T &>()))>;
+
+/**
+ * enabled when A and B form an array expression: one of them an array operand, and the
+ * other an array operand or a Vector3D.
+ */
+template<typename A, typename B>
+using enable_array_binary = enable_if_t<(is_array_operand<A>::value && (is_array_operand<B>::value ||
+                                                                         is_same<B, Vector3D>::value)) ||
+                                        (is_same<A, Vector3D>::value && is_array_operand<B>::value)>;
+
+// ------------------ Operators ------------------------
+
+/**
+* + operator overload - lazy a[i] + b[i]
+*/
+template<typename A, typename B, typename = enable_array_binary<A, B>>
+ArraySum<expr_t<A>, expr_t<B>, false> operator+(const A &a, const B &b)
+{
+    return ArraySum<expr_t<A>, expr_t<B>, false>(as_expr(a), as_expr(b));
+}
+
+/**
+* - operator overload - lazy a[i] - b[i]
+*/
+template<typename A, typename B, typename = enable_array_binary<A, B>>
+ArraySum<expr_t<A>, expr_t<B>, true> operator-(const A &a, const B &b)
+{
+    return ArraySum<expr_t<A>, expr_t<B>, true>(as_expr(a), as_expr(b));
+}
+
+/**
+* * operator overload - lazy a[i] * scalar
+*/
+template<typename A, typename = enable_if_t<is_array_operand<A>::value>>
+ArrayScaled<expr_t<A>> operator*(const A &a, double scalar)
+{
+    return ArrayScaled<expr_t<A>>(as_expr(a), scalar);
+}
+
+/**
+* * operator overload - lazy scalar * a[i]
+*/
+template<typename A, typename = enable_if_t<is_array_operand<A>::value>>
+ArrayScaled<expr_t<A>> operator*(double scalar, const A &a)
+{
+    return ArrayScaled<expr_t<A>>(as_expr(a), scalar);
+}
+
+/**
+* / operator overload - lazy a[i] / scalar
+*/
+template<typename A, typename = enable_if_t<is_array_operand<A>::value>>
+ArrayScaled<expr_t<A>> operator/(const A &a, double scalar)
+{
+    if (error_if(scalar == 0))
+    {
+        report_error(ERROR_ZERO);
+    }
+    return ArrayScaled<expr_t<A>>(as_expr(a), 1 / scalar);
+}
+
+/**
+* - operator overload - lazy -a[i]
+*/
+template<typename A, typename = enable_if_t<is_array_operand<A>::value>>
+ArrayScaled<expr_t<A>> operator-(const A &a)
+{
+    return ArrayScaled<expr_t<A>>(as_expr(a), - 1);
+}
+
+/**
+* * operator overload - lazy matrix * a[i]
+*/
+template<typename A, typename = enable_if_t<is_array_operand<A>::value>>
+ArrayTransformed<expr_t<A>> operator*(const Matrix3D &matrix, const A &a)
+{
+    return ArrayTransformed<expr_t<A>>(matrix, as_expr(a));
+}
+
+// ------------------ Evaluation ------------------------
+
+/**
+ * evaluates an expression into an array in a single pass.
+ * every vector is read before it is written, so out may be one of the operands. when the
+ * size changes the result goes to a new array, moved into out after, as resizing out would
+ * free the vectors of an operand it is.
+ * @param expr the expression
+ * @param out receives the result, resized to the size of the expression. left as it is,
+ * with an error printed, if the arrays of the expression differ in size
+ */
+template<typename E>
+void evaluate(const ArrayExpr<E> &expr, Vector3DArray &out)
+{
+    const E &e = expr.self();
+    size_t n = e.size(), i = 0;
+    if (! e.sized(n))
+    {
+        cerr << ARRAY_SIZE_ERR << endl;
+        return;
+    }
+    if (n != out.size())
+    {
+        Vector3DArray result(n);
+        evaluate(expr, result);
+        out = move(result);
+        return;
+    }
+    double *ox = out.x(), *oy = out.y(), *oz = out.z();
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        simd_t x, y, z;
+        e.simd(i, x, y, z);
+        simd_store(ox + i, x);
+        simd_store(oy + i, y);
+        simd_store(oz + i, z);
+    }
+    for (; i < n; ++ i)
+    {
+        double x, y, z;
+        e.scalar(i, x, y, z);
+        ox[i] = x;
+        oy[i] = y;
+        oz[i] = z;
+    }
+}
+
+/**
+* A constructor - evaluates an expression.
+* @param expr the expression
+*/
+template<typename E>
+Vector3DArray::Vector3DArray(const ArrayExpr<E> &expr) : Vector3DArray()
+{
+    evaluate(expr, *this);
+}
+
+/**
+* = operator overload - evaluates an expression into this array.
+* @param expr the expression
+* @return reference to this array
+*/
+template<typename E>
+Vector3DArray &Vector3DArray::operator=(const ArrayExpr<E> &expr)
+{
+    evaluate(expr, *this);
+    return *this;
+}
+
+#endif //EX1_ARRAYEXPR_H
@@ -0,0 +1,157 @@
+// Created by liorP.
+//
+
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "Transform.h"
+#include "Vector3DArray.h"
+
+/**
+ * number of points of the cache resident runs.
+ */
+#define CACHED (1 << 14)
+
+// --------------------------------------------------------------------------------------
+// Benchmarks of the batch paths against loops over the Vector3D/Matrix3D operators.
+// Every op runs over a cache resident array of CACHED points and over BENCH_ARRAY points.
+// --------------------------------------------------------------------------------------
+
+/**
+ * benchmarks the Vector3DArray kernels against the same loops over vector<Vector3D>.
+ * @param bench to measure with
+ */
+static void soaKernels(Bench &bench)
+{
+    const Matrix3D m = bench_matrices(1)[0];
+    for (size_t count : {(size_t) CACHED, (size_t) BENCH_ARRAY})
+    {
+        const string size = "/" + to_string(count);
+        vector<Vector3D> points = bench_points(count), others = bench_points(count, 2), out(count);
+        vector<double> scalars(count);
+        Vector3DArray a(points), b(others), result(count);
+        bench.measure("loop Vector3D::operator*(d)" + size, count, [&]() {
+            for (size_t i = 0; i < count; ++ i)
+            {
+                out[i] = points[i] * 1.5;
+            }
+            keep(out);
+        });
+        bench.measure("batch_scale" + size, count, [&]() { batch_scale(a, 1.5, result); keep(result); });
+        bench.measure("loop Vector3D::operator+" + size, count, [&]() {
+            for (size_t i = 0; i < count; ++ i)
+            {
+                out[i] = points[i] + others[i];
+            }
+            keep(out);
+        });
+        bench.measure("batch_add" + size, count, [&]() { batch_add(a, b, result); keep(result); });
+        bench.measure("loop Vector3D::operator*(v)" + size, count, [&]() {
+            for (size_t i = 0; i < count; ++ i)
+            {
+                scalars[i] = points[i] * others[i];
+            }
+            keep(scalars);
+        });
+        bench.measure("batch_dot" + size, count, [&]() { batch_dot(a, b, scalars); keep(scalars); });
+        bench.measure("loop Vector3D::norm" + size, count, [&]() {
+            for (size_t i = 0; i < count; ++ i)
+            {
+                scalars[i] = points[i].norm();
+            }
+            keep(scalars);
+        });
+        bench.measure("batch_norm" + size, count, [&]() { batch_norm(a, scalars); keep(scalars); });
+        bench.measure("loop Vector3D::dist" + size, count, [&]() {
+            for (size_t i = 0; i < count; ++ i)
+            {
+                scalars[i] = points[i].dist(others[i]);
+            }
+            keep(scalars);
+        });
+        bench.measure("batch_dist" + size, count, [&]() { batch_dist(a, b, scalars); keep(scalars); });
+        bench.measure("loop Matrix3D::operator*(v)" + size, count, [&]() {
+            for (size_t i = 0; i < count; ++ i)
+            {
+                out[i] = m * points[i];
+            }
+            keep(out);
+        });
+        bench.measure("batch_multiply" + size, count, [&]() { batch_multiply(m, a, result); keep(result); });
+    }
+}
+
+BENCHMARK(soaKernels);
+
+/**
+ * benchmarks transform_batch against a loop over Matrix3D::operator*(const Vector3D &).
+ * @param bench to measure with
+ */
+static void transformBatch(Bench &bench)
+{
+    const Matrix3D m = bench_matrices(1)[0];
+    for (size_t count : {(size_t) CACHED, (size_t) BENCH_ARRAY})
+    {
+        const string size = "/" + to_string(count);
+        vector<Vector3D> points = bench_points(count), out(count);
+        bench.measure("loop Matrix3D::operator*(v)" + size, count, [&]() {
+            for (size_t i = 0; i < count; ++ i)
+            {
+                out[i] = m * points[i];
+            }
+            keep(out);
+        });
+        bench.measure("transform_batch" + size, count, [&]() { transform_batch(m, points, out); keep(out); });
+        bench.measure("transform_batch inplace" + size, count, [&]() { transform_batch(m, out); keep(out); });
+    }
+}
+
+BENCHMARK(transformBatch);
+
+/**
+ * @param count number of matrices
+ * @return count rotations about alternating axes, so products along them stay bounded
+ */
+static vector<Matrix3D> rotationChain(size_t count)
+{
+    vector<Matrix3D> chain(count);
+    for (size_t i = 0; i < count; ++ i)
+    {
+        const double c = cos(0.001 * (double) (i % 100)), s = sin(0.001 * (double) (i % 100));
+        chain[i] = i % 2 == 0 ? Matrix3D(c, - s, 0, s, c, 0, 0, 0, 1) : Matrix3D(1, 0, 0, 0, c, - s, 0, s, c);
+    }
+    return chain;
+}
+
+/**
+ * benchmarks multiply_batch and prefix_product against loops over
+ * Matrix3D::operator*(const Matrix3D &).
+ * @param bench to measure with
+ */
+static void matrixProducts(Bench &bench)
+{
+    for (size_t count : {(size_t) CACHED / 8, (size_t) BENCH_ARRAY / 8})
+    {
+        const string size = "/" + to_string(count);
+        vector<Matrix3D> a = bench_matrices(count), b = bench_matrices(count, 2), out(count);
+        bench.measure("loop Matrix3D::operator*(m)" + size, count, [&]() {
+            for (size_t i = 0; i < count; ++ i)
+            {
+                out[i] = a[i] * b[i];
+            }
+            keep(out);
+        });
+        bench.measure("multiply_batch" + size, count, [&]() { multiply_batch(a, b, out); keep(out); });
+        const vector<Matrix3D> chain = rotationChain(count);
+        bench.measure("loop chain prefix products" + size, count, [&]() {
+            out[0] = chain[0];
+            for (size_t i = 1; i < count; ++ i)
+            {
+                out[i] = out[i - 1] * chain[i];
+            }
+            keep(out);
+        });
+        bench.measure("prefix_product" + size, count, [&]() { prefix_product(chain, out); keep(out); });
+    }
+}
+
+BENCHMARK(matrixProducts);
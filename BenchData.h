@@ -0,0 +1,57 @@
+// Created by liorP.
+//
+
+#ifndef EX1_BENCHDATA_H
+#define EX1_BENCHDATA_H
+
+#include <random>
+#include <vector>
+#include "Matrix3D.h"
+
+// --------------------------------------------------------------------------------------
+// Deterministic input data shared by the benchmarks.
+// --------------------------------------------------------------------------------------
+
+/**
+ * @param count number of points
+ * @param seed of the generator
+ * @return count points uniform in [-100, 100)^3
+ */
+inline vector<Vector3D> bench_points(size_t count, unsigned seed = 1)
+{
+    mt19937_64 generator(seed);
+    uniform_real_distribution<double> coordinate(- 100, 100);
+    vector<Vector3D> points;
+    points.reserve(count);
+    for (size_t i = 0; i < count; ++ i)
+    {
+        double x = coordinate(generator), y = coordinate(generator), z = coordinate(generator);
+        points.emplace_back(x, y, z);
+    }
+    return points;
+}
+
+/**
+ * @param count number of matrices
+ * @param seed of the generator
+ * @return count matrices with elements uniform in [-1, 1)
+ */
+inline vector<Matrix3D> bench_matrices(size_t count, unsigned seed = 1)
+{
+    mt19937_64 generator(seed);
+    uniform_real_distribution<double> element(- 1, 1);
+    vector<Matrix3D> matrices;
+    matrices.reserve(count);
+    for (size_t i = 0; i < count; ++ i)
+    {
+        double e[9];
+        for (double &value : e)
+        {
+            value = element(generator);
+        }
+        matrices.emplace_back(e);
+    }
+    return matrices;
+}
+
+#endif //EX1_BENCHDATA_H
@@ -0,0 +1,216 @@
+// Created by liorP.
+//
+
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include "Benchmark.h"
+#include "Simd.h"
+
+#define DEFAULT_MIN_TIME 0.1
+#define USAGE "usage: bench [--filter=<substring>] [--min-time=<seconds>] [--json[=<file>]]"
+
+// --------------------------------------------------------------------------------------
+// This file contains the benchmark registry and the main function of the bench program.
+//   --filter=<substring>   runs only the benchmark functions whose name contains it
+//   --min-time=<seconds>   minimal run time of every measurement (default 0.1)
+//   --json[=<file>]        writes the results as JSON to the file, or to stdout
+// --------------------------------------------------------------------------------------
+
+/**
+ * A registered benchmark function.
+ */
+struct RegisteredBench
+{
+    const char *name; /**< name of the function. */
+    BenchFunction function; /**< the function. */
+};
+
+/**
+ * @return all the registered benchmark functions
+ */
+static vector<RegisteredBench> &registry()
+{
+    static vector<RegisteredBench> functions;
+    return functions;
+}
+
+/**
+* A constructor.
+* @param name of the benchmark function
+* @param function the benchmark function
+*/
+BenchRegistration::BenchRegistration(const char *name, const BenchFunction function)
+{
+    registry().push_back(RegisteredBench{name, function});
+}
+
+/**
+ * escapes a string for a JSON document.
+ * @param text string to escape
+ * @return the quoted string
+ */
+static string quoted(const string &text)
+{
+    string ans = "\"";
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            ans += '\\';
+        }
+        ans += c;
+    }
+    return ans + "\"";
+}
+
+/**
+ * writes the results as a JSON document.
+ * @param os out-stream
+ * @param results the measurements
+ */
+static void writeJson(ostream &os, const vector<BenchResult> &results)
+{
+    char date[32];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+    os << "{" << endl;
+    os << "  \"context\": {" << endl;
+    os << "    \"date\": " << quoted(date) << "," << endl;
+    os << "    \"compiler\": " << quoted(__VERSION__) << "," << endl;
+    os << "    \"simd\": " << quoted(SIMD_ISA) << "," << endl;
+    os << "    \"hardware_threads\": " << thread::hardware_concurrency() << endl;
+    os << "  }," << endl;
+    os << "  \"benchmarks\": [" << endl;
+    os << setprecision(6);
+    for (size_t i = 0; i < results.size(); ++ i)
+    {
+        const BenchResult &result = results[i];
+        os << "    {\"group\": " << quoted(result.group)
+           << ", \"name\": " << quoted(result.name)
+           << ", \"items\": " << result.items
+           << ", \"iterations\": " << result.iterations
+           << ", \"ns_per_item\": " << result.ns_per_item()
+           << ", \"items_per_second\": " << result.items_per_second();
+        if (! isnan(result.resident_mib))
+        {
+            os << ", \"resident_mib\": " << result.resident_mib;
+        }
+        if (! isnan(result.peak_mib))
+        {
+            os << ", \"peak_mib\": " << result.peak_mib;
+        }
+        if (! isnan(result.max_error))
+        {
+            os << ", \"max_error\": " << result.max_error;
+        }
+        os << "}"
+           << (i + 1 < results.size() ? "," : "") << endl;
+    }
+    os << "  ]" << endl;
+    os << "}" << endl;
+}
+
+/**
+ * prints a result as a row of the table.
+ * @param result the measurement
+ */
+static void printRow(const BenchResult &result)
+{
+    cout << left << setw(44) << result.name << right << fixed << setprecision(3)
+         << setw(12) << result.ns_per_item() << " ns" << setprecision(1)
+         << setw(12) << result.items_per_second() / 1e6 << " M/s";
+    if (! isnan(result.resident_mib))
+    {
+        cout << setw(10) << showpos << result.resident_mib << noshowpos << " MiB anon";
+    }
+    if (! isnan(result.peak_mib))
+    {
+        cout << setw(10) << showpos << result.peak_mib << noshowpos << " MiB anon peak";
+    }
+    if (! isnan(result.max_error))
+    {
+        cout << "  max err " << defaultfloat << setprecision(6) << result.max_error;
+    }
+    cout << endl;
+}
+
+/**
+ * main function of the bench program
+ * @param argc number of arguments
+ * @param argv the arguments, see the top of the file
+ * @return 0 if successful
+ */
+int main(int argc, char *argv[])
+{
+    string filter, jsonFile;
+    bool json = false;
+    double minTime = DEFAULT_MIN_TIME;
+    for (int i = 1; i < argc; ++ i)
+    {
+        if (strncmp(argv[i], "--filter=", 9) == 0)
+        {
+            filter = argv[i] + 9;
+        }
+        else if (strncmp(argv[i], "--min-time=", 11) == 0)
+        {
+            minTime = atof(argv[i] + 11);
+        }
+        else if (strcmp(argv[i], "--json") == 0)
+        {
+            json = true;
+        }
+        else if (strncmp(argv[i], "--json=", 7) == 0)
+        {
+            json = true;
+            jsonFile = argv[i] + 7;
+        }
+        else
+        {
+            cerr << USAGE << endl;
+            return 1;
+        }
+    }
+    // with JSON on stdout the table would corrupt the document
+    bool table = ! json || ! jsonFile.empty();
+    vector<BenchResult> results;
+    for (const RegisteredBench &registered : registry())
+    {
+        if (strstr(registered.name, filter.c_str()) == nullptr)
+        {
+            continue;
+        }
+        if (table)
+        {
+            cout << "-- " << registered.name << endl;
+        }
+        Bench bench(registered.name, minTime);
+        registered.function(bench);
+        for (const BenchResult &result : bench.results())
+        {
+            if (table)
+            {
+                printRow(result);
+            }
+            results.push_back(result);
+        }
+    }
+    if (json && jsonFile.empty())
+    {
+        writeJson(cout, results);
+    }
+    else if (json)
+    {
+        ofstream file(jsonFile);
+        writeJson(file, results);
+        if (! file)
+        {
+            cerr << "Can't write " << jsonFile << endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,163 @@
+// Created by liorP.
+//
+
+#ifndef EX1_BENCHMARK_H
+#define EX1_BENCHMARK_H
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+// --------------------------------------------------------------------------------------
+// A small micro-benchmark harness, in the spirit of Google Benchmark.
+// Benchmark functions register themselves with BENCHMARK(function), and record any number
+// of measurements through Bench::measure. The bench program runs them all, and prints the
+// results as a table or as JSON (see Benchmark.cpp for the command line).
+// --------------------------------------------------------------------------------------
+
+/**
+ * number of points in the arrays of the throughput benchmarks.
+ */
+#define BENCH_ARRAY (1 << 20)
+
+/**
+ * number of dependent ops in a call of the latency benchmarks.
+ */
+#define BENCH_CHAIN 1024
+
+/**
+ * keeps the compiler from optimizing a computed value away.
+ * @param value any object that was computed by the benchmark
+ */
+template<typename T>
+inline void keep(const T &value)
+{
+    asm volatile("" : : "r"(&value) : "memory");
+}
+
+/**
+ * @return the anonymous (private, not file backed) resident memory of the process in KiB,
+ * 0 if unknown. smaps_rollup walks the page tables, unlike the cached counters of /proc/self/status
+ */
+inline long resident_anonymous()
+{
+    ifstream status("/proc/self/smaps_rollup");
+    string key;
+    long kib;
+    while (status >> key)
+    {
+        if (key == "Anonymous:" && status >> kib)
+        {
+            return kib;
+        }
+    }
+    return 0;
+}
+
+/**
+ * A single measurement.
+ */
+struct BenchResult
+{
+    string group; /**< the benchmark function that recorded it. */
+    string name; /**< the measured op. */
+    size_t items; /**< elements processed by a single call. */
+    size_t iterations; /**< number of timed calls. */
+    double seconds; /**< total time of the timed calls. */
+    double resident_mib = NAN; /**< anonymous resident memory the op keeps, NAN if not measured. */
+    double peak_mib = NAN; /**< peak growth of the anonymous resident memory during the op, NAN if not measured. */
+    double max_error = NAN; /**< largest error of the results of the op, NAN if not measured. */
+
+    /**
+     * @return average time of an element in nanoseconds
+     */
+    double ns_per_item() const { return seconds * 1e9 / ((double) items * iterations); }
+
+    /**
+     * @return elements processed per second
+     */
+    double items_per_second() const { return (double) items * iterations / seconds; }
+};
+
+/**
+ * The handle a benchmark function measures with.
+ */
+class Bench
+{
+public:
+    /**
+     * A constructor.
+     * @param group name of the benchmark function
+     * @param minTime seconds every measurement should run for at least
+     */
+    Bench(string group, double minTime) : _group(move(group)), _minTime(minTime) {}
+
+    /**
+     * times fn, calling it again and again (doubling the count) until minTime has passed.
+     * @param name of the measured op
+     * @param items number of elements a single call of fn processes
+     * @param fn the code to time
+     * @return the measurement, to add the figures other than time to. valid until the next one
+     */
+    template<typename Fn>
+    BenchResult &measure(const string &name, size_t items, Fn fn)
+    {
+        fn();
+        size_t iterations = 1;
+        while (true)
+        {
+            auto start = chrono::steady_clock::now();
+            for (size_t i = 0; i < iterations; ++ i)
+            {
+                fn();
+            }
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            if (seconds >= _minTime || iterations >= ((size_t) 1 << 40))
+            {
+                _results.push_back(BenchResult{_group, name, items, iterations, seconds});
+                return _results.back();
+            }
+            iterations *= 2;
+        }
+    }
+
+    /**
+     * @return the measurements recorded so far
+     */
+    const vector<BenchResult> &results() const { return _results; }
+
+private:
+    string _group; /**< name of the benchmark function. */
+    double _minTime; /**< seconds every measurement runs for at least. */
+    vector<BenchResult> _results; /**< the recorded measurements. */
+
+};
+
+/**
+ * A benchmark function.
+ */
+typedef void (*BenchFunction)(Bench &bench);
+
+/**
+ * Adds a benchmark function to the ones the bench program runs.
+ */
+struct BenchRegistration
+{
+    /**
+     * A constructor.
+     * @param name of the benchmark function
+     * @param function the benchmark function
+     */
+    BenchRegistration(const char *name, BenchFunction function);
+};
+
+/**
+ * registers a benchmark function, at namespace scope after its definition.
+ */
+#define BENCHMARK(function) static BenchRegistration function##Registration(#function, function)
+
+#endif //EX1_BENCHMARK_H
@@ -0,0 +1,62 @@
+// Created by liorP.
+//
+
+#ifndef EX1_BOUNDS_H
+#define EX1_BOUNDS_H
+
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+
+using namespace std;
+
+#define INDEX_ERROR "Index out of bounds"
+
+// --------------------------------------------------------------------------------------
+// The bounds check of Vector::operator[], Matrix::operator[], row() and column(), selected
+// at compile time by defining BOUNDS_CHECK (the Makefile passes BOUNDS_$(BOUNDS)):
+//   BOUNDS_NONE    no check at all, an out of range index is undefined behaviour
+//   BOUNDS_ASSERT  assert(), so the check is gone when NDEBUG is defined (the default)
+//   BOUNDS_THROW   throws out_of_range
+// Every translation unit of a program must be built with the same setting.
+// --------------------------------------------------------------------------------------
+
+#define BOUNDS_NONE 0
+#define BOUNDS_ASSERT 1
+#define BOUNDS_THROW 2
+
+#ifndef BOUNDS_CHECK
+#define BOUNDS_CHECK BOUNDS_ASSERT
+#endif
+
+#if BOUNDS_CHECK == BOUNDS_NONE
+#define BOUNDS_NAME "none"
+#elif BOUNDS_CHECK == BOUNDS_ASSERT
+#define BOUNDS_NAME "assert"
+#elif BOUNDS_CHECK == BOUNDS_THROW
+#define BOUNDS_NAME "throw"
+#else
+#error "BOUNDS_CHECK must be BOUNDS_NONE, BOUNDS_ASSERT or BOUNDS_THROW"
+#endif
+
+/**
+ * checks an index into N elements according to BOUNDS_CHECK.
+ * a negative index wraps to a huge unsigned one, so a single comparison covers both ends.
+ * @param i the index
+ * @return i, as an offset
+ */
+template<size_t N>
+constexpr size_t checked_index(const int i)
+{
+#if BOUNDS_CHECK == BOUNDS_THROW
+    if ((size_t) (unsigned) i >= N)
+    {
+        throw out_of_range(INDEX_ERROR);
+    }
+#elif BOUNDS_CHECK == BOUNDS_ASSERT
+    assert((size_t) (unsigned) i < N && INDEX_ERROR);
+#endif
+    return (size_t) i;
+}
+
+#endif //EX1_BOUNDS_H
@@ -0,0 +1,46 @@
+// Created by liorP.
+//
+
+#include "Box3D.h"
+#include "Parallel.h"
+
+#define SIZE_ERROR "Input and output sizes differ"
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the Box3D functions over spans of points.
+// --------------------------------------------------------------------------------------
+
+/**
+* A constructor - the bounding box of points.
+* @param points to bound
+*/
+Box3D::Box3D(const Span<const Vector3D> points) : Box3D()
+{
+    parallel_bounding_box(points, _corners[0], _corners[1]);
+}
+
+/**
+* out[i] = box.contains(points[i])
+* @param box to test against
+* @param points to test
+* @param out 1 for the points inside and 0 for the others, same size as points
+* @return number of points inside
+*/
+size_t contains_batch(const Box3D &box, const Span<const Vector3D> points, const Span<unsigned char> out)
+{
+    INSTRUMENT_SCOPE("contains_batch");
+    if (points.size() != out.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return 0;
+    }
+    return parallel_reduce(points.size(), PARALLEL_GRAIN, (size_t) 0, [&](size_t begin, size_t end) {
+        size_t inside = 0;
+        for (size_t i = begin; i < end; ++ i)
+        {
+            out[i] = box.contains(points[i]);
+            inside += out[i];
+        }
+        return inside;
+    }, [](size_t a, size_t b) { return a + b; });
+}
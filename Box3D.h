@@ -0,0 +1,268 @@
+// Created by liorP.
+//
+
+#ifndef EX1_BOX3D_H
+#define EX1_BOX3D_H
+
+#include <limits>
+#include "Span.h"
+#include "Vector3D.h"
+
+// --------------------------------------------------------------------------------------
+// An axis aligned bounding box (AABB) of Vector3D, and the rays tested against it.
+// The ray / box test is the slab test: the entry and exit distances of the 3 slabs, with
+// the inverse direction and the near corner of every axis computed once per ray, so a box
+// costs 6 subtractions, 6 multiplications and a min / max tree without a division or a
+// branch. An axis parallel ray gives infinite distances, which the min / max order of the
+// test keeps correct.
+// --------------------------------------------------------------------------------------
+
+/**
+ * A ray, origin + t * direction for t >= 0, with what the slab test needs precomputed.
+ */
+struct Ray3D
+{
+    Vector3D origin; /**< where the ray starts. */
+    Vector3D direction; /**< the direction, not necessarily unit: t is in its units. */
+    Vector3D inverse; /**< 1 / direction, per coordinate. */
+    int negative[3]; /**< 1 for the axes where the direction is negative. */
+
+    /**
+     * A default constructor - a ray along +x from the origin.
+     */
+    Ray3D() : Ray3D(Vector3D(), Vector3D(1, 0, 0)) {}
+
+    /**
+     * A constructor.
+     * @param origin where the ray starts
+     * @param direction of the ray
+     */
+    Ray3D(const Vector3D &origin, const Vector3D &direction) : origin(origin), direction(direction), negative{}
+    {
+        for (int axis = 0; axis < 3; ++ axis)
+        {
+            inverse[axis] = 1 / direction[axis];
+            negative[axis] = inverse[axis] < 0;
+        }
+    }
+
+    /**
+     * @param t distance along the ray
+     * @return the point at t
+     */
+    Vector3D at(double t) const { return origin + direction * t; }
+};
+
+/**
+ * A Box3D class.
+ * This class represents an axis aligned box, [lower, upper] in every coordinate. the default
+ * box is empty (lower +inf, upper -inf), so extending it by a point gives that point.
+ */
+class Box3D
+{
+public:
+    /**
+     * A default constructor - the empty box.
+     */
+    constexpr Box3D() : _corners{Vector3D(inf(), inf(), inf()), Vector3D(- inf(), - inf(), - inf())} {}
+
+    /**
+     * A constructor.
+     * @param lower the minimal corner
+     * @param upper the maximal corner
+     */
+    constexpr Box3D(const Vector3D &lower, const Vector3D &upper) : _corners{lower, upper} {}
+
+    /**
+     * A constructor - the bounding box of points.
+     * @param points to bound
+     */
+    explicit Box3D(Span<const Vector3D> points);
+
+    /**
+     * @return the minimal corner
+     */
+    constexpr const Vector3D &lower() const { return _corners[0]; }
+
+    /**
+     * @return the maximal corner
+     */
+    constexpr const Vector3D &upper() const { return _corners[1]; }
+
+    /**
+     * @return true if the box contains no point
+     */
+    constexpr bool empty() const;
+
+    /**
+     * grows the box to contain a point.
+     * @param point to contain
+     * @return reference to this box
+     */
+    constexpr Box3D &extend(const Vector3D &point);
+
+    /**
+     * grows the box to contain another.
+     * @param other box to contain
+     * @return reference to this box
+     */
+    constexpr Box3D &extend(const Box3D &other);
+
+    /**
+     * @param point to test
+     * @return true if the point is in the box, the boundary included
+     */
+    constexpr bool contains(const Vector3D &point) const;
+
+    /**
+     * @param other box to test
+     * @return true if the boxes share a point
+     */
+    constexpr bool overlaps(const Box3D &other) const;
+
+    /**
+     * @return the center of the box
+     */
+    constexpr Vector3D center() const { return (_corners[0] + _corners[1]) * 0.5; }
+
+    /**
+     * @return upper - lower
+     */
+    constexpr Vector3D extent() const { return _corners[1] - _corners[0]; }
+
+    /**
+     * @return the area of the surface, 0 for an empty box
+     */
+    constexpr double surface_area() const;
+
+    /**
+     * the slab test.
+     * @param ray to test
+     * @param limit largest distance along the ray of interest
+     * @return the distance along the ray where it enters the box (0 if it starts inside), or
+     * +inf if it misses the box within [0, limit]
+     */
+    inline double intersect(const Ray3D &ray, double limit = numeric_limits<double>::infinity()) const;
+
+private:
+    /**
+     * @return +inf
+     */
+    static constexpr double inf() { return numeric_limits<double>::infinity(); }
+
+    Vector3D _corners[2]; /**< lower and upper, indexed by Ray3D::negative in the slab test. */
+
+};
+
+// copied as raw bytes, like Vector3D
+static_assert(is_trivially_copyable<Box3D>::value, "Box3D is copied with memcpy");
+
+/**
+* @return true if the box contains no point
+*/
+constexpr bool Box3D::empty() const
+{
+    return ! (_corners[0][0] <= _corners[1][0] && _corners[0][1] <= _corners[1][1] &&
+              _corners[0][2] <= _corners[1][2]);
+}
+
+/**
+* grows the box to contain a point.
+* @param point to contain
+* @return reference to this box
+*/
+constexpr Box3D &Box3D::extend(const Vector3D &point)
+{
+    double *lower = _corners[0].data(), *upper = _corners[1].data();
+    const double *p = point.data();
+    unroll<3>([&](size_t axis) {
+        lower[axis] = min(lower[axis], p[axis]);
+        upper[axis] = max(upper[axis], p[axis]);
+    });
+    return *this;
+}
+
+/**
+* grows the box to contain another.
+* @param other box to contain
+* @return reference to this box
+*/
+constexpr Box3D &Box3D::extend(const Box3D &other)
+{
+    double *lower = _corners[0].data(), *upper = _corners[1].data();
+    const double *otherLower = other._corners[0].data(), *otherUpper = other._corners[1].data();
+    unroll<3>([&](size_t axis) {
+        lower[axis] = min(lower[axis], otherLower[axis]);
+        upper[axis] = max(upper[axis], otherUpper[axis]);
+    });
+    return *this;
+}
+
+/**
+* @param point to test
+* @return true if the point is in the box, the boundary included
+*/
+constexpr bool Box3D::contains(const Vector3D &point) const
+{
+    // & rather than &&: no branches, so loops over points vectorize
+    return (_corners[0][0] <= point[0]) & (point[0] <= _corners[1][0]) & (_corners[0][1] <= point[1]) &
+           (point[1] <= _corners[1][1]) & (_corners[0][2] <= point[2]) & (point[2] <= _corners[1][2]);
+}
+
+/**
+* @param other box to test
+* @return true if the boxes share a point
+*/
+constexpr bool Box3D::overlaps(const Box3D &other) const
+{
+    return (_corners[0][0] <= other._corners[1][0]) & (other._corners[0][0] <= _corners[1][0]) &
+           (_corners[0][1] <= other._corners[1][1]) & (other._corners[0][1] <= _corners[1][1]) &
+           (_corners[0][2] <= other._corners[1][2]) & (other._corners[0][2] <= _corners[1][2]);
+}
+
+/**
+* @return the area of the surface, 0 for an empty box
+*/
+constexpr double Box3D::surface_area() const
+{
+    if (empty())
+    {
+        return 0;
+    }
+    Vector3D e = extent();
+    return 2 * (e[0] * e[1] + e[1] * e[2] + e[2] * e[0]);
+}
+
+/**
+* the slab test.
+* @param ray to test
+* @param limit largest distance along the ray of interest
+* @return the distance along the ray where it enters the box (0 if it starts inside), or
+* +inf if it misses the box within [0, limit]
+*/
+inline double Box3D::intersect(const Ray3D &ray, const double limit) const
+{
+    const double *origin = ray.origin.data(), *inverse = ray.inverse.data();
+    double enter = 0, exit = limit;
+    for (int axis = 0; axis < 3; ++ axis)
+    {
+        // the near plane is the upper one for a negative direction
+        double near = (_corners[ray.negative[axis]].data()[axis] - origin[axis]) * inverse[axis];
+        double far = (_corners[1 - ray.negative[axis]].data()[axis] - origin[axis]) * inverse[axis];
+        // a NaN (0 * inf on a slab plane) loses both comparisons and keeps enter and exit
+        enter = near > enter ? near : enter;
+        exit = far < exit ? far : exit;
+    }
+    return enter <= exit ? enter : inf();
+}
+
+/**
+ * out[i] = box.contains(points[i])
+ * @param box to test against
+ * @param points to test
+ * @param out 1 for the points inside and 0 for the others, same size as points
+ * @return number of points inside
+ */
+size_t contains_batch(const Box3D &box, Span<const Vector3D> points, Span<unsigned char> out);
+
+#endif //EX1_BOX3D_H
@@ -0,0 +1,647 @@
+// Created by liorP.
+//
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <type_traits>
+#include "BulkIO.h"
+
+#define FORMAT_ERROR "Malformed number in the input"
+#define COUNT_ERROR "The input ends in the middle of an element"
+#define HEADER_ERROR "The input is not a binary file of this library"
+#define WIDTH_ERROR "The binary file holds elements of another type"
+#define SIZE_ERROR "The input is shorter than its header says"
+#define READ_ERROR "Failed reading the input"
+#define WRITE_ERROR "Failed writing the output"
+
+/**
+ * the longest number the text writer prints, in characters. the text reader has at least
+ * this much of a number in its block before it parses it, and reads on for longer ones.
+ */
+#define IO_TOKEN 64
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the bulk readers and writers.
+// --------------------------------------------------------------------------------------
+
+static_assert(sizeof(Vector3D) == 3 * sizeof(double) && is_standard_layout<Vector3D>::value,
+              "the binary format is read into Vector3D arrays as interleaved doubles");
+static_assert(sizeof(Matrix3D) == 9 * sizeof(double) && is_standard_layout<Matrix3D>::value,
+              "the binary format is read into Matrix3D arrays as row major doubles");
+static_assert(sizeof(BinaryHeader) == 24, "the header has no padding");
+
+namespace
+{
+/**
+ * Parses whitespace separated numbers out of a stream, read IO_BLOCK bytes at a time.
+ */
+class TextReader
+{
+public:
+    /**
+     * A constructor.
+     * @param is stream to read
+     */
+    explicit TextReader(istream &is) : _is(is), _buffer(IO_BLOCK), _begin(_buffer.data()), _end(_begin),
+                                       _eof(false), _failed(false) {}
+
+    /**
+     * parses the next number.
+     * @param value receives the number
+     * @return false at the end of the input, or if it failed (see failed())
+     */
+    bool next(double &value)
+    {
+        while (true)
+        {
+            while (_begin < _end && isSpace(*_begin))
+            {
+                ++ _begin;
+            }
+            // keep a whole token in the buffer, so from_chars rarely stops at its end
+            if (_end - _begin >= IO_TOKEN || _eof)
+            {
+                break;
+            }
+            refill();
+        }
+        if (_begin == _end)
+        {
+            return false;
+        }
+        while (true)
+        {
+            from_chars_result result = from_chars(_begin, _end, value);
+            if (result.ec == errc() && (result.ptr == _end ? _eof : isSpace(*result.ptr)))
+            {
+                _begin = result.ptr;
+                return true;
+            }
+            // a token longer than IO_TOKEN may go on past the block: read the rest and parse again
+            if (_eof || find_if(_begin, _end, isSpace) != _end)
+            {
+                cerr << FORMAT_ERROR << endl;
+                _failed = true;
+                return false;
+            }
+            refill();
+        }
+    }
+
+    /**
+     * @return true if the input was malformed or the stream failed
+     */
+    bool failed() const { return _failed; }
+
+private:
+    istream &_is; /**< the stream. */
+    vector<char> _buffer; /**< the block of the stream. */
+    const char *_begin; /**< first unparsed character of the block. */
+    const char *_end; /**< end of the read characters of the block. */
+    bool _eof; /**< true once the stream has nothing more. */
+    bool _failed; /**< true once an error was printed. */
+
+    /**
+     * @param c a character
+     * @return true for the separators of numbers
+     */
+    static bool isSpace(const char c)
+    {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r';
+    }
+
+    /**
+     * moves the unparsed characters to the start of the block and reads after them. a block
+     * full of a single token is doubled.
+     */
+    void refill()
+    {
+        size_t kept = _end - _begin;
+        memmove(_buffer.data(), _begin, kept);
+        if (kept == _buffer.size())
+        {
+            _buffer.resize(2 * _buffer.size());
+        }
+        _is.read(_buffer.data() + kept, (streamsize) (_buffer.size() - kept));
+        size_t read = (size_t) _is.gcount();
+        if (_is.bad())
+        {
+            cerr << READ_ERROR << endl;
+            _failed = true;
+        }
+        _eof = read == 0 || ! _is;
+        _begin = _buffer.data();
+        _end = _begin + kept + read;
+    }
+};
+
+/**
+ * Prints numbers into a block and writes it to a stream once it is full.
+ */
+class TextWriter
+{
+public:
+    /**
+     * A constructor.
+     * @param os stream to write
+     */
+    explicit TextWriter(ostream &os) : _os(os), _buffer(IO_BLOCK), _end(_buffer.data()) {}
+
+    /**
+     * prints a number, shortest form that reads back to the same double.
+     * @param value the number
+     * @param separator printed after the number
+     */
+    void number(const double value, const char separator)
+    {
+        if (_buffer.data() + _buffer.size() - _end < IO_TOKEN)
+        {
+            flush();
+        }
+        _end = to_chars(_end, _end + IO_TOKEN - 1, value).ptr;
+        *_end ++ = separator;
+    }
+
+    /**
+     * writes what is left in the block.
+     * @return true if the stream is good
+     */
+    bool flush()
+    {
+        _os.write(_buffer.data(), _end - _buffer.data());
+        _end = _buffer.data();
+        return (bool) _os;
+    }
+
+private:
+    ostream &_os; /**< the stream. */
+    vector<char> _buffer; /**< the block. */
+    char *_end; /**< end of the printed characters of the block. */
+
+};
+}
+
+/**
+ * reads numbers width at a time until the end of the input.
+ * @param is stream to read
+ * @param width numbers per element
+ * @param store called with the width numbers of every element
+ * @return true on success
+ */
+template<typename Store>
+static bool readElements(istream &is, const size_t width, Store store)
+{
+    TextReader reader(is);
+    double values[9];
+    while (reader.next(values[0]))
+    {
+        for (size_t i = 1; i < width; ++ i)
+        {
+            if (! reader.next(values[i]))
+            {
+                if (! reader.failed())
+                {
+                    cerr << COUNT_ERROR << endl;
+                }
+                return false;
+            }
+        }
+        store(values);
+    }
+    return ! reader.failed();
+}
+
+/**
+ * writes doubles as text, width to a line.
+ * @param os stream to write
+ * @param values the doubles
+ * @param count number of doubles
+ * @param width numbers per line
+ * @return true on success
+ */
+static bool writeLines(ostream &os, const double *values, const size_t count, const size_t width)
+{
+    TextWriter writer(os);
+    for (size_t i = 0; i < count; ++ i)
+    {
+        writer.number(values[i], (i + 1) % width == 0 ? '\n' : ' ');
+    }
+    if (! writer.flush())
+    {
+        cerr << WRITE_ERROR << endl;
+        return false;
+    }
+    return true;
+}
+
+// ------------------ Text ------------------------
+
+/**
+* reads vectors from text until the end of the stream.
+* @param is stream to read
+* @param points receives the vectors
+* @return true on success
+*/
+bool read_text(istream &is, vector<Vector3D> &points)
+{
+    INSTRUMENT_SCOPE("read_text(Vector3D)");
+    points.clear();
+    return readElements(is, 3, [&](const double *v) { points.emplace_back(v[0], v[1], v[2]); });
+}
+
+/**
+* reads vectors from text until the end of the stream.
+* @param is stream to read
+* @param points receives the vectors, unchanged on failure
+* @return true on success
+*/
+bool read_text(istream &is, Vector3DArray &points)
+{
+    INSTRUMENT_SCOPE("read_text(Vector3DArray)");
+    vector<Vector3D> read;
+    if (! read_text(is, read))
+    {
+        return false;
+    }
+    points = Vector3DArray(read);
+    return true;
+}
+
+/**
+* reads matrices from text until the end of the stream.
+* @param is stream to read
+* @param matrices receives the matrices
+* @return true on success
+*/
+bool read_text(istream &is, vector<Matrix3D> &matrices)
+{
+    INSTRUMENT_SCOPE("read_text(Matrix3D)");
+    matrices.clear();
+    return readElements(is, 9, [&](const double *v) { matrices.emplace_back(v); });
+}
+
+/**
+* writes vectors as text, a vector per line.
+* @param os stream to write
+* @param points vectors to write
+* @return true on success
+*/
+bool write_text(ostream &os, const Span<const Vector3D> points)
+{
+    INSTRUMENT_SCOPE("write_text(Vector3D)");
+    return writeLines(os, reinterpret_cast<const double *>(points.data()), 3 * points.size(), 3);
+}
+
+/**
+* writes vectors as text, a vector per line.
+* @param os stream to write
+* @param points vectors to write
+* @return true on success
+*/
+bool write_text(ostream &os, const Vector3DArray &points)
+{
+    INSTRUMENT_SCOPE("write_text(Vector3DArray)");
+    TextWriter writer(os);
+    for (size_t i = 0; i < points.size(); ++ i)
+    {
+        writer.number(points.x()[i], ' ');
+        writer.number(points.y()[i], ' ');
+        writer.number(points.z()[i], '\n');
+    }
+    if (! writer.flush())
+    {
+        cerr << WRITE_ERROR << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+* writes matrices as text, a row per line.
+* @param os stream to write
+* @param matrices matrices to write
+* @return true on success
+*/
+bool write_text(ostream &os, const Span<const Matrix3D> matrices)
+{
+    INSTRUMENT_SCOPE("write_text(Matrix3D)");
+    return writeLines(os, reinterpret_cast<const double *>(matrices.data()), 9 * matrices.size(), 3);
+}
+
+// ------------------ Binary ------------------------
+
+/**
+ * reverses the byte order of doubles.
+ * @param values the doubles
+ * @param count number of doubles
+ */
+static void swapBytes(double *values, const size_t count)
+{
+    for (size_t i = 0; i < count; ++ i)
+    {
+        uint64_t bits;
+        memcpy(&bits, values + i, sizeof(bits));
+        bits = __builtin_bswap64(bits);
+        memcpy(values + i, &bits, sizeof(bits));
+    }
+}
+
+/**
+ * @param is stream after the header
+ * @return number of bytes left in the stream, UINT64_MAX if it can't seek (e.g. a pipe)
+ */
+static uint64_t bytesLeft(istream &is)
+{
+    const streampos here = is.tellg();
+    if (here == streampos(- 1))
+    {
+        return UINT64_MAX;
+    }
+    if (! is.seekg(0, ios::end))
+    {
+        is.clear();
+        is.seekg(here);
+        return UINT64_MAX;
+    }
+    const streampos end = is.tellg();
+    is.seekg(here);
+    return end == streampos(- 1) || end < here ? UINT64_MAX : (uint64_t) (end - here);
+}
+
+/**
+* reads and checks the header of a binary file.
+* the count of the header is checked against the bytes left in the stream when it can seek,
+* and against the size of the address space otherwise: the readers grow their output a
+* block at a time, so a stream that can't seek may still end before count elements.
+* @param is stream to read
+* @param width doubles per element the caller expects
+* @param count receives the number of elements
+* @param swap receives true if the file is of the other byte order
+* @return true on success
+*/
+bool read_header(istream &is, const uint32_t width, uint64_t &count, bool &swap)
+{
+    BinaryHeader header{};
+    if (! is.read(reinterpret_cast<char *>(&header), sizeof(header)) ||
+        memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) != 0)
+    {
+        cerr << HEADER_ERROR << endl;
+        return false;
+    }
+    swap = header.endian != BINARY_ENDIAN;
+    if (swap)
+    {
+        header.endian = __builtin_bswap32(header.endian);
+        header.width = __builtin_bswap32(header.width);
+        header.count = __builtin_bswap64(header.count);
+    }
+    if (header.endian != BINARY_ENDIAN)
+    {
+        cerr << HEADER_ERROR << endl;
+        return false;
+    }
+    if (header.width != width)
+    {
+        cerr << WIDTH_ERROR << endl;
+        return false;
+    }
+    const uint64_t element = (uint64_t) width * sizeof(double);
+    if (header.count > SIZE_MAX / element || header.count > bytesLeft(is) / element)
+    {
+        cerr << SIZE_ERROR << endl;
+        return false;
+    }
+    count = header.count;
+    return true;
+}
+
+/**
+* reads doubles of a binary file.
+* @param is stream to read
+* @param values receives the doubles
+* @param count number of doubles
+* @param swap true if the file is of the other byte order
+* @return true on success
+*/
+bool read_records(istream &is, double *values, const size_t count, const bool swap)
+{
+    if (! is.read(reinterpret_cast<char *>(values), (streamsize) (count * sizeof(double))))
+    {
+        cerr << READ_ERROR << endl;
+        return false;
+    }
+    if (swap)
+    {
+        swapBytes(values, count);
+    }
+    return true;
+}
+
+/**
+* writes the header of a binary file, in the native byte order.
+* @param os stream to write
+* @param width doubles per element
+* @param count number of elements
+*/
+void write_header(ostream &os, const uint32_t width, const uint64_t count)
+{
+    BinaryHeader header{};
+    memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    header.endian = BINARY_ENDIAN;
+    header.width = width;
+    header.count = count;
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+}
+
+/**
+ * writes a whole binary file of interleaved doubles.
+ * @param os stream to write
+ * @param values the doubles
+ * @param count number of elements
+ * @param width doubles per element
+ * @return true on success
+ */
+static bool writeBinary(ostream &os, const double *values, const size_t count, const uint32_t width)
+{
+    write_header(os, width, count);
+    os.write(reinterpret_cast<const char *>(values), (streamsize) (count * width * sizeof(double)));
+    if (! os)
+    {
+        cerr << WRITE_ERROR << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @param is stream after a header read by read_header
+ * @param count number of elements of the header
+ * @return count if the stream can seek, as read_header checked it against the bytes left
+ * then, and 0 if it can't, as the count of the header is all there is to go by
+ */
+static uint64_t checkedCount(istream &is, const uint64_t count)
+{
+    return bytesLeft(is) == UINT64_MAX ? 0 : count;
+}
+
+/**
+ * reads the elements of a binary file into a vector. it is sized up front for a checked
+ * count (see checkedCount), and grown IO_BLOCK bytes at a time otherwise, so it never
+ * takes more memory than the stream has data for, whatever the header says.
+ * @param is stream to read, after the header
+ * @param out receives the elements, cleared on failure
+ * @param count number of elements, from the header
+ * @param swap true if the file is of the other byte order
+ * @return true on success
+ */
+template<typename T>
+static bool readElements(istream &is, vector<T> &out, const uint64_t count, const bool swap)
+{
+    constexpr size_t width = sizeof(T) / sizeof(double), step = IO_BLOCK / sizeof(T);
+    out.reserve((size_t) checkedCount(is, count));
+    for (uint64_t first = 0; first < count; first += step)
+    {
+        size_t n = (size_t) min((uint64_t) step, count - first);
+        out.resize((size_t) first + n);
+        if (! read_records(is, reinterpret_cast<double *>(out.data() + first), width * n, swap))
+        {
+            out.clear();
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+* reads a binary file of vectors.
+* @param is stream to read, opened in binary mode
+* @param points receives the vectors
+* @return true on success
+*/
+bool read_binary(istream &is, vector<Vector3D> &points)
+{
+    INSTRUMENT_SCOPE("read_binary(Vector3D)");
+    uint64_t count;
+    bool swap;
+    points.clear();
+    if (! read_header(is, 3, count, swap))
+    {
+        return false;
+    }
+    return readElements(is, points, count, swap);
+}
+
+/**
+* reads a binary file of vectors.
+* @param is stream to read, opened in binary mode
+* @param points receives the vectors
+* @return true on success
+*/
+bool read_binary(istream &is, Vector3DArray &points)
+{
+    INSTRUMENT_SCOPE("read_binary(Vector3DArray)");
+    uint64_t count;
+    bool swap;
+    points.resize(0);
+    if (! read_header(is, 3, count, swap))
+    {
+        return false;
+    }
+    // sized up front for a checked count, and grown geometrically as the blocks come otherwise
+    Vector3DArray read((size_t) checkedCount(is, count));
+    vector<double> block(IO_BLOCK / sizeof(double) / 3 * 3);
+    for (size_t first = 0; first < count; first += block.size() / 3)
+    {
+        size_t n = (size_t) min((uint64_t) block.size() / 3, count - first);
+        if (! read_records(is, block.data(), 3 * n, swap))
+        {
+            return false;
+        }
+        if (first + n > read.size())
+        {
+            read.resize((size_t) min(count, (uint64_t) max(first + n, 2 * read.size())));
+        }
+        for (size_t i = 0; i < n; ++ i)
+        {
+            read.x()[first + i] = block[3 * i];
+            read.y()[first + i] = block[3 * i + 1];
+            read.z()[first + i] = block[3 * i + 2];
+        }
+    }
+    points = move(read);
+    return true;
+}
+
+/**
+* reads a binary file of matrices.
+* @param is stream to read, opened in binary mode
+* @param matrices receives the matrices
+* @return true on success
+*/
+bool read_binary(istream &is, vector<Matrix3D> &matrices)
+{
+    INSTRUMENT_SCOPE("read_binary(Matrix3D)");
+    uint64_t count;
+    bool swap;
+    matrices.clear();
+    if (! read_header(is, 9, count, swap))
+    {
+        return false;
+    }
+    return readElements(is, matrices, count, swap);
+}
+
+/**
+* writes a binary file of vectors.
+* @param os stream to write, opened in binary mode
+* @param points vectors to write
+* @return true on success
+*/
+bool write_binary(ostream &os, const Span<const Vector3D> points)
+{
+    INSTRUMENT_SCOPE("write_binary(Vector3D)");
+    return writeBinary(os, reinterpret_cast<const double *>(points.data()), points.size(), 3);
+}
+
+/**
+* writes a binary file of vectors.
+* @param os stream to write, opened in binary mode
+* @param points vectors to write
+* @return true on success
+*/
+bool write_binary(ostream &os, const Vector3DArray &points)
+{
+    INSTRUMENT_SCOPE("write_binary(Vector3DArray)");
+    write_header(os, 3, points.size());
+    vector<double> block(IO_BLOCK / sizeof(double) / 3 * 3);
+    for (size_t first = 0; first < points.size() && os; first += block.size() / 3)
+    {
+        size_t n = min(block.size() / 3, points.size() - first);
+        for (size_t i = 0; i < n; ++ i)
+        {
+            block[3 * i] = points.x()[first + i];
+            block[3 * i + 1] = points.y()[first + i];
+            block[3 * i + 2] = points.z()[first + i];
+        }
+        os.write(reinterpret_cast<const char *>(block.data()), (streamsize) (3 * n * sizeof(double)));
+    }
+    if (! os)
+    {
+        cerr << WRITE_ERROR << endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+* writes a binary file of matrices.
+* @param os stream to write, opened in binary mode
+* @param matrices matrices to write
+* @return true on success
+*/
+bool write_binary(ostream &os, const Span<const Matrix3D> matrices)
+{
+    INSTRUMENT_SCOPE("write_binary(Matrix3D)");
+    return writeBinary(os, reinterpret_cast<const double *>(matrices.data()), matrices.size(), 9);
+}
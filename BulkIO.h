@@ -0,0 +1,191 @@
+// Created by liorP.
+//
+
+#ifndef EX1_BULKIO_H
+#define EX1_BULKIO_H
+
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "Matrix3D.h"
+#include "Span.h"
+#include "Vector3DArray.h"
+
+// --------------------------------------------------------------------------------------
+// Bulk readers and writers of whole point sets and matrix sets.
+//
+// Text: whitespace separated numbers, 3 per vector and 9 per matrix (row after row), which
+// is what the << operators print. Numbers are parsed with from_chars and printed with
+// to_chars (shortest round trip), so neither the locale nor iostreams are involved beyond
+// moving IO_BLOCK sized blocks.
+//
+// Binary: a BinaryHeader followed by count elements of width doubles, interleaved (x y z of
+// a vector, the rows of a matrix). Files are written in the native byte order, and read in
+// either byte order.
+//
+// All the functions print an error and return false when the input is malformed or the
+// stream fails.
+// --------------------------------------------------------------------------------------
+
+/**
+ * number of bytes the readers and writers move to and from the stream at a time.
+ */
+#define IO_BLOCK (1 << 16)
+
+/**
+ * the first 4 bytes of a binary file.
+ */
+#define BINARY_MAGIC "EX1B"
+
+/**
+ * the byte order mark, reads back as 0x04030201 on a machine of the other byte order.
+ */
+#define BINARY_ENDIAN 0x01020304u
+
+/**
+ * The header of a binary file, 24 bytes.
+ */
+struct BinaryHeader
+{
+    char magic[4]; /**< BINARY_MAGIC, without the terminating zero. */
+    uint32_t endian; /**< BINARY_ENDIAN, in the byte order of the file. */
+    uint32_t width; /**< doubles per element: 3 for Vector3D, 9 for Matrix3D. */
+    uint32_t reserved; /**< zero. */
+    uint64_t count; /**< number of elements. */
+};
+
+// ------------------ Text ------------------------
+
+/**
+ * reads vectors from text until the end of the stream.
+ * @param is stream to read
+ * @param points receives the vectors
+ * @return true on success
+ */
+bool read_text(istream &is, vector<Vector3D> &points);
+
+/**
+ * reads vectors from text until the end of the stream.
+ * @param is stream to read
+ * @param points receives the vectors, unchanged on failure
+ * @return true on success
+ */
+bool read_text(istream &is, Vector3DArray &points);
+
+/**
+ * reads matrices from text until the end of the stream.
+ * @param is stream to read
+ * @param matrices receives the matrices
+ * @return true on success
+ */
+bool read_text(istream &is, vector<Matrix3D> &matrices);
+
+/**
+ * writes vectors as text, a vector per line.
+ * @param os stream to write
+ * @param points vectors to write
+ * @return true on success
+ */
+bool write_text(ostream &os, Span<const Vector3D> points);
+
+/**
+ * writes vectors as text, a vector per line.
+ * @param os stream to write
+ * @param points vectors to write
+ * @return true on success
+ */
+bool write_text(ostream &os, const Vector3DArray &points);
+
+/**
+ * writes matrices as text, a row per line.
+ * @param os stream to write
+ * @param matrices matrices to write
+ * @return true on success
+ */
+bool write_text(ostream &os, Span<const Matrix3D> matrices);
+
+// ------------------ Binary ------------------------
+
+/**
+ * reads a binary file of vectors.
+ * @param is stream to read, opened in binary mode
+ * @param points receives the vectors
+ * @return true on success
+ */
+bool read_binary(istream &is, vector<Vector3D> &points);
+
+/**
+ * reads a binary file of vectors.
+ * @param is stream to read, opened in binary mode
+ * @param points receives the vectors
+ * @return true on success
+ */
+bool read_binary(istream &is, Vector3DArray &points);
+
+/**
+ * reads a binary file of matrices.
+ * @param is stream to read, opened in binary mode
+ * @param matrices receives the matrices
+ * @return true on success
+ */
+bool read_binary(istream &is, vector<Matrix3D> &matrices);
+
+/**
+ * writes a binary file of vectors.
+ * @param os stream to write, opened in binary mode
+ * @param points vectors to write
+ * @return true on success
+ */
+bool write_binary(ostream &os, Span<const Vector3D> points);
+
+/**
+ * writes a binary file of vectors.
+ * @param os stream to write, opened in binary mode
+ * @param points vectors to write
+ * @return true on success
+ */
+bool write_binary(ostream &os, const Vector3DArray &points);
+
+/**
+ * writes a binary file of matrices.
+ * @param os stream to write, opened in binary mode
+ * @param matrices matrices to write
+ * @return true on success
+ */
+bool write_binary(ostream &os, Span<const Matrix3D> matrices);
+
+// the pieces of the binary readers and writers, for streaming a file element block by element
+// block (see Pipeline.h).
+
+/**
+ * reads and checks the header of a binary file.
+ * the count of the header is checked against the bytes left in the stream when it can seek,
+ * and against the size of the address space otherwise.
+ * @param is stream to read
+ * @param width doubles per element the caller expects
+ * @param count receives the number of elements
+ * @param swap receives true if the file is of the other byte order
+ * @return true on success
+ */
+bool read_header(istream &is, uint32_t width, uint64_t &count, bool &swap);
+
+/**
+ * reads doubles of a binary file, after its header.
+ * @param is stream to read
+ * @param values receives the doubles
+ * @param count number of doubles
+ * @param swap true if the file is of the other byte order
+ * @return true on success
+ */
+bool read_records(istream &is, double *values, size_t count, bool swap);
+
+/**
+ * writes the header of a binary file, in the native byte order. the records follow as
+ * interleaved doubles.
+ * @param os stream to write
+ * @param width doubles per element
+ * @param count number of elements
+ */
+void write_header(ostream &os, uint32_t width, uint64_t count);
+
+#endif //EX1_BULKIO_H
@@ -0,0 +1,381 @@
+// Created by liorP.
+//
+
+#include <algorithm>
+#include "Bvh.h"
+#include "Parallel.h"
+
+#define SIZE_ERROR "Input and output sizes differ"
+#define COUNT_ERROR "Too many primitives for a Bvh"
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the Bvh class and of the triangle soup queries.
+// The build is templates over the node type, the private Bvh::Node.
+// --------------------------------------------------------------------------------------
+
+namespace
+{
+/**
+ * sets the box of a child of a node.
+ * @param node to set
+ * @param c the child
+ * @param box its box
+ */
+template<typename Node>
+void setBounds(Node &node, const int c, const Box3D &box)
+{
+    for (int axis = 0; axis < 3; ++ axis)
+    {
+        node.bounds[0][axis][c] = box.lower().data()[axis];
+        node.bounds[1][axis][c] = box.upper().data()[axis];
+    }
+}
+
+/**
+ * A primitive being built, its box next to its index so that the splits scan and reorder
+ * contiguous memory.
+ */
+struct Item
+{
+    Box3D box; /**< box of the primitive. */
+    size_t index; /**< index of the primitive. */
+};
+
+/**
+ * @param item a primitive
+ * @param axis an axis
+ * @return twice the coordinate of the center of the box along the axis
+ */
+inline double centroid(const Item &item, const int axis)
+{
+    return item.box.lower().data()[axis] + item.box.upper().data()[axis];
+}
+
+/**
+ * extends the box of a sweep by the box of a bin.
+ * @param bin box of the bin, possibly empty
+ * @param lower the minimal corner of the sweep, extended
+ * @param upper the maximal corner of the sweep, extended
+ * @return half the surface area of the extended sweep, 0 while it is empty
+ */
+inline double area(const Box3D &bin, double lower[3], double upper[3])
+{
+    double extent[3];
+    for (int axis = 0; axis < 3; ++ axis)
+    {
+        lower[axis] = min(lower[axis], bin.lower().data()[axis]);
+        upper[axis] = max(upper[axis], bin.upper().data()[axis]);
+        extent[axis] = max(upper[axis] - lower[axis], 0.0);
+    }
+    return extent[0] * extent[1] + extent[1] * extent[2] + extent[2] * extent[0];
+}
+
+/**
+ * splits [begin, end) in two, at the cheapest of the BVH_BINS planes of every axis by the
+ * surface area heuristic, or at the median along the widest axis of the centroids below
+ * depth BVH_DEPTH and when the centroids do not spread.
+ * @param items of the tree, reordered
+ * @param begin first item of the subtree
+ * @param end past the last item of the subtree
+ * @param depth of the subtree
+ * @param left receives the box of [begin, mid)
+ * @param right receives the box of [mid, end)
+ * @return mid, or begin if a leaf is cheaper than a split
+ */
+size_t split(Item *items, const size_t begin, const size_t end, const size_t depth, Box3D &left, Box3D &right)
+{
+    const double inf = numeric_limits<double>::infinity();
+    const size_t count = end - begin;
+    if (count <= 1)
+    {
+        return begin;
+    }
+    Box3D box;
+    double lower[3] = {inf, inf, inf}, upper[3] = {- inf, - inf, - inf};
+    for (size_t i = begin; i < end; ++ i)
+    {
+        box.extend(items[i].box);
+        for (int axis = 0; axis < 3; ++ axis)
+        {
+            lower[axis] = min(lower[axis], centroid(items[i], axis));
+            upper[axis] = max(upper[axis], centroid(items[i], axis));
+        }
+    }
+    // no more bins than items, the sweeps over the bins are most of the work of a small range
+    const int bins = (int) min((size_t) BVH_BINS, count);
+    int widest = 0;
+    double scale[3];
+    for (int axis = 0; axis < 3; ++ axis)
+    {
+        widest = upper[axis] - lower[axis] > upper[widest] - lower[widest] ? axis : widest;
+        // all the centroids fall in bin 0 of an axis they do not spread along
+        scale[axis] = upper[axis] > lower[axis] ? bins / (upper[axis] - lower[axis]) : 0;
+    }
+    auto bin = [&](const Item &item, int axis) {
+        return min(bins - 1, (int) ((centroid(item, axis) - lower[axis]) * scale[axis]));
+    };
+    size_t mid = begin;
+    if (depth < BVH_DEPTH && upper[widest] > lower[widest])
+    {
+        // one pass bins the items along the 3 axes
+        Box3D boxes[3][BVH_BINS];
+        size_t counts[3][BVH_BINS] = {};
+        for (size_t i = begin; i < end; ++ i)
+        {
+            for (int axis = 0; axis < 3; ++ axis)
+            {
+                int b = bin(items[i], axis);
+                boxes[axis][b].extend(items[i].box);
+                ++ counts[axis][b];
+            }
+        }
+        double best = inf;
+        int bestAxis = 0, bestBin = 0;
+        for (int axis = 0; axis < 3; ++ axis)
+        {
+            // costs[b]: area times count of the bins from b on, then a sweep from the left
+            double costs[BVH_BINS];
+            double lo[3] = {inf, inf, inf}, hi[3] = {- inf, - inf, - inf};
+            size_t sideCount = 0;
+            for (int b = bins - 1; b > 0; -- b)
+            {
+                sideCount += counts[axis][b];
+                costs[b] = (double) sideCount * area(boxes[axis][b], lo, hi);
+            }
+            fill(lo, lo + 3, inf);
+            fill(hi, hi + 3, - inf);
+            sideCount = 0;
+            for (int b = 0; b < bins - 1; ++ b)
+            {
+                sideCount += counts[axis][b];
+                double cost = (double) sideCount * area(boxes[axis][b], lo, hi) + costs[b + 1];
+                if (sideCount > 0 && sideCount < count && cost < best)
+                {
+                    best = cost;
+                    bestAxis = axis;
+                    bestBin = b;
+                }
+            }
+        }
+        // best counts half areas
+        double surface = box.surface_area();
+        if (count <= BVH_LEAF && BVH_TRAVERSAL + (surface > 0 ? 2 * best / surface : 0) >= (double) count)
+        {
+            return begin;
+        }
+        if (best < inf)
+        {
+            mid = (size_t) (partition(items + begin, items + end, [&](const Item &item) {
+                return bin(item, bestAxis) <= bestBin;
+            }) - items);
+            left = Box3D();
+            right = Box3D();
+            for (int b = 0; b < bins; ++ b)
+            {
+                (b <= bestBin ? left : right).extend(boxes[bestAxis][b]);
+            }
+            return mid;
+        }
+    }
+    if (count <= BVH_LEAF)
+    {
+        return begin;
+    }
+    mid = begin + count / 2;
+    nth_element(items + begin, items + mid, items + end, [widest](const Item &a, const Item &b) {
+        return centroid(a, widest) < centroid(b, widest);
+    });
+    left = Box3D();
+    right = Box3D();
+    for (size_t i = begin; i < mid; ++ i)
+    {
+        left.extend(items[i].box);
+    }
+    for (size_t i = mid; i < end; ++ i)
+    {
+        right.extend(items[i].box);
+    }
+    return mid;
+}
+
+/**
+ * builds the subtree of [begin, end) into nodes.
+ * @param nodes receives the inner nodes of the subtree, numbered from its size
+ * @param items of the tree, reordered
+ * @param begin first item of the subtree
+ * @param end past the last item of the subtree
+ * @param depth of the subtree
+ * @param child receives the child of the subtree, as in Bvh::Node
+ * @param count receives the count of the subtree, as in Bvh::Node
+ */
+template<typename Node>
+void buildRange(vector<Node> &nodes, Item *items, const size_t begin, const size_t end, const size_t depth,
+                uint32_t &child, uint32_t &count)
+{
+    Box3D left, right;
+    size_t mid = split(items, begin, end, depth, left, right);
+    if (mid == begin)
+    {
+        child = (uint32_t) begin;
+        count = (uint32_t) (end - begin);
+        return;
+    }
+    const size_t index = nodes.size();
+    nodes.emplace_back();
+    setBounds(nodes[index], 0, left);
+    setBounds(nodes[index], 1, right);
+    // nodes may grow below, so the children are set after
+    uint32_t children[2], counts[2];
+    buildRange(nodes, items, begin, mid, depth + 1, children[0], counts[0]);
+    buildRange(nodes, items, mid, end, depth + 1, children[1], counts[1]);
+    for (int c = 0; c < 2; ++ c)
+    {
+        nodes[index].child[c] = children[c];
+        nodes[index].count[c] = counts[c];
+    }
+    child = (uint32_t) index;
+    count = 0;
+}
+}
+
+/**
+* A constructor - builds the tree, the top levels on the calling thread and the
+* subtrees below them in parallel.
+* @param boxes bounding boxes of the primitives, primitive i has index i. at most
+* UINT32_MAX of them
+*/
+Bvh::Bvh(const Span<const Box3D> boxes) : _root{0, 0}
+{
+    INSTRUMENT_SCOPE("Bvh::Bvh");
+    if (boxes.empty())
+    {
+        return;
+    }
+    if (boxes.size() > UINT32_MAX)
+    {
+        cerr << COUNT_ERROR << endl;
+        return;
+    }
+    const size_t n = boxes.size();
+    vector<Item> built(n);
+    for (size_t i = 0; i < n; ++ i)
+    {
+        built[i] = Item{boxes[i], i};
+        _bounds.extend(boxes[i]);
+    }
+    Item *items = built.data();
+
+    /**
+     * A subtree left to build, the child slot of an inner node or the root.
+     */
+    struct Task
+    {
+        size_t begin, end, depth; /**< the primitives and the depth of the subtree. */
+        size_t node; /**< the inner node whose child it is, SIZE_MAX for the root. */
+        int c; /**< which child of the node. */
+    };
+    auto link = [&](const Task &task, uint32_t child, uint32_t count) {
+        uint32_t &slotChild = task.node == SIZE_MAX ? _root[0] : _nodes[task.node].child[task.c];
+        uint32_t &slotCount = task.node == SIZE_MAX ? _root[1] : _nodes[task.node].count[task.c];
+        slotChild = child;
+        slotCount = count;
+    };
+    // the top levels split here until there are a few subtrees a thread
+    vector<Task> tasks = {Task{0, n, 0, SIZE_MAX, 0}};
+    const size_t subtrees = parallelism() > 1 ? 4 * (size_t) parallelism() : 1;
+    while (! tasks.empty() && tasks.size() < subtrees)
+    {
+        vector<Task> next;
+        for (const Task &task : tasks)
+        {
+            Box3D left, right;
+            size_t mid = split(items, task.begin, task.end, task.depth, left, right);
+            if (mid == task.begin)
+            {
+                link(task, (uint32_t) task.begin, (uint32_t) (task.end - task.begin));
+                continue;
+            }
+            const size_t index = _nodes.size();
+            _nodes.emplace_back();
+            setBounds(_nodes[index], 0, left);
+            setBounds(_nodes[index], 1, right);
+            link(task, (uint32_t) index, 0);
+            next.push_back(Task{task.begin, mid, task.depth + 1, index, 0});
+            next.push_back(Task{mid, task.end, task.depth + 1, index, 1});
+        }
+        tasks.swap(next);
+    }
+    // every subtree numbers its nodes from 0, and is renumbered when appended
+    vector<vector<Node>> local(tasks.size());
+    vector<pair<uint32_t, uint32_t>> roots(tasks.size());
+    parallel_for(tasks.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++ i)
+        {
+            buildRange(local[i], items, tasks[i].begin, tasks[i].end, tasks[i].depth, roots[i].first,
+                       roots[i].second);
+        }
+    });
+    for (size_t i = 0; i < tasks.size(); ++ i)
+    {
+        const uint32_t offset = (uint32_t) _nodes.size();
+        for (Node &node : local[i])
+        {
+            for (int c = 0; c < 2; ++ c)
+            {
+                node.child[c] += node.count[c] == 0 ? offset : 0;
+            }
+        }
+        _nodes.insert(_nodes.end(), local[i].begin(), local[i].end());
+        link(tasks[i], roots[i].first + (roots[i].second == 0 ? offset : 0), roots[i].second);
+    }
+    _primitives.resize(n);
+    for (size_t i = 0; i < n; ++ i)
+    {
+        _primitives[i] = (uint32_t) built[i].index;
+    }
+}
+
+/**
+* @param triangles a triangle soup: triangle i has the vertices triangles[3 * i, 3 * i + 3)
+* @return the bounding boxes of the triangles, to build a Bvh of them
+*/
+vector<Box3D> triangle_boxes(const Span<const Vector3D> triangles)
+{
+    vector<Box3D> ans(triangles.size() / 3);
+    parallel_for(ans.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++ i)
+        {
+            ans[i].extend(triangles[3 * i]).extend(triangles[3 * i + 1]).extend(triangles[3 * i + 2]);
+        }
+    });
+    return ans;
+}
+
+/**
+* out[i] = the nearest triangle along rays[i], in parallel.
+* @param bvh built over triangle_boxes(triangles)
+* @param triangles the triangle soup, as in triangle_boxes
+* @param rays to trace
+* @param out the nearest hit of every ray, same size as rays
+*/
+void intersect_batch(const Bvh &bvh, const Span<const Vector3D> triangles, const Span<const Ray3D> rays,
+                     const Span<RayHit> out)
+{
+    INSTRUMENT_SCOPE("intersect_batch");
+    if (rays.size() != out.size() || triangles.size() != 3 * bvh.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return;
+    }
+    const Vector3D *vertices = triangles.data();
+    auto test = [vertices](size_t primitive, const Ray3D &ray, double) {
+        const Vector3D *triangle = vertices + 3 * primitive;
+        return intersect_triangle(ray, triangle[0], triangle[1], triangle[2]);
+    };
+    parallel_for(rays.size(), BVH_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++ i)
+        {
+            out[i] = bvh.closest_hit(rays[i], test);
+        }
+    });
+}
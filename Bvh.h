@@ -0,0 +1,299 @@
+// Created by liorP.
+//
+
+#ifndef EX1_BVH_H
+#define EX1_BVH_H
+
+#include <cstdint>
+#include <vector>
+#include "Box3D.h"
+
+// --------------------------------------------------------------------------------------
+// A bounding volume hierarchy over primitives given by their Box3D, for ray and box queries.
+// The tree is binary and built top down with the surface area heuristic, evaluated at the
+// BVH_BINS planes of every axis between the centroids (binned SAH), and stops splitting when
+// a leaf is cheaper than a split. A node holds the boxes of its 2 children axis major, so a
+// ray meets both children in one slab test of 2 lanes, and goes on with the nearer child
+// first. The primitives themselves are the caller's: a query calls back with a primitive
+// index, and the triangles of a soup are the case provided here.
+// The top levels are split on the calling thread, and the subtrees below them are built in
+// parallel into node arrays of their own, appended after.
+// --------------------------------------------------------------------------------------
+
+/**
+ * number of bins of the surface area heuristic along an axis.
+ */
+#define BVH_BINS 16
+
+/**
+ * most primitives in a leaf.
+ */
+#define BVH_LEAF 8
+
+/**
+ * cost of a node visit relative to a primitive test, in the surface area heuristic.
+ */
+#define BVH_TRAVERSAL 2.0
+
+/**
+ * depth below which nodes split at the median, so the depth is at most BVH_DEPTH + 32.
+ */
+#define BVH_DEPTH 32
+
+/**
+ * number of rays in a chunk of the batched queries.
+ */
+#define BVH_GRAIN 256
+
+/**
+ * A result of a ray query.
+ */
+struct RayHit
+{
+    size_t primitive; /**< index of the primitive hit, SIZE_MAX for a miss. */
+    double t; /**< distance along the ray of the hit, +inf for a miss. */
+};
+
+/**
+ * A Bvh class.
+ * This class represents a spatial index over primitives, each given by its bounding box.
+ */
+class Bvh
+{
+public:
+    /**
+     * A default constructor - an empty index.
+     */
+    Bvh() : _root{0, 0} {}
+
+    /**
+     * A constructor - builds the tree, the top levels on the calling thread and the
+     * subtrees below them in parallel.
+     * @param boxes bounding boxes of the primitives, primitive i has index i. at most
+     * UINT32_MAX of them
+     */
+    explicit Bvh(Span<const Box3D> boxes);
+
+    /**
+     * @return number of primitives in the index
+     */
+    size_t size() const { return _primitives.size(); }
+
+    /**
+     * @return bounding box of all the primitives
+     */
+    const Box3D &bounds() const { return _bounds; }
+
+    /**
+     * the nearest primitive along a ray.
+     * @param ray to trace
+     * @param test test(primitive, ray, limit) returns the distance along the ray where it
+     * meets the primitive, or anything not smaller than limit (e.g. +inf) if not before limit
+     * @param limit largest distance along the ray of interest
+     * @return the nearest primitive hit before limit, with its distance
+     */
+    template<typename Test>
+    RayHit closest_hit(const Ray3D &ray, Test test, double limit = numeric_limits<double>::infinity()) const;
+
+    /**
+     * calls visit(primitive) once for every primitive of the leaves whose box overlaps a box:
+     * all the primitives whose box overlaps it, and some of their neighbors, for the caller
+     * to test.
+     * @param box to search
+     * @param visit callback, in no particular order
+     */
+    template<typename Visit>
+    void overlapping(const Box3D &box, Visit visit) const;
+
+private:
+    /**
+     * An inner node, two cache lines.
+     */
+    struct alignas(64) Node
+    {
+        double bounds[2][3][2]; /**< bounds[upper][axis][child]: the boxes of the children. */
+        uint32_t child[2]; /**< index of an inner child node, first primitive of a leaf child. */
+        uint32_t count[2]; /**< 0 for an inner child, number of primitives of a leaf child. */
+    };
+
+    /**
+     * A subtree to visit.
+     */
+    struct Entry
+    {
+        uint32_t child; /**< as in Node. */
+        uint32_t count; /**< as in Node. */
+        double enter; /**< distance along the ray where it enters the subtree. */
+    };
+
+    /**
+     * size of the traversal stack: one entry a level, plus the root.
+     */
+    static constexpr size_t STACK = BVH_DEPTH + 34;
+
+    vector<Node> _nodes; /**< the inner nodes. */
+    vector<uint32_t> _primitives; /**< the primitives, in leaf order. */
+    uint32_t _root[2]; /**< child and count of the root, as in Node. */
+    Box3D _bounds; /**< bounding box of the root. */
+
+};
+
+/**
+* the nearest primitive along a ray.
+* @param ray to trace
+* @param test test(primitive, ray, limit) returns the distance along the ray where it
+* meets the primitive, or anything not smaller than limit (e.g. +inf) if not before limit
+* @param limit largest distance along the ray of interest
+* @return the nearest primitive hit before limit, with its distance
+*/
+template<typename Test>
+RayHit Bvh::closest_hit(const Ray3D &ray, Test test, const double limit) const
+{
+    RayHit hit{SIZE_MAX, limit};
+    if (_primitives.empty())
+    {
+        return hit;
+    }
+    Entry stack[STACK];
+    size_t top = 0;
+    stack[top ++] = Entry{_root[0], _root[1], _bounds.intersect(ray, limit)};
+    const double *origin = ray.origin.data(), *inverse = ray.inverse.data();
+    while (top > 0)
+    {
+        Entry entry = stack[-- top];
+        if (entry.enter >= hit.t)
+        {
+            continue;
+        }
+        if (entry.count > 0)
+        {
+            for (uint32_t i = entry.child; i < entry.child + entry.count; ++ i)
+            {
+                double t = test((size_t) _primitives[i], ray, hit.t);
+                if (t < hit.t)
+                {
+                    hit = RayHit{_primitives[i], t};
+                }
+            }
+            continue;
+        }
+        // the slab test of both children, lane by lane
+        const Node &node = _nodes[entry.child];
+        double enter[2] = {0, 0}, exit[2] = {hit.t, hit.t};
+        for (int axis = 0; axis < 3; ++ axis)
+        {
+            const double *near = node.bounds[ray.negative[axis]][axis];
+            const double *far = node.bounds[1 - ray.negative[axis]][axis];
+            for (int c = 0; c < 2; ++ c)
+            {
+                double tNear = (near[c] - origin[axis]) * inverse[axis];
+                double tFar = (far[c] - origin[axis]) * inverse[axis];
+                enter[c] = tNear > enter[c] ? tNear : enter[c];
+                exit[c] = tFar < exit[c] ? tFar : exit[c];
+            }
+        }
+        // the nearer child is pushed last, to be popped first
+        int first = enter[1] < enter[0];
+        for (int c : {1 - first, first})
+        {
+            if (enter[c] <= exit[c])
+            {
+                stack[top ++] = Entry{node.child[c], node.count[c], enter[c]};
+            }
+        }
+    }
+    return hit;
+}
+
+/**
+* calls visit(primitive) once for every primitive of the leaves whose box overlaps a box:
+* all the primitives whose box overlaps it, and some of their neighbors, for the caller
+* to test.
+* @param box to search
+* @param visit callback, in no particular order
+*/
+template<typename Visit>
+void Bvh::overlapping(const Box3D &box, Visit visit) const
+{
+    if (_primitives.empty() || ! _bounds.overlaps(box))
+    {
+        return;
+    }
+    Entry stack[STACK];
+    size_t top = 0;
+    stack[top ++] = Entry{_root[0], _root[1], 0};
+    const double *lower = box.lower().data(), *upper = box.upper().data();
+    while (top > 0)
+    {
+        Entry entry = stack[-- top];
+        if (entry.count > 0)
+        {
+            for (uint32_t i = entry.child; i < entry.child + entry.count; ++ i)
+            {
+                visit((size_t) _primitives[i]);
+            }
+            continue;
+        }
+        const Node &node = _nodes[entry.child];
+        for (int c = 0; c < 2; ++ c)
+        {
+            if ((node.bounds[0][0][c] <= upper[0]) & (lower[0] <= node.bounds[1][0][c]) &
+                (node.bounds[0][1][c] <= upper[1]) & (lower[1] <= node.bounds[1][1][c]) &
+                (node.bounds[0][2][c] <= upper[2]) & (lower[2] <= node.bounds[1][2][c]))
+            {
+                stack[top ++] = Entry{node.child[c], node.count[c], 0};
+            }
+        }
+    }
+}
+
+/**
+ * the Moller-Trumbore ray / triangle test.
+ * @param ray to test
+ * @param a,b,c vertices of the triangle
+ * @return the distance along the ray where it meets the triangle, +inf if it misses it or
+ * is parallel to it
+ */
+inline double intersect_triangle(const Ray3D &ray, const Vector3D &a, const Vector3D &b, const Vector3D &c)
+{
+    const double inf = numeric_limits<double>::infinity();
+    Vector3D ab = b - a, ac = c - a;
+    Vector3D p = cross(ray.direction, ac);
+    double determinant = ab * p;
+    if (determinant == 0)
+    {
+        return inf;
+    }
+    double inverse = 1 / determinant;
+    Vector3D s = ray.origin - a;
+    double u = (s * p) * inverse;
+    if (u < 0 || u > 1)
+    {
+        return inf;
+    }
+    Vector3D q = cross(s, ab);
+    double v = (ray.direction * q) * inverse;
+    if (v < 0 || u + v > 1)
+    {
+        return inf;
+    }
+    double t = (ac * q) * inverse;
+    return t >= 0 ? t : inf;
+}
+
+/**
+ * @param triangles a triangle soup: triangle i has the vertices triangles[3 * i, 3 * i + 3)
+ * @return the bounding boxes of the triangles, to build a Bvh of them
+ */
+vector<Box3D> triangle_boxes(Span<const Vector3D> triangles);
+
+/**
+ * out[i] = the nearest triangle along rays[i], in parallel.
+ * @param bvh built over triangle_boxes(triangles)
+ * @param triangles the triangle soup, as in triangle_boxes
+ * @param rays to trace
+ * @param out the nearest hit of every ray, same size as rays
+ */
+void intersect_batch(const Bvh &bvh, Span<const Vector3D> triangles, Span<const Ray3D> rays, Span<RayHit> out);
+
+#endif //EX1_BVH_H
@@ -0,0 +1,204 @@
+// Created by liorP.
+//
+
+#include <cmath>
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "Bvh.h"
+
+/**
+ * largest triangle soup of the benchmarks.
+ */
+#ifndef BVH_TRIANGLES_MAX
+#define BVH_TRIANGLES_MAX 1000000
+#endif
+
+/**
+ * number of rays of the tree queries.
+ */
+#define BVH_RAYS (1 << 16)
+
+/**
+ * number of triangles the brute force scans test in total, split between their rays.
+ */
+#define BRUTE_FORCE_WORK 50000000
+
+/**
+ * mean distance a ray travels between triangles.
+ */
+#define FREE_PATH 50.0
+
+// --------------------------------------------------------------------------------------
+// Benchmarks of the Bvh over triangle soups of 10^4 up to BVH_TRIANGLES_MAX triangles around
+// points uniform in [-100, 100)^3, sized so that a ray meets a triangle every FREE_PATH on
+// average: building, and the nearest hit of rays from points of the cube in uniform
+// directions, one by one and batched, against brute force intersect_triangle scans. And the
+// Box3D tests, the slab test against the textbook one with divisions and swaps, and the
+// batched containment against a loop of && comparisons.
+// --------------------------------------------------------------------------------------
+
+/**
+ * @param count number of triangles
+ * @return a soup of count triangles, of about the same size, around points of the cube
+ */
+static vector<Vector3D> benchTriangles(size_t count)
+{
+    // the cube has a volume of 200^3, a triangle of edge s an area of about s^2 / 2
+    const double edge = sqrt(2 * 8e6 / (FREE_PATH * (double) count));
+    const vector<Vector3D> centers = bench_points(count, 3), offsets = bench_points(3 * count, 4);
+    vector<Vector3D> ans(3 * count);
+    for (size_t i = 0; i < ans.size(); ++ i)
+    {
+        ans[i] = centers[i / 3] + offsets[i] * (edge / 100);
+    }
+    return ans;
+}
+
+/**
+ * @param count number of rays
+ * @return rays from points of the cube, in uniform directions
+ */
+static vector<Ray3D> benchRays(size_t count)
+{
+    const vector<Vector3D> origins = bench_points(count, 5), directions = bench_points(count, 6);
+    vector<Ray3D> ans(count);
+    for (size_t i = 0; i < count; ++ i)
+    {
+        ans[i] = Ray3D(origins[i], directions[i] / directions[i].norm());
+    }
+    return ans;
+}
+
+/**
+ * @param triangles the triangle soup
+ * @param ray to trace
+ * @return index of the nearest triangle along the ray, SIZE_MAX if none
+ */
+static size_t bruteClosest(const vector<Vector3D> &triangles, const Ray3D &ray)
+{
+    size_t best = SIZE_MAX;
+    double distance = numeric_limits<double>::infinity();
+    for (size_t i = 0; i < triangles.size(); i += 3)
+    {
+        double t = intersect_triangle(ray, triangles[i], triangles[i + 1], triangles[i + 2]);
+        if (t < distance)
+        {
+            distance = t;
+            best = i / 3;
+        }
+    }
+    return best;
+}
+
+/**
+ * benchmarks the tree and the brute force scans on growing triangle soups.
+ * @param bench to measure with
+ */
+static void rayQueries(Bench &bench)
+{
+    const vector<Ray3D> rays = benchRays(BVH_RAYS);
+    vector<RayHit> out(BVH_RAYS);
+    for (size_t count = 10000; count <= BVH_TRIANGLES_MAX; count *= 10)
+    {
+        const string suffix = "/" + to_string(count);
+        const vector<Vector3D> triangles = benchTriangles(count);
+        const vector<Box3D> boxes = triangle_boxes(triangles);
+        bench.measure("Bvh build" + suffix, count, [&]() { keep(Bvh(boxes).size()); });
+        const Bvh bvh(boxes);
+        const size_t brute = max((size_t) 2, (size_t) BRUTE_FORCE_WORK / count);
+        bench.measure("brute force intersect_triangle" + suffix, brute, [&]() {
+            for (size_t i = 0; i < brute; ++ i)
+            {
+                keep(bruteClosest(triangles, rays[i]));
+            }
+        });
+        const Vector3D *vertices = triangles.data();
+        bench.measure("loop Bvh::closest_hit" + suffix, BVH_RAYS, [&]() {
+            for (const Ray3D &ray : rays)
+            {
+                keep(bvh.closest_hit(ray, [vertices](size_t primitive, const Ray3D &r, double) {
+                    const Vector3D *t = vertices + 3 * primitive;
+                    return intersect_triangle(r, t[0], t[1], t[2]);
+                }).primitive);
+            }
+        });
+        bench.measure("intersect_batch" + suffix, BVH_RAYS, [&]() {
+            intersect_batch(bvh, triangles, rays, out);
+            keep(out);
+        });
+    }
+}
+
+/**
+ * the textbook slab test, with divisions and a swap per axis.
+ * @param box to test
+ * @param ray to test
+ * @return true if the ray meets the box
+ */
+static bool naiveSlab(const Box3D &box, const Ray3D &ray)
+{
+    double enter = 0, exit = numeric_limits<double>::infinity();
+    for (int axis = 0; axis < 3; ++ axis)
+    {
+        double t1 = (box.lower()[axis] - ray.origin[axis]) / ray.direction[axis];
+        double t2 = (box.upper()[axis] - ray.origin[axis]) / ray.direction[axis];
+        if (t1 > t2)
+        {
+            swap(t1, t2);
+        }
+        enter = max(enter, t1);
+        exit = min(exit, t2);
+        if (enter > exit)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * benchmarks the Box3D ray and containment tests.
+ * @param bench to measure with
+ */
+static void boxTests(Bench &bench)
+{
+    const vector<Vector3D> corners = bench_points(BENCH_ARRAY, 7), sizes = bench_points(BENCH_ARRAY, 8);
+    vector<Box3D> boxes(BENCH_ARRAY);
+    for (size_t i = 0; i < boxes.size(); ++ i)
+    {
+        boxes[i] = Box3D(corners[i], corners[i] + Vector3D(abs(sizes[i][0]), abs(sizes[i][1]), abs(sizes[i][2])) *
+                                                  0.1);
+    }
+    const vector<Ray3D> rays = benchRays(16);
+    bench.measure("naive slab test", BENCH_ARRAY, [&]() {
+        size_t hits = 0;
+        for (size_t i = 0; i < boxes.size(); ++ i)
+        {
+            hits += naiveSlab(boxes[i], rays[i % 16]);
+        }
+        keep(hits);
+    });
+    bench.measure("Box3D::intersect", BENCH_ARRAY, [&]() {
+        size_t hits = 0;
+        for (size_t i = 0; i < boxes.size(); ++ i)
+        {
+            hits += boxes[i].intersect(rays[i % 16]) < numeric_limits<double>::infinity();
+        }
+        keep(hits);
+    });
+    const vector<Vector3D> points = bench_points(BENCH_ARRAY, 9);
+    const Box3D box(Vector3D(- 50, - 50, - 50), Vector3D(50, 50, 50));
+    vector<unsigned char> inside(BENCH_ARRAY);
+    bench.measure("loop && containment", BENCH_ARRAY, [&]() {
+        for (size_t i = 0; i < points.size(); ++ i)
+        {
+            const Vector3D &p = points[i];
+            inside[i] = p[0] >= - 50 && p[0] <= 50 && p[1] >= - 50 && p[1] <= 50 && p[2] >= - 50 && p[2] <= 50;
+        }
+        keep(inside);
+    });
+    bench.measure("contains_batch", BENCH_ARRAY, [&]() { keep(contains_batch(box, points, inside)); });
+}
+
+BENCHMARK(rayQueries);
+BENCHMARK(boxTests);
@@ -0,0 +1,89 @@
+// Created by liorP.
+//
+
+#include <algorithm>
+#include "BenchData.h"
+#include "Benchmark.h"
+
+/**
+ * number of elements of the copy benchmarks.
+ */
+#define COPIED (BENCH_ARRAY / 4)
+
+// --------------------------------------------------------------------------------------
+// Value semantics benchmarks: bulk copies of Vector3D / Matrix3D, which the standard library
+// turns into memmove for trivially copyable types, and loops made of assignments, chained
+// compound operators and row constructors.
+// --------------------------------------------------------------------------------------
+
+/**
+ * benchmarks bulk copies through the standard containers and algorithms.
+ * @param bench to measure with
+ */
+static void bulkCopies(Bench &bench)
+{
+    vector<Vector3D> points = bench_points(COPIED), pointsOut(COPIED);
+    vector<Matrix3D> matrices = bench_matrices(COPIED), matricesOut(COPIED);
+    const string trivial = is_trivially_copyable<Matrix3D>::value ? " (trivially copyable)" : "";
+    bench.measure("copy(Vector3D)" + trivial, COPIED, [&]() {
+        copy(points.begin(), points.end(), pointsOut.begin());
+        keep(pointsOut);
+    });
+    bench.measure("copy(Matrix3D)" + trivial, COPIED, [&]() {
+        copy(matrices.begin(), matrices.end(), matricesOut.begin());
+        keep(matricesOut);
+    });
+    bench.measure("vector<Matrix3D>::operator=" + trivial, COPIED, [&]() {
+        matricesOut = matrices;
+        keep(matricesOut);
+    });
+    bench.measure("vector<Vector3D>::insert at front" + trivial, COPIED, [&]() {
+        pointsOut.insert(pointsOut.begin(), points[0]);
+        pointsOut.pop_back();
+        keep(pointsOut);
+    });
+}
+
+/**
+ * benchmarks loops of assignments, compound operators and constructors.
+ * @param bench to measure with
+ */
+static void assignmentLoops(Bench &bench)
+{
+    vector<Vector3D> points = bench_points(COPIED), others = bench_points(COPIED, 2), out(COPIED);
+    vector<Matrix3D> matrices(COPIED);
+    bench.measure("out = a; out += b; out *= s", COPIED, [&]() {
+        for (size_t i = 0; i < COPIED; ++ i)
+        {
+            out[i] = points[i];
+            out[i] += others[i];
+            out[i] *= 0.5;
+        }
+        keep(out);
+    });
+    bench.measure("((out = a) += b) *= s", COPIED, [&]() {
+        for (size_t i = 0; i < COPIED; ++ i)
+        {
+            ((out[i] = points[i]) += others[i]) *= 0.5;
+        }
+        keep(out);
+    });
+    bench.measure("Matrix3D(row, row, row)", COPIED, [&]() {
+        for (size_t i = 0; i + 2 < COPIED; ++ i)
+        {
+            matrices[i] = Matrix3D(points[i], points[i + 1], points[i + 2]);
+        }
+        keep(matrices);
+    });
+    Matrix3D sum;
+    bench.measure("sum = sum * m + m", COPIED, [&]() {
+        for (size_t i = 0; i < COPIED; ++ i)
+        {
+            sum = sum * matrices[i] + matrices[i];
+        }
+        keep(sum);
+    });
+}
+
+BENCHMARK(bulkCopies);
+BENCHMARK(assignmentLoops);
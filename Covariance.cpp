@@ -0,0 +1,125 @@
+// Created by liorP.
+//
+
+#include <algorithm>
+#include "Covariance.h"
+#include "Parallel.h"
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the CovarianceAccumulator.
+// --------------------------------------------------------------------------------------
+
+/**
+* adds a point.
+* @param point to add
+*/
+void CovarianceAccumulator::add(const Vector3D &point)
+{
+    ++ _count;
+    Vector3D before = point - _mean;
+    _mean += before / (double) _count;
+    Vector3D after = point - _mean;
+    for (int i = 0; i < 3; ++ i)
+    {
+        _scatter[i] += after * before[i];
+    }
+}
+
+/**
+* adds points, a block at a time.
+* @param points to add
+*/
+void CovarianceAccumulator::add(const Span<const Vector3D> points)
+{
+    for (size_t first = 0; first < points.size(); first += COVARIANCE_BLOCK)
+    {
+        size_t count = min((size_t) COVARIANCE_BLOCK, points.size() - first);
+        const double *p = points[first].data();
+        // the mean of the block, then the scatter about it while the block is in the cache
+        double x = 0, y = 0, z = 0;
+        for (size_t i = 0; i < 3 * count; i += 3)
+        {
+            x += p[i];
+            y += p[i + 1];
+            z += p[i + 2];
+        }
+        CovarianceAccumulator block;
+        block._count = count;
+        block._mean = Vector3D(x, y, z) / (double) count;
+        const double mx = block._mean[0], my = block._mean[1], mz = block._mean[2];
+        double xx = 0, xy = 0, xz = 0, yy = 0, yz = 0, zz = 0;
+        for (size_t i = 0; i < 3 * count; i += 3)
+        {
+            double dx = p[i] - mx, dy = p[i + 1] - my, dz = p[i + 2] - mz;
+            xx += dx * dx;
+            xy += dx * dy;
+            xz += dx * dz;
+            yy += dy * dy;
+            yz += dy * dz;
+            zz += dz * dz;
+        }
+        block._scatter = Matrix3D(xx, xy, xz, xy, yy, yz, xz, yz, zz);
+        merge(block);
+    }
+}
+
+/**
+* adds the points of another accumulator.
+* @param other accumulator to merge
+*/
+void CovarianceAccumulator::merge(const CovarianceAccumulator &other)
+{
+    if (other._count == 0)
+    {
+        return;
+    }
+    if (_count == 0)
+    {
+        *this = other;
+        return;
+    }
+    // the scatters about the two means, plus the scatter of the means about the new mean
+    double count = (double) (_count + other._count);
+    Vector3D delta = other._mean - _mean;
+    double weight = (double) _count * (double) other._count / count;
+    _mean += delta * ((double) other._count / count);
+    _scatter += other._scatter;
+    for (int i = 0; i < 3; ++ i)
+    {
+        _scatter[i] += delta * (delta[i] * weight);
+    }
+    _count += other._count;
+}
+
+/**
+* @param sample whether to divide by count - 1 (the unbiased estimate) instead of count
+* @return the covariance matrix, the zero matrix if there are too few points
+*/
+Matrix3D CovarianceAccumulator::covariance(const bool sample) const
+{
+    if (_count <= (sample ? 1u : 0u))
+    {
+        return Matrix3D();
+    }
+    Matrix3D ans = _scatter;
+    ans /= (double) (sample ? _count - 1 : _count);
+    return ans;
+}
+
+/**
+* accumulates points in parallel, a CovarianceAccumulator per chunk merged in order.
+* @param points to accumulate
+* @return the accumulator of all the points
+*/
+CovarianceAccumulator parallel_covariance(const Span<const Vector3D> points)
+{
+    INSTRUMENT_SCOPE("parallel_covariance");
+    return parallel_reduce(points.size(), PARALLEL_GRAIN, CovarianceAccumulator(), [&](size_t begin, size_t end) {
+        CovarianceAccumulator chunk;
+        chunk.add(points.subspan(begin, end - begin));
+        return chunk;
+    }, [](CovarianceAccumulator a, const CovarianceAccumulator &b) {
+        a.merge(b);
+        return a;
+    });
+}
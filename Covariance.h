@@ -0,0 +1,87 @@
+// Created by liorP.
+//
+
+#ifndef EX1_COVARIANCE_H
+#define EX1_COVARIANCE_H
+
+#include "Matrix3D.h"
+#include "Span.h"
+
+// --------------------------------------------------------------------------------------
+// A streaming centroid and covariance of Vector3D, numerically stable: the accumulator keeps
+// the mean and the scatter about it (Welford), never the raw sums of x and x * transpose(x)
+// that cancel catastrophically when the points are far from the origin.
+// Ranges are added a block of COVARIANCE_BLOCK points at a time, two passes over the cached
+// block, and partial accumulators merge exactly (Chan et al.), so threads reduce in parallel.
+// --------------------------------------------------------------------------------------
+
+/**
+ * number of points of a block of add(Span).
+ */
+#define COVARIANCE_BLOCK 1024
+
+/**
+ * The count, mean and scatter of a set of points.
+ */
+class CovarianceAccumulator
+{
+public:
+    /**
+     * A constructor - an empty set.
+     */
+    CovarianceAccumulator() : _count(0) {}
+
+    /**
+     * adds a point.
+     * @param point to add
+     */
+    void add(const Vector3D &point);
+
+    /**
+     * adds points, a block at a time.
+     * @param points to add
+     */
+    void add(Span<const Vector3D> points);
+
+    /**
+     * adds the points of another accumulator.
+     * @param other accumulator to merge
+     */
+    void merge(const CovarianceAccumulator &other);
+
+    /**
+     * @return number of points added
+     */
+    size_t count() const { return _count; }
+
+    /**
+     * @return the centroid of the points, the zero vector if there are none
+     */
+    const Vector3D &centroid() const { return _mean; }
+
+    /**
+     * @return the scatter matrix, the sum of (x - centroid) * transpose(x - centroid)
+     */
+    const Matrix3D &scatter() const { return _scatter; }
+
+    /**
+     * @param sample whether to divide by count - 1 (the unbiased estimate) instead of count
+     * @return the covariance matrix, the zero matrix if there are too few points
+     */
+    Matrix3D covariance(bool sample = false) const;
+
+private:
+    size_t _count; /**< number of points. */
+    Vector3D _mean; /**< the centroid. */
+    Matrix3D _scatter; /**< sum of the outer products of the deviations from the centroid. */
+
+};
+
+/**
+ * accumulates points in parallel, a CovarianceAccumulator per chunk merged in order.
+ * @param points to accumulate
+ * @return the accumulator of all the points
+ */
+CovarianceAccumulator parallel_covariance(Span<const Vector3D> points);
+
+#endif //EX1_COVARIANCE_H
@@ -0,0 +1,149 @@
+// Created by liorP.
+//
+
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "Covariance.h"
+
+/**
+ * number of points of the covariance benchmarks.
+ */
+#define COVARIANCE_POINTS (1 << 22)
+
+// --------------------------------------------------------------------------------------
+// Benchmarks of the covariance of a point set: the hand written one pass loop over the
+// sums of x and x * transpose(x), the Welford update per point, and the blocked add of
+// CovarianceAccumulator. The points are the random ones, and the same ones moved 1e6 from
+// the origin, like the coordinates of a scan in a world frame; the error of every method
+// against a long double two pass covariance is recorded with it (max_error). The thread scaling of
+// parallel_covariance is in ParallelBench.
+// --------------------------------------------------------------------------------------
+
+/**
+ * @param points the points
+ * @return their covariance, two passes in long double
+ */
+static Matrix3D reference(const vector<Vector3D> &points)
+{
+    long double mean[3] = {}, scatter[3][3] = {};
+    for (const Vector3D &p : points)
+    {
+        for (int i = 0; i < 3; ++ i)
+        {
+            mean[i] += p[i];
+        }
+    }
+    for (long double &m : mean)
+    {
+        m /= points.size();
+    }
+    for (const Vector3D &p : points)
+    {
+        for (int i = 0; i < 3; ++ i)
+        {
+            for (int j = 0; j < 3; ++ j)
+            {
+                scatter[i][j] += (p[i] - mean[i]) * (p[j] - mean[j]);
+            }
+        }
+    }
+    Matrix3D ans;
+    for (int i = 0; i < 3; ++ i)
+    {
+        for (int j = 0; j < 3; ++ j)
+        {
+            ans[i][j] = (double) (scatter[i][j] / points.size());
+        }
+    }
+    return ans;
+}
+
+/**
+ * @param covariance a covariance
+ * @param exact the exact one
+ * @return the largest element error relative to the largest element of exact
+ */
+static double relativeError(const Matrix3D &covariance, const Matrix3D &exact)
+{
+    double error = 0, scale = 0;
+    for (int i = 0; i < 3; ++ i)
+    {
+        for (int j = 0; j < 3; ++ j)
+        {
+            error = max(error, std::abs(covariance[i][j] - exact[i][j]));
+            scale = max(scale, std::abs(exact[i][j]));
+        }
+    }
+    return error / scale;
+}
+
+/**
+ * the hand written covariance, one pass over the sums of the points and their outer products.
+ * @param points the points
+ * @return their covariance
+ */
+static Matrix3D onePass(const vector<Vector3D> &points)
+{
+    Vector3D sum;
+    Matrix3D products;
+    for (const Vector3D &p : points)
+    {
+        sum += p;
+        for (int i = 0; i < 3; ++ i)
+        {
+            products[i] += p * p[i];
+        }
+    }
+    Vector3D mean = sum / (double) points.size();
+    products /= (double) points.size();
+    for (int i = 0; i < 3; ++ i)
+    {
+        products[i] -= mean * mean[i];
+    }
+    return products;
+}
+
+/**
+ * benchmarks the covariance methods over points near and far from the origin.
+ * @param bench to measure with
+ */
+static void covariances(Bench &bench)
+{
+    for (bool far : {false, true})
+    {
+        vector<Vector3D> points = bench_points(COVARIANCE_POINTS);
+        if (far)
+        {
+            for (Vector3D &p : points)
+            {
+                p += 1e6;
+            }
+        }
+        const string kind = (far ? " far/" : "/") + to_string(points.size());
+        const Matrix3D exact = reference(points);
+        bench.measure("loop one pass sums" + kind, points.size(), [&]() {
+            keep(onePass(points));
+        }).max_error = relativeError(onePass(points), exact);
+        auto welford = [&]() {
+            CovarianceAccumulator accumulator;
+            for (const Vector3D &p : points)
+            {
+                accumulator.add(p);
+            }
+            return accumulator.covariance();
+        };
+        bench.measure("loop CovarianceAccumulator::add(Vector3D)" + kind, points.size(), [&]() {
+            keep(welford());
+        }).max_error = relativeError(welford(), exact);
+        auto blocked = [&]() {
+            CovarianceAccumulator accumulator;
+            accumulator.add(points);
+            return accumulator.covariance();
+        };
+        bench.measure("CovarianceAccumulator::add(Span)" + kind, points.size(), [&]() {
+            keep(blocked());
+        }).max_error = relativeError(blocked(), exact);
+    }
+}
+
+BENCHMARK(covariances);
@@ -0,0 +1,479 @@
+// Created by liorP.
+//
+
+#include <algorithm>
+#include <cfloat>
+#include "Decompose.h"
+#include "Simd.h"
+
+#define SIZE_ERROR "Input and output sizes differ"
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the Jacobi decompositions.
+// The kernels are templates over the lane type: double for a single matrix, simd_t for
+// SIMD_WIDTH matrices. The sorting and the completion of the bases run per matrix.
+// --------------------------------------------------------------------------------------
+
+#if SIMD_WIDTH > 1
+// the simd_* ops of the scalar build, so the kernels also run on double in the SIMD builds
+static inline double simd_add(double a, double b) { return a + b; }
+
+static inline double simd_sub(double a, double b) { return a - b; }
+
+static inline double simd_mul(double a, double b) { return a * b; }
+
+static inline double simd_div(double a, double b) { return a / b; }
+
+static inline double simd_fmadd(double a, double b, double c) { return a * b + c; }
+
+static inline double simd_sqrt(double a) { return std::sqrt(a); }
+
+static inline double simd_rsqrt(double a) { return 1 / std::sqrt(a); }
+
+static inline double simd_abs(double a) { return std::abs(a); }
+
+static inline double simd_copysign(double a, double b) { return std::copysign(a, b); }
+#endif
+
+namespace
+{
+/**
+ * @param a a number
+ * @return a in every lane of T
+ */
+template<typename T>
+inline T constant(double a)
+{
+    if constexpr (is_same<T, double>::value)
+    {
+        return a;
+    }
+    else
+    {
+        return simd_set(a);
+    }
+}
+
+/**
+ * the Jacobi rotation [c s; -s c] that diagonalizes the symmetric 2x2 matrix [app o; o aqq].
+ * t = s / c is the root of t^2 + 2 * t * (aqq - app) / (2 * o) - 1 = 0 of the smaller angle.
+ * @param app first diagonal element
+ * @param aqq second diagonal element
+ * @param o the off diagonal element
+ * @param c cosine of the angle
+ * @param s sine of the angle
+ * @param t tangent of the angle
+ */
+template<typename T>
+inline void rotation(const T app, const T aqq, const T o, T &c, T &s, T &t)
+{
+    T d = simd_sub(aqq, app);
+    T r = simd_sqrt(simd_fmadd(d, d, simd_mul(constant<T>(4), simd_mul(o, o))));
+    // DBL_MIN keeps 0 / 0 out when the matrix is already diagonal, giving the identity
+    T denominator = simd_add(simd_add(simd_abs(d), r), constant<T>(DBL_MIN));
+    t = simd_div(simd_mul(simd_add(o, o), simd_copysign(constant<T>(1), d)), denominator);
+    c = simd_rsqrt(simd_fmadd(t, t, constant<T>(1)));
+    s = simd_mul(t, c);
+}
+
+/**
+ * rotates columns p and q of a 3x3 matrix: col p = c * col p - s * col q, col q = s * col p + c * col q.
+ * @param m the columns
+ * @param c cosine of the angle
+ * @param s sine of the angle
+ */
+template<int P, int Q, typename T>
+inline void rotateColumns(T m[3][3], const T c, const T s)
+{
+    for (int k = 0; k < 3; ++ k)
+    {
+        T p = m[P][k], q = m[Q][k];
+        m[P][k] = simd_sub(simd_mul(c, p), simd_mul(s, q));
+        m[Q][k] = simd_fmadd(s, p, simd_mul(c, q));
+    }
+}
+
+/**
+ * a rotation of cyclic Jacobi: zeroes a[p][q] of the symmetric matrix a.
+ * @param a the symmetric matrix, a[i][j] for i <= j is kept
+ * @param v accumulates the rotations, v[j] is column j
+ */
+template<int P, int Q, typename T>
+inline void eigenStep(T a[3][3], T v[3][3])
+{
+    constexpr int R = 3 - P - Q;
+    T c, s, t;
+    rotation(a[P][P], a[Q][Q], a[P][Q], c, s, t);
+    T &rp = P < R ? a[P][R] : a[R][P], &rq = Q < R ? a[Q][R] : a[R][Q];
+    T arp = rp, arq = rq;
+    a[P][P] = simd_sub(a[P][P], simd_mul(t, a[P][Q]));
+    a[Q][Q] = simd_fmadd(t, a[P][Q], a[Q][Q]);
+    a[P][Q] = constant<T>(0);
+    rp = simd_sub(simd_mul(c, arp), simd_mul(s, arq));
+    rq = simd_fmadd(s, arp, simd_mul(c, arq));
+    rotateColumns<P, Q>(v, c, s);
+}
+
+/**
+ * cyclic Jacobi over a symmetric matrix.
+ * @param a the symmetric matrix, upper triangle. diagonal on return
+ * @param v the eigenvectors on return, v[j] is the one of a[j][j]
+ */
+template<typename T>
+inline void eigenKernel(T a[3][3], T v[3][3])
+{
+    for (int i = 0; i < 3; ++ i)
+    {
+        for (int j = 0; j < 3; ++ j)
+        {
+            v[i][j] = constant<T>(i == j ? 1 : 0);
+        }
+    }
+    for (int sweep = 0; sweep < DECOMPOSE_SWEEPS; ++ sweep)
+    {
+        eigenStep<0, 1>(a, v);
+        eigenStep<0, 2>(a, v);
+        eigenStep<1, 2>(a, v);
+    }
+}
+
+/**
+ * a rotation of one sided Jacobi: makes columns p and q of w orthogonal.
+ * @param w the columns being orthogonalized
+ * @param v accumulates the rotations, v[j] is column j
+ */
+template<int P, int Q, typename T>
+inline void svdStep(T w[3][3], T v[3][3])
+{
+    // the Jacobi rotation of the 2x2 block p, q of transpose(w) * w
+    T app = simd_fmadd(w[P][2], w[P][2], simd_fmadd(w[P][1], w[P][1], simd_mul(w[P][0], w[P][0])));
+    T aqq = simd_fmadd(w[Q][2], w[Q][2], simd_fmadd(w[Q][1], w[Q][1], simd_mul(w[Q][0], w[Q][0])));
+    T apq = simd_fmadd(w[P][2], w[Q][2], simd_fmadd(w[P][1], w[Q][1], simd_mul(w[P][0], w[Q][0])));
+    T c, s, t;
+    rotation(app, aqq, apq, c, s, t);
+    rotateColumns<P, Q>(w, c, s);
+    rotateColumns<P, Q>(v, c, s);
+}
+
+/**
+ * one sided Jacobi over the columns of a matrix.
+ * @param w the columns of the matrix. orthogonal on return, the singular values are their norms
+ * @param v the right singular vectors on return, v[j] is column j
+ */
+template<typename T>
+inline void svdKernel(T w[3][3], T v[3][3])
+{
+    for (int i = 0; i < 3; ++ i)
+    {
+        for (int j = 0; j < 3; ++ j)
+        {
+            v[i][j] = constant<T>(i == j ? 1 : 0);
+        }
+    }
+    for (int sweep = 0; sweep < DECOMPOSE_SWEEPS; ++ sweep)
+    {
+        svdStep<0, 1>(w, v);
+        svdStep<0, 2>(w, v);
+        svdStep<1, 2>(w, v);
+    }
+}
+
+/**
+ * @param u a unit vector
+ * @return a unit vector orthogonal to u
+ */
+Vector3D orthogonal(const Vector3D &u)
+{
+    // crossed with the axis u is the least aligned with
+    const double *p = u.data();
+    int axis = std::abs(p[0]) <= std::abs(p[1]) ? (std::abs(p[0]) <= std::abs(p[2]) ? 0 : 2)
+                                                 : (std::abs(p[1]) <= std::abs(p[2]) ? 1 : 2);
+    Vector3D e;
+    e.data()[axis] = 1;
+    Vector3D ans = cross(u, e);
+    return ans / ans.norm();
+}
+
+/**
+ * sorts the eigenpairs of a diagonalized matrix and makes the basis right handed.
+ * @param values the diagonal
+ * @param v v[j] is the eigenvector of values[j]
+ * @return the decomposition
+ */
+EigenDecomposition finishEigen(const double values[3], const double v[3][3])
+{
+    int order[3] = {0, 1, 2};
+    sort(order, order + 3, [&](int i, int j) { return values[i] < values[j]; });
+    EigenDecomposition ans;
+    for (int i = 0; i < 3; ++ i)
+    {
+        ans.values.data()[i] = values[order[i]];
+        ans.vectors[i] = Vector3D(v[order[i]]);
+    }
+    if (cross(ans.vectors[0], ans.vectors[1]) * ans.vectors[2] < 0)
+    {
+        ans.vectors[2] = - ans.vectors[2];
+    }
+    return ans;
+}
+
+/**
+ * sorts the singular triplets of an orthogonalized matrix, and makes u orthogonal and v a rotation.
+ * @param w w[j] is column j of u times its singular value
+ * @param v v[j] is column j of v
+ * @return the decomposition
+ */
+SingularDecomposition finishSvd(const double w[3][3], const double v[3][3])
+{
+    double norms[3];
+    for (int j = 0; j < 3; ++ j)
+    {
+        norms[j] = std::sqrt(w[j][0] * w[j][0] + w[j][1] * w[j][1] + w[j][2] * w[j][2]);
+    }
+    int order[3] = {0, 1, 2};
+    sort(order, order + 3, [&](int i, int j) { return norms[i] > norms[j]; });
+    Vector3D column[3], right[3];
+    SingularDecomposition ans;
+    for (int i = 0; i < 3; ++ i)
+    {
+        ans.values.data()[i] = norms[order[i]];
+        column[i] = Vector3D(w[order[i]]);
+        right[i] = Vector3D(v[order[i]]);
+    }
+    // the columns of singular values at the rounding level of the largest are noise, so u is
+    // completed by Gram Schmidt and a cross product rather than normalizing the columns
+    Vector3D u[3];
+    u[0] = ans.values[0] > DBL_MIN ? column[0] / ans.values[0] : Vector3D(1, 0, 0);
+    u[1] = column[1] - u[0] * (column[1] * u[0]);
+    double norm = u[1].norm();
+    u[1] = norm > DBL_MIN ? u[1] / norm : orthogonal(u[0]);
+    u[2] = cross(u[0], u[1]);
+    if (u[2] * column[2] < 0)
+    {
+        u[2] = - u[2];
+    }
+    if (cross(right[0], right[1]) * right[2] < 0)
+    {
+        // the last pair changes sign together, so u * diag(values) * transpose(v) is kept
+        right[2] = - right[2];
+        u[2] = - u[2];
+    }
+    ans.u = Matrix3D(u[0], u[1], u[2]).transpose();
+    ans.v = Matrix3D(right[0], right[1], right[2]).transpose();
+    return ans;
+}
+
+/**
+ * gathers the rows of SIMD_WIDTH matrices, a register per element.
+ * @param m the matrices, row major doubles
+ * @param rows rows[i][j] is element j of row i
+ */
+inline void gatherMatrices(const double *m, simd_t rows[3][3])
+{
+    for (int k = 0; k < 9; ++ k)
+    {
+        rows[k / 3][k % 3] = simd_gather(m + k, 9);
+    }
+}
+
+/**
+ * stores a 3x3 array of registers lane by lane.
+ * @param registers the registers
+ * @param lanes lanes[lane][i][j] is lane of registers[i][j]
+ */
+inline void storeLanes(const simd_t registers[3][3], double lanes[SIMD_WIDTH][3][3])
+{
+    alignas(SIMD_ALIGN) double values[SIMD_WIDTH];
+    for (int i = 0; i < 3; ++ i)
+    {
+        for (int j = 0; j < 3; ++ j)
+        {
+            simd_store(values, registers[i][j]);
+            for (size_t lane = 0; lane < SIMD_WIDTH; ++ lane)
+            {
+                lanes[lane][i][j] = values[lane];
+            }
+        }
+    }
+}
+}
+
+// ------------------ Eigen decomposition ------------------------
+
+/**
+* the eigen decomposition of a symmetric matrix.
+* @param m symmetric matrix, only the upper triangle is read
+* @return the decomposition
+*/
+EigenDecomposition eigen_symmetric(const Matrix3D &m)
+{
+    double a[3][3], v[3][3];
+    for (int i = 0; i < 3; ++ i)
+    {
+        for (int j = 0; j < 3; ++ j)
+        {
+            a[i][j] = m[i].data()[j];
+        }
+    }
+    eigenKernel(a, v);
+    const double values[3] = {a[0][0], a[1][1], a[2][2]};
+    return finishEigen(values, v);
+}
+
+/**
+* out[i] = eigen_symmetric(m[i])
+* @param m symmetric matrices
+* @param out the decompositions, same size as m
+*/
+void eigen_symmetric_batch(const Span<const Matrix3D> m, const Span<EigenDecomposition> out)
+{
+    INSTRUMENT_SCOPE("eigen_symmetric_batch");
+    if (m.size() != out.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return;
+    }
+    size_t first = 0;
+    for (; first + SIMD_WIDTH <= m.size(); first += SIMD_WIDTH)
+    {
+        simd_t a[3][3], v[3][3];
+        gatherMatrices(reinterpret_cast<const double *>(m.data() + first), a);
+        eigenKernel(a, v);
+        alignas(SIMD_ALIGN) double diagonal[3][SIMD_WIDTH];
+        for (int i = 0; i < 3; ++ i)
+        {
+            simd_store(diagonal[i], a[i][i]);
+        }
+        double vectors[SIMD_WIDTH][3][3];
+        storeLanes(v, vectors);
+        for (size_t lane = 0; lane < SIMD_WIDTH; ++ lane)
+        {
+            const double values[3] = {diagonal[0][lane], diagonal[1][lane], diagonal[2][lane]};
+            out[first + lane] = finishEigen(values, vectors[lane]);
+        }
+    }
+    for (; first < m.size(); ++ first)
+    {
+        out[first] = eigen_symmetric(m[first]);
+    }
+}
+
+// ------------------ Singular value decomposition ------------------------
+
+/**
+* the singular value decomposition of a matrix.
+* @param m the matrix
+* @return the decomposition
+*/
+SingularDecomposition svd(const Matrix3D &m)
+{
+    double w[3][3], v[3][3];
+    for (int i = 0; i < 3; ++ i)
+    {
+        for (int j = 0; j < 3; ++ j)
+        {
+            w[j][i] = m[i].data()[j];
+        }
+    }
+    svdKernel(w, v);
+    return finishSvd(w, v);
+}
+
+/**
+* out[i] = svd(m[i])
+* @param m the matrices
+* @param out the decompositions, same size as m
+*/
+void svd_batch(const Span<const Matrix3D> m, const Span<SingularDecomposition> out)
+{
+    INSTRUMENT_SCOPE("svd_batch");
+    if (m.size() != out.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return;
+    }
+    size_t first = 0;
+    for (; first + SIMD_WIDTH <= m.size(); first += SIMD_WIDTH)
+    {
+        simd_t rows[3][3], w[3][3], v[3][3];
+        gatherMatrices(reinterpret_cast<const double *>(m.data() + first), rows);
+        for (int i = 0; i < 3; ++ i)
+        {
+            for (int j = 0; j < 3; ++ j)
+            {
+                w[j][i] = rows[i][j];
+            }
+        }
+        svdKernel(w, v);
+        double columns[SIMD_WIDTH][3][3], vectors[SIMD_WIDTH][3][3];
+        storeLanes(w, columns);
+        storeLanes(v, vectors);
+        for (size_t lane = 0; lane < SIMD_WIDTH; ++ lane)
+        {
+            out[first + lane] = finishSvd(columns[lane], vectors[lane]);
+        }
+    }
+    for (; first < m.size(); ++ first)
+    {
+        out[first] = svd(m[first]);
+    }
+}
+
+// ------------------ Rotations ------------------------
+
+/**
+* the rotation closest to a matrix, the orthogonal factor of its polar decomposition.
+* @param m the matrix
+* @return the rotation
+*/
+Matrix3D nearest_rotation(const Matrix3D &m)
+{
+    SingularDecomposition d = svd(m);
+    if (d.u.determinant() < 0)
+    {
+        // a reflection: the direction of the smallest singular value is flipped
+        for (int i = 0; i < 3; ++ i)
+        {
+            d.u[i][2] = - d.u[i][2];
+        }
+    }
+    return d.u * d.v.transpose();
+}
+
+/**
+* the rotation that best maps a point set onto another (Kabsch).
+* @param from points to rotate
+* @param to their targets, same size as from
+* @return the rotation
+*/
+Matrix3D kabsch(const Span<const Vector3D> from, const Span<const Vector3D> to)
+{
+    INSTRUMENT_SCOPE("kabsch");
+    if (from.size() != to.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return Matrix3D(1.0);
+    }
+    Vector3D fromCenter, toCenter;
+    for (size_t i = 0; i < from.size(); ++ i)
+    {
+        fromCenter += from[i];
+        toCenter += to[i];
+    }
+    if (! from.empty())
+    {
+        fromCenter /= (double) from.size();
+        toCenter /= (double) to.size();
+    }
+    // the cross covariance, sum of (to - its center) * transpose(from - its center)
+    Matrix3D covariance;
+    for (size_t i = 0; i < from.size(); ++ i)
+    {
+        Vector3D a = from[i] - fromCenter, b = to[i] - toCenter;
+        for (int r = 0; r < 3; ++ r)
+        {
+            covariance[r] += a * b.data()[r];
+        }
+    }
+    return nearest_rotation(covariance);
+}
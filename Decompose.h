@@ -0,0 +1,90 @@
+// Created by liorP.
+//
+
+#ifndef EX1_DECOMPOSE_H
+#define EX1_DECOMPOSE_H
+
+#include "Matrix3D.h"
+#include "Span.h"
+
+// --------------------------------------------------------------------------------------
+// Eigen decomposition of symmetric Matrix3D and singular value decomposition of Matrix3D,
+// by Jacobi rotations: cyclic Jacobi on the symmetric matrix, one sided Jacobi on the
+// columns for the SVD. A fixed number of branch free sweeps (DECOMPOSE_SWEEPS) is run, so
+// the same code runs on a single matrix and on SIMD_WIDTH matrices at a time in the batch
+// variants. Jacobi converges quadratically, and keeps the small eigen / singular values
+// to full relative accuracy, where the closed form of the cubic loses them.
+// --------------------------------------------------------------------------------------
+
+/**
+ * number of Jacobi sweeps (3 rotations each) of a decomposition.
+ */
+#define DECOMPOSE_SWEEPS 5
+
+/**
+ * The eigen decomposition of a symmetric matrix: m = transpose(vectors) * diag(values) * vectors.
+ */
+struct EigenDecomposition
+{
+    Vector3D values; /**< the eigenvalues, ascending. */
+    Matrix3D vectors; /**< row i is the unit eigenvector of values[i], a right handed basis. */
+};
+
+/**
+ * The singular value decomposition of a matrix: m = u * diag(values) * transpose(v).
+ */
+struct SingularDecomposition
+{
+    Matrix3D u; /**< the left singular vectors, as columns. orthogonal. */
+    Vector3D values; /**< the singular values, descending and non negative. */
+    Matrix3D v; /**< the right singular vectors, as columns. a rotation (determinant 1). */
+};
+
+/**
+ * the eigen decomposition of a symmetric matrix, e.g. the covariance of a neighborhood:
+ * vectors[0] is its normal, vectors[2] its main direction.
+ * @param m symmetric matrix, only the upper triangle is read
+ * @return the decomposition
+ */
+EigenDecomposition eigen_symmetric(const Matrix3D &m);
+
+/**
+ * out[i] = eigen_symmetric(m[i])
+ * @param m symmetric matrices
+ * @param out the decompositions, same size as m
+ */
+void eigen_symmetric_batch(Span<const Matrix3D> m, Span<EigenDecomposition> out);
+
+/**
+ * the singular value decomposition of a matrix.
+ * @param m the matrix
+ * @return the decomposition
+ */
+SingularDecomposition svd(const Matrix3D &m);
+
+/**
+ * out[i] = svd(m[i])
+ * @param m the matrices
+ * @param out the decompositions, same size as m
+ */
+void svd_batch(Span<const Matrix3D> m, Span<SingularDecomposition> out);
+
+/**
+ * the rotation closest to a matrix (in the Frobenius norm), the orthogonal factor of its
+ * polar decomposition, with the sign of the smallest singular direction flipped if it
+ * would be a reflection.
+ * @param m the matrix
+ * @return the rotation
+ */
+Matrix3D nearest_rotation(const Matrix3D &m);
+
+/**
+ * the rotation that best maps a point set onto another (Kabsch): the R minimizing the sum
+ * of |R * (from[i] - center of from) - (to[i] - center of to)|^2.
+ * @param from points to rotate
+ * @param to their targets, same size as from
+ * @return the rotation
+ */
+Matrix3D kabsch(Span<const Vector3D> from, Span<const Vector3D> to);
+
+#endif //EX1_DECOMPOSE_H
@@ -0,0 +1,209 @@
+// Created by liorP.
+//
+
+#include <algorithm>
+#include <cfloat>
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "Decompose.h"
+
+/**
+ * number of matrices of the cache resident runs.
+ */
+#define CACHED (1 << 12)
+
+/**
+ * number of matrices of the memory bound runs.
+ */
+#define DECOMPOSITIONS (BENCH_ARRAY / 4)
+
+// --------------------------------------------------------------------------------------
+// Benchmarks of the Jacobi decompositions, one matrix at a time and batched, against the
+// closed form eigen solver of a symmetric 3x3 (the trigonometric roots of the characteristic
+// cubic, and the eigenvectors as cross products of the rows of m - value * I).
+// The matrices are covariances m * transpose(m) of random m, and flat ones whose last row
+// of m is scaled by 1e-6, like the neighborhood of a point on a plane. The largest residual
+// |m * v - value * v| / |m| of every solver is recorded with it (max_error).
+// --------------------------------------------------------------------------------------
+
+/**
+ * @param count number of matrices
+ * @param flat whether the smallest eigenvalue is ~1e-12 of the largest
+ * @return symmetric positive semi definite matrices
+ */
+static vector<Matrix3D> covariances(size_t count, bool flat)
+{
+    vector<Matrix3D> matrices = bench_matrices(count);
+    for (Matrix3D &m : matrices)
+    {
+        if (flat)
+        {
+            m[2] *= 1e-6;
+        }
+        m = m.transpose() * m;
+    }
+    return matrices;
+}
+
+/**
+ * @param m a matrix
+ * @return its Frobenius norm
+ */
+static double frobenius(const Matrix3D &m)
+{
+    return std::sqrt(m[0].norm_squared() + m[1].norm_squared() + m[2].norm_squared());
+}
+
+/**
+ * the closed form eigen decomposition of a symmetric matrix.
+ * @param m symmetric matrix
+ * @return the decomposition
+ */
+static EigenDecomposition closedForm(const Matrix3D &m)
+{
+    // the roots of the characteristic cubic of (m - q * I) / p, see Smith 1961
+    double q = m.trace() / 3;
+    double off = m[0][1] * m[0][1] + m[0][2] * m[0][2] + m[1][2] * m[1][2];
+    double p = std::sqrt(((m[0][0] - q) * (m[0][0] - q) + (m[1][1] - q) * (m[1][1] - q) +
+                          (m[2][2] - q) * (m[2][2] - q) + 2 * off) / 6);
+    EigenDecomposition ans;
+    if (p <= DBL_MIN)
+    {
+        ans.values = Vector3D(q, q, q);
+        ans.vectors = Matrix3D(1.0);
+        return ans;
+    }
+    Matrix3D b = m - Matrix3D(q);
+    b /= p;
+    double angle = acos(max(-1.0, min(1.0, b.determinant() / 2))) / 3;
+    ans.values = Vector3D(q + 2 * p * cos(angle + 2 * M_PI / 3), q + 2 * p * cos(angle - 2 * M_PI / 3),
+                          q + 2 * p * cos(angle));
+    for (int i = 0; i < 3; ++ i)
+    {
+        // the largest cross product of two rows of m - value * I is the eigenvector
+        Matrix3D shifted = m - Matrix3D(ans.values[i]);
+        Vector3D candidates[3] = {cross(shifted[0], shifted[1]), cross(shifted[0], shifted[2]),
+                                  cross(shifted[1], shifted[2])};
+        Vector3D *best = max_element(candidates, candidates + 3, [](const Vector3D &a, const Vector3D &b) {
+            return a.norm_squared() < b.norm_squared();
+        });
+        ans.vectors[i] = *best / best->norm();
+    }
+    return ans;
+}
+
+/**
+ * @param m symmetric matrices
+ * @param d their decompositions
+ * @return the largest |m * v - value * v| / |m| over the eigenpairs
+ */
+static double maxResidual(const vector<Matrix3D> &m, const vector<EigenDecomposition> &d)
+{
+    double error = 0;
+    for (size_t i = 0; i < m.size(); ++ i)
+    {
+        for (int j = 0; j < 3; ++ j)
+        {
+            const Vector3D &v = d[i].vectors[j];
+            error = max(error, (m[i] * v - v * d[i].values[j]).norm() / frobenius(m[i]));
+        }
+    }
+    return error;
+}
+
+/**
+ * @param m matrices
+ * @param d their singular value decompositions
+ * @return the largest |m - u * diag(values) * transpose(v)| / |m|
+ */
+static double maxReconstruction(const vector<Matrix3D> &m, const vector<SingularDecomposition> &d)
+{
+    double error = 0;
+    for (size_t i = 0; i < m.size(); ++ i)
+    {
+        Matrix3D s;
+        for (int j = 0; j < 3; ++ j)
+        {
+            s[j][j] = d[i].values[j];
+        }
+        error = max(error, frobenius(m[i] - d[i].u * s * d[i].v.transpose()) / frobenius(m[i]));
+    }
+    return error;
+}
+
+/**
+ * benchmarks the symmetric eigen solvers over random and flat covariances.
+ * @param bench to measure with
+ */
+static void eigenSolvers(Bench &bench)
+{
+    for (size_t count : {(size_t) CACHED, (size_t) DECOMPOSITIONS})
+    {
+        vector<EigenDecomposition> out(count);
+        for (bool flat : {false, true})
+        {
+            const string kind = (flat ? " flat/" : "/") + to_string(count);
+            const vector<Matrix3D> m = covariances(count, flat);
+            auto closed = [&]() {
+                for (size_t i = 0; i < count; ++ i)
+                {
+                    out[i] = closedForm(m[i]);
+                }
+            };
+            closed();
+            bench.measure("loop closed form eigen" + kind, count, [&]() {
+                closed();
+                keep(out);
+            }).max_error = maxResidual(m, out);
+            auto jacobi = [&]() {
+                for (size_t i = 0; i < count; ++ i)
+                {
+                    out[i] = eigen_symmetric(m[i]);
+                }
+            };
+            jacobi();
+            bench.measure("loop eigen_symmetric" + kind, count, [&]() {
+                jacobi();
+                keep(out);
+            }).max_error = maxResidual(m, out);
+            eigen_symmetric_batch(m, out);
+            bench.measure("eigen_symmetric_batch" + kind, count, [&]() {
+                eigen_symmetric_batch(m, out);
+                keep(out);
+            }).max_error = maxResidual(m, out);
+        }
+    }
+}
+
+/**
+ * benchmarks the singular value decompositions of random matrices.
+ * @param bench to measure with
+ */
+static void singularValues(Bench &bench)
+{
+    for (size_t count : {(size_t) CACHED, (size_t) DECOMPOSITIONS})
+    {
+        const string kind = "/" + to_string(count);
+        const vector<Matrix3D> m = bench_matrices(count);
+        vector<SingularDecomposition> out(count);
+        auto loop = [&]() {
+            for (size_t i = 0; i < count; ++ i)
+            {
+                out[i] = svd(m[i]);
+            }
+        };
+        loop();
+        bench.measure("loop svd" + kind, count, [&]() {
+            loop();
+            keep(out);
+        }).max_error = maxReconstruction(m, out);
+        svd_batch(m, out);
+        bench.measure("svd_batch" + kind, count, [&]() {
+            svd_batch(m, out);
+            keep(out);
+        }).max_error = maxReconstruction(m, out);
+    }
+}
+
+BENCHMARK(eigenSolvers);
+BENCHMARK(singularValues);
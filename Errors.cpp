@@ -0,0 +1,65 @@
+// Created by liorP.
+//
+
+#include <iostream>
+#include <stdexcept>
+#include "Errors.h"
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the error reports, out of line so that the
+// operations that report them inline without any stream or exception code.
+// --------------------------------------------------------------------------------------
+
+namespace
+{
+    /**
+     * the errors reported on this thread, with ERRORS_STATUS.
+     */
+    thread_local unsigned status = 0;
+
+    /**
+     * @param code an error
+     * @return its message
+     */
+    constexpr const char *message(const ErrorCode code)
+    {
+        return code == ERROR_SINGULAR ? SINGULAR_ERR : ZERO_ERR;
+    }
+}
+
+/**
+* reports an error according to ERROR_POLICY.
+* @param code the error
+*/
+void report_error(const ErrorCode code)
+{
+#if ERROR_POLICY == ERRORS_PRINT
+    cerr << message(code) << endl;
+#elif ERROR_POLICY == ERRORS_THROW
+    throw domain_error(message(code));
+#elif ERROR_POLICY == ERRORS_STATUS
+    status |= code;
+#else
+    // ERRORS_ASSERT, ERRORS_SILENT does not report at all
+    assert(code != ERROR_ZERO && ZERO_ERR);
+    assert(code != ERROR_SINGULAR && SINGULAR_ERR);
+    (void) code;
+#endif
+}
+
+/**
+* @return the errors reported on this thread since the last clear_error_status(), ored
+* together. only ERRORS_STATUS records them, it is 0 with the other policies
+*/
+unsigned error_status()
+{
+    return status;
+}
+
+/**
+* forgets the errors reported on this thread.
+*/
+void clear_error_status()
+{
+    status = 0;
+}
@@ -0,0 +1,108 @@
+// Created by liorP.
+//
+
+#ifndef EX1_ERRORS_H
+#define EX1_ERRORS_H
+
+#include <cassert>
+
+using namespace std;
+
+#define ZERO_ERR "Division in Zero"
+#define SINGULAR_ERR "Singular matrix"
+
+// --------------------------------------------------------------------------------------
+// The handling of the arithmetic errors, a division by zero (ZERO_ERR) and the inverse of a
+// singular matrix (SINGULAR_ERR), selected at compile time by defining ERROR_POLICY (the
+// Makefile passes ERRORS_$(ERRORS)):
+//   ERRORS_PRINT   prints the error to cerr and goes on (the default)
+//   ERRORS_THROW   throws domain_error with the message
+//   ERRORS_ASSERT  assert(), so the check is gone when NDEBUG is defined
+//   ERRORS_STATUS  records the error in a per thread status, read with error_status()
+//   ERRORS_SILENT  no checks at all: a division gives the IEEE result (inf or NaN), and the
+//                  inverse of a singular matrix is the adjugate divided by the determinant
+// Where the operation goes on after an error, the result is the one it always was: the
+// division by zero multiplies by 1 / 0, /= leaves its operand as is and the inverse of a
+// singular matrix is the zero matrix. The report is a call of the out of line, cold
+// report_error(), so the inlined operations keep a single compare and a never taken branch,
+// and no stream code. The index checks of the [] operators have their own setting, in
+// Bounds.h. Every translation unit of a program must be built with the same setting.
+// --------------------------------------------------------------------------------------
+
+#define ERRORS_PRINT 0
+#define ERRORS_THROW 1
+#define ERRORS_ASSERT 2
+#define ERRORS_STATUS 3
+#define ERRORS_SILENT 4
+
+#ifndef ERROR_POLICY
+#define ERROR_POLICY ERRORS_PRINT
+#endif
+
+#if ERROR_POLICY == ERRORS_PRINT
+#define ERRORS_NAME "print"
+#elif ERROR_POLICY == ERRORS_THROW
+#define ERRORS_NAME "throw"
+#elif ERROR_POLICY == ERRORS_ASSERT
+#define ERRORS_NAME "assert"
+#elif ERROR_POLICY == ERRORS_STATUS
+#define ERRORS_NAME "status"
+#elif ERROR_POLICY == ERRORS_SILENT
+#define ERRORS_NAME "silent"
+#else
+#error "ERROR_POLICY must be ERRORS_PRINT, ERRORS_THROW, ERRORS_ASSERT, ERRORS_STATUS or ERRORS_SILENT"
+#endif
+
+/**
+ * true if the operations check for their errors: all the policies but ERRORS_SILENT, and
+ * ERRORS_ASSERT when the asserts are compiled.
+ */
+#if ERROR_POLICY == ERRORS_SILENT || (ERROR_POLICY == ERRORS_ASSERT && defined(NDEBUG))
+#define ERRORS_CHECKED false
+#else
+#define ERRORS_CHECKED true
+#endif
+
+/**
+ * the arithmetic errors, bits of error_status().
+ */
+enum ErrorCode : unsigned
+{
+    ERROR_ZERO = 1, /**< a division by zero. */
+    ERROR_SINGULAR = 2 /**< the inverse of a singular matrix. */
+};
+
+/**
+ * reports an error according to ERROR_POLICY.
+ * @param code the error
+ */
+#if defined(__GNUC__)
+__attribute__((cold, noinline))
+#endif
+void report_error(ErrorCode code);
+
+/**
+ * @return the errors reported on this thread since the last clear_error_status(), ored
+ * together. only ERRORS_STATUS records them, it is 0 with the other policies
+ */
+unsigned error_status();
+
+/**
+ * forgets the errors reported on this thread.
+ */
+void clear_error_status();
+
+/**
+ * @param failed true if the operation failed
+ * @return failed, if checked (see ERRORS_CHECKED), and false otherwise
+ */
+constexpr bool error_if(const bool failed)
+{
+#if defined(__GNUC__)
+    return ERRORS_CHECKED && __builtin_expect(failed, 0);
+#else
+    return ERRORS_CHECKED && failed;
+#endif
+}
+
+#endif //EX1_ERRORS_H
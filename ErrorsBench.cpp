@@ -0,0 +1,113 @@
+// Created by liorP.
+//
+
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "Matrix3D.h"
+
+/**
+ * number of matrices of the inverse benchmarks.
+ */
+#define ERRORS_MATRICES (1 << 16)
+
+// --------------------------------------------------------------------------------------
+// Benchmarks of the checked divisions against the implementation they replaced, which wrote
+// the error to cerr inline, and against no check at all, and of the inverse, with the
+// ERROR_POLICY of the build (part of the names, build with ERRORS=SILENT to compare). The
+// divisors are never zero and the matrices never singular, so the error path is never taken:
+// this is the cost of the checks alone.
+// --------------------------------------------------------------------------------------
+
+/**
+ * the old Vector3D::operator/
+ * @param vector to divide
+ * @param scalar to divide by
+ * @return vector / scalar
+ */
+static Vector3D legacyDivide(const Vector3D &vector, const double scalar)
+{
+    if (scalar == 0)
+    {
+        cerr << ZERO_ERR << endl;
+    }
+    return vector * (1 / scalar);
+}
+
+/**
+ * the old Matrix3D::operator/=
+ * @param matrix to divide
+ * @param scalar to divide by
+ */
+static void legacyDivideAssign(Matrix3D &matrix, const double scalar)
+{
+    if (scalar == 0)
+    {
+        cerr << ZERO_ERR << endl;
+        return;
+    }
+    matrix *= 1 / scalar;
+}
+
+/**
+ * benchmarks the divisions, checked the old way, the new way and not at all, and the inverse.
+ * @param bench to measure with
+ */
+static void errorChecks(Bench &bench)
+{
+    const string policy = string(" (") + ERRORS_NAME + ")";
+    const vector<Vector3D> points = bench_points(BENCH_ARRAY);
+    vector<double> scalars(BENCH_ARRAY);
+    for (size_t i = 0; i < scalars.size(); ++ i)
+    {
+        scalars[i] = 1 + abs(points[i][0]);
+    }
+    vector<Vector3D> out(BENCH_ARRAY);
+    bench.measure("legacy Vector3D / scalar", BENCH_ARRAY, [&]() {
+        for (size_t i = 0; i < points.size(); ++ i)
+        {
+            out[i] = legacyDivide(points[i], scalars[i]);
+        }
+        keep(out);
+    });
+    bench.measure("Vector3D / scalar" + policy, BENCH_ARRAY, [&]() {
+        for (size_t i = 0; i < points.size(); ++ i)
+        {
+            out[i] = points[i] / scalars[i];
+        }
+        keep(out);
+    });
+    bench.measure("Vector3D * (1 / scalar), unchecked", BENCH_ARRAY, [&]() {
+        for (size_t i = 0; i < points.size(); ++ i)
+        {
+            out[i] = points[i] * (1 / scalars[i]);
+        }
+        keep(out);
+    });
+    vector<Matrix3D> matrices = bench_matrices(ERRORS_MATRICES);
+    bench.measure("legacy Matrix3D /= scalar", ERRORS_MATRICES, [&]() {
+        for (size_t i = 0; i < matrices.size(); ++ i)
+        {
+            legacyDivideAssign(matrices[i], scalars[i]);
+            matrices[i] *= scalars[i];
+        }
+        keep(matrices);
+    });
+    bench.measure("Matrix3D /= scalar" + policy, ERRORS_MATRICES, [&]() {
+        for (size_t i = 0; i < matrices.size(); ++ i)
+        {
+            matrices[i] /= scalars[i];
+            matrices[i] *= scalars[i];
+        }
+        keep(matrices);
+    });
+    vector<Matrix3D> inverses(ERRORS_MATRICES);
+    bench.measure("Matrix3D::inverse" + policy, ERRORS_MATRICES, [&]() {
+        for (size_t i = 0; i < matrices.size(); ++ i)
+        {
+            inverses[i] = matrices[i].inverse();
+        }
+        keep(inverses);
+    });
+}
+
+BENCHMARK(errorChecks);
@@ -0,0 +1,69 @@
+// Created by liorP.
+//
+
+#include "ArrayExpr.h"
+#include "BenchData.h"
+#include "Benchmark.h"
+
+/**
+ * number of points of the cache resident runs.
+ */
+#define CACHED (1 << 14)
+
+// --------------------------------------------------------------------------------------
+// Benchmarks of the lazy array expressions against the eager batch kernels they replace.
+// The number of intermediate arrays every variant needs is part of its name.
+// --------------------------------------------------------------------------------------
+
+/**
+ * benchmarks out = a + b * 2 - c, and out = m * (a - b).
+ * @param bench to measure with
+ */
+static void fusedExpressions(Bench &bench)
+{
+    const Matrix3D m = bench_matrices(1)[0];
+    for (size_t count : {(size_t) CACHED, (size_t) BENCH_ARRAY})
+    {
+        const string size = "/" + to_string(count);
+        vector<Vector3D> points = bench_points(count), others = bench_points(count, 2),
+                others2 = bench_points(count, 3), out(count);
+        Vector3DArray a(points), b(others), c(others2), result(count), t1(count), t2(count), t3(count);
+        bench.measure("loop a + b * 2 - c" + size, count, [&]() {
+            for (size_t i = 0; i < count; ++ i)
+            {
+                out[i] = points[i] + others[i] * 2.0 - others2[i];
+            }
+            keep(out);
+        });
+        bench.measure("batch a + b * 2 - c (3 temporaries)" + size, count, [&]() {
+            batch_scale(b, 2.0, t1);
+            batch_add(a, t1, t2);
+            batch_scale(c, - 1.0, t3);
+            batch_add(t2, t3, result);
+            keep(result);
+        });
+        bench.measure("expr a + b * 2 - c (0 temporaries)" + size, count, [&]() {
+            result = a + b * 2.0 - c;
+            keep(result);
+        });
+        bench.measure("loop m * (a - b)" + size, count, [&]() {
+            for (size_t i = 0; i < count; ++ i)
+            {
+                out[i] = m * (points[i] - others[i]);
+            }
+            keep(out);
+        });
+        bench.measure("batch m * (a - b) (2 temporaries)" + size, count, [&]() {
+            batch_scale(b, - 1.0, t1);
+            batch_add(a, t1, t2);
+            batch_multiply(m, t2, result);
+            keep(result);
+        });
+        bench.measure("expr m * (a - b) (0 temporaries)" + size, count, [&]() {
+            result = m * (a - b);
+            keep(result);
+        });
+    }
+}
+
+BENCHMARK(fusedExpressions);
@@ -0,0 +1,148 @@
+// Created by liorP.
+//
+
+#include <sstream>
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "BulkIO.h"
+
+/**
+ * number of points of the I/O benchmarks.
+ */
+#define IO_POINTS (BENCH_ARRAY / 4)
+
+// --------------------------------------------------------------------------------------
+// Benchmarks of the bulk readers and writers against the << and >> operators.
+// Everything goes through string streams, so the numbers are parsing and formatting costs
+// without the disk.
+// --------------------------------------------------------------------------------------
+
+/**
+ * benchmarks writing and reading a point set as text and as binary.
+ * @param bench to measure with
+ */
+static void pointIO(Bench &bench)
+{
+    vector<Vector3D> points = bench_points(IO_POINTS), read;
+    Vector3DArray array(points), readArray;
+    bench.measure("operator<<(ostream, Vector3D)", IO_POINTS, [&]() {
+        ostringstream os;
+        for (const Vector3D &point : points)
+        {
+            os << point << '\n';
+        }
+        keep(os);
+    });
+    bench.measure("write_text(Vector3D)", IO_POINTS, [&]() {
+        ostringstream os;
+        write_text(os, points);
+        keep(os);
+    });
+    bench.measure("write_text(Vector3DArray)", IO_POINTS, [&]() {
+        ostringstream os;
+        write_text(os, array);
+        keep(os);
+    });
+    ostringstream text;
+    write_text(text, points);
+    const string input = text.str();
+    bench.measure("operator>>(istream, Vector3D)", IO_POINTS, [&]() {
+        istringstream is(input);
+        read.resize(IO_POINTS);
+        for (Vector3D &point : read)
+        {
+            is >> point;
+        }
+        keep(read);
+    });
+    bench.measure("read_text(Vector3D)", IO_POINTS, [&]() {
+        istringstream is(input);
+        read_text(is, read);
+        keep(read);
+    });
+    bench.measure("read_text(Vector3DArray)", IO_POINTS, [&]() {
+        istringstream is(input);
+        read_text(is, readArray);
+        keep(readArray);
+    });
+    bench.measure("write_binary(Vector3D)", IO_POINTS, [&]() {
+        ostringstream os;
+        write_binary(os, points);
+        keep(os);
+    });
+    bench.measure("write_binary(Vector3DArray)", IO_POINTS, [&]() {
+        ostringstream os;
+        write_binary(os, array);
+        keep(os);
+    });
+    ostringstream binary;
+    write_binary(binary, points);
+    const string binaryInput = binary.str();
+    bench.measure("read_binary(Vector3D)", IO_POINTS, [&]() {
+        istringstream is(binaryInput);
+        read_binary(is, read);
+        keep(read);
+    });
+    bench.measure("read_binary(Vector3DArray)", IO_POINTS, [&]() {
+        istringstream is(binaryInput);
+        read_binary(is, readArray);
+        keep(readArray);
+    });
+}
+
+BENCHMARK(pointIO);
+
+/**
+ * benchmarks writing and reading a matrix set as text and as binary.
+ * @param bench to measure with
+ */
+static void matrixIO(Bench &bench)
+{
+    const size_t count = IO_POINTS / 4;
+    vector<Matrix3D> matrices = bench_matrices(count), read;
+    bench.measure("operator<<(ostream, Matrix3D)", count, [&]() {
+        ostringstream os;
+        for (const Matrix3D &matrix : matrices)
+        {
+            os << matrix << '\n';
+        }
+        keep(os);
+    });
+    bench.measure("write_text(Matrix3D)", count, [&]() {
+        ostringstream os;
+        write_text(os, matrices);
+        keep(os);
+    });
+    ostringstream text;
+    write_text(text, matrices);
+    const string input = text.str();
+    bench.measure("operator>>(istream, Matrix3D)", count, [&]() {
+        istringstream is(input);
+        read.resize(count);
+        for (Matrix3D &matrix : read)
+        {
+            is >> matrix;
+        }
+        keep(read);
+    });
+    bench.measure("read_text(Matrix3D)", count, [&]() {
+        istringstream is(input);
+        read_text(is, read);
+        keep(read);
+    });
+    bench.measure("write_binary(Matrix3D)", count, [&]() {
+        ostringstream os;
+        write_binary(os, matrices);
+        keep(os);
+    });
+    ostringstream binary;
+    write_binary(binary, matrices);
+    const string binaryInput = binary.str();
+    bench.measure("read_binary(Matrix3D)", count, [&]() {
+        istringstream is(binaryInput);
+        read_binary(is, read);
+        keep(read);
+    });
+}
+
+BENCHMARK(matrixIO);
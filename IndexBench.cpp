@@ -0,0 +1,115 @@
+// Created by liorP.
+//
+
+#include "BenchData.h"
+#include "Benchmark.h"
+
+// --------------------------------------------------------------------------------------
+// Benchmarks of loops that index the components generically, with a runtime index, through
+// the checked [] operators and through data(). The bounds check the suite was built with
+// (BOUNDS in the Makefile) is part of the names, so runs of the builds can be compared.
+// --------------------------------------------------------------------------------------
+
+/**
+ * the suffix of the names of this file.
+ */
+#define BOUNDS_LABEL " (bounds: " BOUNDS_NAME ")"
+
+/**
+ * sums all the coordinates of all the vectors, through operator[].
+ * @param vectors to sum
+ * @return the sum
+ */
+template<typename V>
+static typename V::value_type indexedSum(const vector<V> &vectors)
+{
+    typename V::value_type sum = 0;
+    for (const V &v : vectors)
+    {
+        for (int j = 0; j < (int) V::dimension; ++ j)
+        {
+            sum += v[j];
+        }
+    }
+    return sum;
+}
+
+/**
+ * sums all the coordinates of all the vectors, through data().
+ * @param vectors to sum
+ * @return the sum
+ */
+template<typename V>
+static typename V::value_type rawSum(const vector<V> &vectors)
+{
+    typename V::value_type sum = 0;
+    for (const V &v : vectors)
+    {
+        const typename V::value_type *data = v.data();
+        for (size_t j = 0; j < V::dimension; ++ j)
+        {
+            sum += data[j];
+        }
+    }
+    return sum;
+}
+
+/**
+ * benchmarks summing the components of vectors and applying matrices element by element.
+ * @param bench to measure with
+ */
+static void genericIndexing(Bench &bench)
+{
+    vector<Vector3D> points = bench_points(BENCH_ARRAY), out(BENCH_ARRAY);
+    vector<Matrix3D> matrices = bench_matrices(BENCH_ARRAY / 8);
+    bench.measure("sum v[j]" BOUNDS_LABEL, BENCH_ARRAY, [&]() { keep(indexedSum(points)); });
+    bench.measure("sum v.data()[j]", BENCH_ARRAY, [&]() { keep(rawSum(points)); });
+    bench.measure("scale v[j] *= s" BOUNDS_LABEL, BENCH_ARRAY, [&]() {
+        for (Vector3D &v : points)
+        {
+            for (int j = 0; j < 3; ++ j)
+            {
+                v[j] *= - 1.0;
+            }
+        }
+        keep(points);
+    });
+    const Matrix3D m = matrices[0];
+    bench.measure("m[r][c] * v[c]" BOUNDS_LABEL, BENCH_ARRAY, [&]() {
+        for (size_t i = 0; i < BENCH_ARRAY; ++ i)
+        {
+            for (int r = 0; r < 3; ++ r)
+            {
+                double sum = 0;
+                for (int c = 0; c < 3; ++ c)
+                {
+                    sum += m[r][c] * points[i][c];
+                }
+                out[i][r] = sum;
+            }
+        }
+        keep(out);
+    });
+    vector<double> scalars(matrices.size());
+    bench.measure("trace m[j][j]" BOUNDS_LABEL, matrices.size(), [&]() {
+        for (size_t i = 0; i < matrices.size(); ++ i)
+        {
+            double sum = 0;
+            for (int j = 0; j < 3; ++ j)
+            {
+                sum += matrices[i][j][j];
+            }
+            scalars[i] = sum;
+        }
+        keep(scalars);
+    });
+    bench.measure("m.column(j)" BOUNDS_LABEL, matrices.size(), [&]() {
+        for (size_t i = 0; i < matrices.size(); ++ i)
+        {
+            out[i] = matrices[i].column((short) (i % 3));
+        }
+        keep(out);
+    });
+}
+
+BENCHMARK(genericIndexing);
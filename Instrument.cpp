@@ -0,0 +1,217 @@
+// Created by liorP.
+//
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <string>
+#include <vector>
+#include "Instrument.h"
+
+#define JSON_VARIABLE "INSTRUMENT_JSON"
+#define WRITE_ERROR "Can't write the instrumentation report to "
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the site registry and the reports. The sites
+// are kept in a lock free list, which is trivially destructible like the sites themselves,
+// so the report at exit sees all of them whatever the order of the static destructors.
+// --------------------------------------------------------------------------------------
+
+namespace
+{
+    /**
+     * the most recently registered site, the head of the list.
+     */
+    atomic<InstrumentSite *> head{nullptr};
+
+    /**
+     * The counters of the sites of a name.
+     */
+    struct Total
+    {
+        string name; /**< name of the sites. */
+        uint64_t calls; /**< calls of all of them. */
+        uint64_t nanoseconds; /**< time of all of them. */
+    };
+
+    /**
+     * @return the totals of the sites with calls, by decreasing time and then calls
+     */
+    vector<Total> totals()
+    {
+        map<string, Total> byName;
+        for (const InstrumentSite *site = instrument_sites(); site != nullptr; site = site->next())
+        {
+            if (site->calls() > 0)
+            {
+                Total &total = byName.emplace(site->name(), Total{site->name(), 0, 0}).first->second;
+                total.calls += site->calls();
+                total.nanoseconds += site->nanoseconds();
+            }
+        }
+        vector<Total> ans;
+        for (const auto &entry : byName)
+        {
+            ans.push_back(entry.second);
+        }
+        stable_sort(ans.begin(), ans.end(), [](const Total &a, const Total &b) {
+            return a.nanoseconds != b.nanoseconds ? a.nanoseconds > b.nanoseconds : a.calls > b.calls;
+        });
+        return ans;
+    }
+
+    /**
+     * escapes a string for a JSON document.
+     * @param text string to escape
+     * @return the quoted string
+     */
+    string quoted(const string &text)
+    {
+        string ans = "\"";
+        for (char c : text)
+        {
+            if (c == '"' || c == '\\')
+            {
+                ans += '\\';
+            }
+            ans += c;
+        }
+        return ans + "\"";
+    }
+
+    /**
+     * An AtExit class.
+     * This class writes the reports when the static objects are destroyed, if instrumented.
+     */
+    class AtExit
+    {
+    public:
+        /**
+         * A destructor - writes the reports.
+         */
+        ~AtExit()
+        {
+#if INSTRUMENT_MODE != INSTRUMENT_NONE
+            instrument_report(cerr);
+            const char *file = getenv(JSON_VARIABLE);
+            if (file != nullptr && *file != '\0')
+            {
+                ofstream os(file);
+                instrument_json(os);
+                if (! os)
+                {
+                    cerr << WRITE_ERROR << file << endl;
+                }
+            }
+#endif
+        }
+
+    };
+
+    /**
+     * writes the reports at exit.
+     */
+    const AtExit atExit;
+}
+
+/**
+* A constructor - registers the site.
+* @param name of the operation, sites of the same name are reported together
+*/
+InstrumentSite::InstrumentSite(const char *name) : _name(name), _calls(0), _nanoseconds(0),
+                                                   _next(head.load(memory_order_relaxed))
+{
+#if INSTRUMENT_MODE == INSTRUMENT_ITT
+    _handle = __itt_string_handle_create(name);
+#endif
+    while (! head.compare_exchange_weak(_next, this, memory_order_release, memory_order_relaxed))
+    {
+    }
+}
+
+#if INSTRUMENT_MODE == INSTRUMENT_ITT
+/**
+* @return the ITT domain of all the sites
+*/
+__itt_domain *instrument_domain()
+{
+    static __itt_domain *const domain = __itt_domain_create("ex1");
+    return domain;
+}
+#endif
+
+/**
+* @return the first registered site, the others follow by next(), nullptr if none
+*/
+const InstrumentSite *instrument_sites()
+{
+    return head.load(memory_order_acquire);
+}
+
+/**
+* zeroes the counters of all the sites.
+*/
+void instrument_reset()
+{
+    for (const InstrumentSite *site = instrument_sites(); site != nullptr; site = site->next())
+    {
+        const_cast<InstrumentSite *>(site)->reset();
+    }
+}
+
+/**
+* writes the counters of all the sites, of the same name added up, by decreasing time and
+* then calls: name, calls, total and mean time. the sites without calls are left out.
+* @param os to write to
+*/
+void instrument_report(ostream &os)
+{
+    const vector<Total> rows = totals();
+    if (rows.empty())
+    {
+        return;
+    }
+    const ios::fmtflags flags = os.flags();
+    const streamsize precision = os.precision();
+    os << "instrumentation (" << INSTRUMENT_NAME << ")" << endl;
+    os << left << setw(36) << "site" << right << setw(14) << "calls" << setw(14) << "total ms" << setw(14)
+       << "ns/call" << endl;
+    for (const Total &row : rows)
+    {
+        os << left << setw(36) << row.name << right << setw(14) << row.calls << fixed;
+        // the counted only sites have no time
+        if (row.nanoseconds > 0)
+        {
+            os << setprecision(3) << setw(14) << (double) row.nanoseconds / 1e6 << setprecision(1) << setw(14)
+               << (double) row.nanoseconds / (double) row.calls << endl;
+        }
+        else
+        {
+            os << setw(14) << "-" << setw(14) << "-" << endl;
+        }
+    }
+    os.flags(flags);
+    os.precision(precision);
+}
+
+/**
+* writes the counters as instrument_report, as a JSON document of the mode and an array of
+* the sites, objects with the keys "name", "calls" and "nanoseconds".
+* @param os to write to
+*/
+void instrument_json(ostream &os)
+{
+    const vector<Total> rows = totals();
+    os << "{" << endl;
+    os << "  \"mode\": " << quoted(INSTRUMENT_NAME) << "," << endl;
+    os << "  \"sites\": [" << endl;
+    for (size_t i = 0; i < rows.size(); ++ i)
+    {
+        os << "    {\"name\": " << quoted(rows[i].name) << ", \"calls\": " << rows[i].calls
+           << ", \"nanoseconds\": " << rows[i].nanoseconds << "}" << (i + 1 < rows.size() ? "," : "") << endl;
+    }
+    os << "  ]" << endl;
+    os << "}" << endl;
+}
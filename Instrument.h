@@ -0,0 +1,245 @@
+// Created by liorP.
+//
+
+#ifndef EX1_INSTRUMENT_H
+#define EX1_INSTRUMENT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+using namespace std;
+
+// --------------------------------------------------------------------------------------
+// Call counters and timers of the hot operations, selected at compile time by defining
+// INSTRUMENT_MODE (the Makefile passes INSTRUMENT_$(INSTRUMENT)):
+//   INSTRUMENT_NONE   the macros expand to nothing, no cost at all (the default)
+//   INSTRUMENT_COUNT  every site counts its calls, the timed sites their total time too,
+//                     and the totals are reported at exit
+//   INSTRUMENT_ITT    as COUNT, and every timed call is an ITT task named after its site,
+//                     for VTune (needs ittnotify.h, link with -littnotify)
+//   INSTRUMENT_SDT    as COUNT, and every timed call fires the USDT probes ex1:begin and
+//                     ex1:end with the name of its site, for perf probe and bpftrace (needs
+//                     sys/sdt.h)
+// The report goes to cerr at exit, and as JSON to the file named by the environment
+// variable INSTRUMENT_JSON if it is set. INSTRUMENT_SCOPE times the rest of the enclosing
+// block: the batch kernels and the I/O operators. The small operations (Matrix::operator*,
+// determinant, Vector::norm) are counted with INSTRUMENT_CALL only, as two clock reads take
+// longer than the operation and a timer cannot live in a C++17 constexpr function; their
+// time is part of the timed kernels that call them. The counters are
+// relaxed atomics, so a site is shared by all the threads. Every translation unit of a
+// program must be built with the same setting.
+// --------------------------------------------------------------------------------------
+
+#define INSTRUMENT_NONE 0
+#define INSTRUMENT_COUNT 1
+#define INSTRUMENT_ITT 2
+#define INSTRUMENT_SDT 3
+
+#ifndef INSTRUMENT_MODE
+#define INSTRUMENT_MODE INSTRUMENT_NONE
+#endif
+
+#if INSTRUMENT_MODE == INSTRUMENT_NONE
+#define INSTRUMENT_NAME "none"
+#elif INSTRUMENT_MODE == INSTRUMENT_COUNT
+#define INSTRUMENT_NAME "count"
+#elif INSTRUMENT_MODE == INSTRUMENT_ITT
+#define INSTRUMENT_NAME "itt"
+#include <ittnotify.h>
+#elif INSTRUMENT_MODE == INSTRUMENT_SDT
+#define INSTRUMENT_NAME "sdt"
+#include <sys/sdt.h>
+#else
+#error "INSTRUMENT_MODE must be INSTRUMENT_NONE, INSTRUMENT_COUNT, INSTRUMENT_ITT or INSTRUMENT_SDT"
+#endif
+
+/**
+ * An InstrumentSite class.
+ * This class represents the counters of an instrumented operation. The sites register
+ * themselves on construction and are never destroyed, so they are static objects.
+ */
+class InstrumentSite
+{
+public:
+    /**
+     * A constructor - registers the site.
+     * @param name of the operation, sites of the same name are reported together
+     */
+    explicit InstrumentSite(const char *name);
+
+    /**
+     * @return name of the operation
+     */
+    const char *name() const { return _name; }
+
+    /**
+     * @return number of calls so far
+     */
+    uint64_t calls() const { return _calls.load(memory_order_relaxed); }
+
+    /**
+     * @return total time of the timed calls so far, in nanoseconds
+     */
+    uint64_t nanoseconds() const { return _nanoseconds.load(memory_order_relaxed); }
+
+    /**
+     * counts a call.
+     */
+    void add() { _calls.fetch_add(1, memory_order_relaxed); }
+
+    /**
+     * counts a timed call.
+     * @param nanoseconds time of the call
+     */
+    void add(uint64_t nanoseconds)
+    {
+        _calls.fetch_add(1, memory_order_relaxed);
+        _nanoseconds.fetch_add(nanoseconds, memory_order_relaxed);
+    }
+
+    /**
+     * zeroes the counters.
+     */
+    void reset()
+    {
+        _calls.store(0, memory_order_relaxed);
+        _nanoseconds.store(0, memory_order_relaxed);
+    }
+
+    /**
+     * @return the next registered site, nullptr after the last
+     */
+    const InstrumentSite *next() const { return _next; }
+
+#if INSTRUMENT_MODE == INSTRUMENT_ITT
+    /**
+     * @return name of the ITT tasks of the site
+     */
+    __itt_string_handle *handle() const { return _handle; }
+#endif
+
+private:
+    const char *_name; /**< name of the operation. */
+    atomic<uint64_t> _calls; /**< number of calls. */
+    atomic<uint64_t> _nanoseconds; /**< total time of the timed calls. */
+    InstrumentSite *_next; /**< the site registered before this one. */
+#if INSTRUMENT_MODE == INSTRUMENT_ITT
+    __itt_string_handle *_handle; /**< name of the ITT tasks. */
+#endif
+
+};
+
+#if INSTRUMENT_MODE == INSTRUMENT_ITT
+/**
+ * @return the ITT domain of all the sites
+ */
+__itt_domain *instrument_domain();
+#endif
+
+/**
+ * @return the current time of the timers, in nanoseconds
+ */
+inline uint64_t instrument_clock()
+{
+    return (uint64_t) chrono::duration_cast<chrono::nanoseconds>(
+            chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * An InstrumentScope class.
+ * This class times a block: a call of its site from construction to destruction.
+ */
+class InstrumentScope
+{
+public:
+    /**
+     * A constructor - starts the timer.
+     * @param site to count the call in
+     */
+    explicit InstrumentScope(InstrumentSite &site) : _site(site)
+    {
+#if INSTRUMENT_MODE == INSTRUMENT_ITT
+        __itt_task_begin(instrument_domain(), __itt_null, __itt_null, site.handle());
+#elif INSTRUMENT_MODE == INSTRUMENT_SDT
+        DTRACE_PROBE1(ex1, begin, site.name());
+#endif
+        _start = instrument_clock();
+    }
+
+    InstrumentScope(const InstrumentScope &) = delete;
+
+    InstrumentScope &operator=(const InstrumentScope &) = delete;
+
+    /**
+     * A destructor - counts the call with its time.
+     */
+    ~InstrumentScope()
+    {
+        uint64_t nanoseconds = instrument_clock() - _start;
+        _site.add(nanoseconds);
+#if INSTRUMENT_MODE == INSTRUMENT_ITT
+        __itt_task_end(instrument_domain());
+#elif INSTRUMENT_MODE == INSTRUMENT_SDT
+        DTRACE_PROBE2(ex1, end, _site.name(), nanoseconds);
+#endif
+    }
+
+private:
+    InstrumentSite &_site; /**< the site of the call. */
+    uint64_t _start; /**< instrument_clock() at construction. */
+
+};
+
+#if INSTRUMENT_MODE == INSTRUMENT_NONE
+#define INSTRUMENT_SCOPE(name)
+#define INSTRUMENT_CALL(name)
+#else
+/**
+ * times the rest of the enclosing block as a call of the site name, at most once a block.
+ */
+#define INSTRUMENT_SCOPE(name) \
+    static InstrumentSite _instrumentSite(name); \
+    const InstrumentScope _instrumentScope(_instrumentSite)
+
+/**
+ * counts a call of the site name, usable in a constexpr function: nothing happens in a
+ * constant expression, and the site is a static of a lambda, which a constexpr function
+ * cannot have itself.
+ */
+#define INSTRUMENT_CALL(name) \
+    do \
+    { \
+        if (! __builtin_is_constant_evaluated()) \
+        { \
+            []() { static InstrumentSite site(name); site.add(); }(); \
+        } \
+    } while (false)
+#endif
+
+/**
+ * @return the first registered site, the others follow by next(), nullptr if none
+ */
+const InstrumentSite *instrument_sites();
+
+/**
+ * zeroes the counters of all the sites.
+ */
+void instrument_reset();
+
+/**
+ * writes the counters of all the sites, of the same name added up, by decreasing time and
+ * then calls: name, calls, total and mean time. the sites without calls are left out.
+ * @param os to write to
+ */
+void instrument_report(ostream &os);
+
+/**
+ * writes the counters as instrument_report, as a JSON document of the mode and an array of
+ * the sites, objects with the keys "name", "calls" and "nanoseconds".
+ * @param os to write to
+ */
+void instrument_json(ostream &os);
+
+#endif //EX1_INSTRUMENT_H
@@ -0,0 +1,82 @@
+// Created by liorP.
+//
+
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "Instrument.h"
+#include "Transform.h"
+
+/**
+ * number of products of the per call benchmarks.
+ */
+#define INSTRUMENT_PRODUCTS 4096
+
+// --------------------------------------------------------------------------------------
+// The cost of the instrumentation of Instrument.h, whatever INSTRUMENT_MODE the build has:
+// a loop of Matrix3D products as is, with a counted call a product (INSTRUMENT_CALL) and
+// with a timed call a product (INSTRUMENT_SCOPE), and transform_batch with a timed call
+// per block of points. The sites of these benchmarks are their own, and with INSTRUMENT_MODE
+// other than INSTRUMENT_NONE the products count in Matrix::operator* as well.
+// --------------------------------------------------------------------------------------
+
+/**
+ * benchmarks the cost a call of the counters and timers.
+ * @param bench to measure with
+ */
+static void instrumentCost(Bench &bench)
+{
+    static InstrumentSite counted("bench counted product"), timed("bench timed product"),
+            block("bench timed block");
+    const vector<Matrix3D> matrices = bench_matrices(INSTRUMENT_PRODUCTS);
+    bench.measure("Matrix3D product", INSTRUMENT_PRODUCTS, [&]() {
+        Matrix3D sum;
+        for (const Matrix3D &m : matrices)
+        {
+            sum += m * matrices[0];
+        }
+        keep(sum);
+    });
+    bench.measure("Matrix3D product, counted", INSTRUMENT_PRODUCTS, [&]() {
+        Matrix3D sum;
+        for (const Matrix3D &m : matrices)
+        {
+            counted.add();
+            sum += m * matrices[0];
+        }
+        keep(sum);
+    });
+    bench.measure("Matrix3D product, timed", INSTRUMENT_PRODUCTS, [&]() {
+        Matrix3D sum;
+        for (const Matrix3D &m : matrices)
+        {
+            const InstrumentScope scope(timed);
+            sum += m * matrices[0];
+        }
+        keep(sum);
+    });
+    const vector<Vector3D> points = bench_points(BENCH_ARRAY);
+    vector<Vector3D> out(BENCH_ARRAY);
+    for (size_t size : {(size_t) 64, (size_t) 4096})
+    {
+        const string suffix = "/" + to_string(size);
+        bench.measure("transform_batch" + suffix, points.size(), [&]() {
+            for (size_t first = 0; first < points.size(); first += size)
+            {
+                transform_batch(matrices[0], Span<const Vector3D>(points.data() + first, size),
+                                Span<Vector3D>(out.data() + first, size));
+            }
+            keep(out);
+        });
+        bench.measure("transform_batch, timed" + suffix, points.size(), [&]() {
+            for (size_t first = 0; first < points.size(); first += size)
+            {
+                const InstrumentScope scope(block);
+                transform_batch(matrices[0], Span<const Vector3D>(points.data() + first, size),
+                                Span<Vector3D>(out.data() + first, size));
+            }
+            keep(out);
+        });
+    }
+}
+
+BENCHMARK(instrumentCost);
@@ -0,0 +1,426 @@
+// Created by liorP.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include "KdTree.h"
+#include "Parallel.h"
+
+#define SIZE_ERROR "Input and output sizes differ"
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the KdTree class.
+// The recursions are templates over the entry type, the private KdTree::Entry.
+// --------------------------------------------------------------------------------------
+
+namespace
+{
+/**
+ * orders neighbors by distance, the max heap order of the k nearest search.
+ */
+inline bool closer(const Neighbor &a, const Neighbor &b)
+{
+    return a.distance_squared < b.distance_squared;
+}
+
+/**
+ * replaces the farthest neighbor of a full max heap and sifts the new one down, half the
+ * work of a pop_heap and a push_heap.
+ * @param heap max heap by distance
+ * @param k number of elements in the heap
+ * @param neighbor closer than the top of the heap
+ */
+inline void replaceFarthest(Neighbor *heap, const size_t k, const Neighbor neighbor)
+{
+    size_t i = 0;
+    while (true)
+    {
+        size_t child = 2 * i + 1;
+        if (child >= k)
+        {
+            break;
+        }
+        if (child + 1 < k && heap[child + 1].distance_squared > heap[child].distance_squared)
+        {
+            ++ child;
+        }
+        if (heap[child].distance_squared <= neighbor.distance_squared)
+        {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = neighbor;
+}
+
+/**
+ * splits [begin, end) at its middle along the axis of its widest extent.
+ * @param entries of the tree
+ * @param axes split axes of the tree
+ * @param begin first entry of the subtree
+ * @param end past the last entry of the subtree
+ * @return the middle
+ */
+template<typename Entry>
+size_t split(Entry *entries, unsigned char *axes, const size_t begin, const size_t end)
+{
+    const double inf = numeric_limits<double>::infinity();
+    double lower[3] = {inf, inf, inf}, upper[3] = {- inf, - inf, - inf};
+    for (size_t i = begin; i < end; ++ i)
+    {
+        const double *p = entries[i].point.data();
+        for (int axis = 0; axis < 3; ++ axis)
+        {
+            lower[axis] = min(lower[axis], p[axis]);
+            upper[axis] = max(upper[axis], p[axis]);
+        }
+    }
+    int axis = 0;
+    for (int i = 1; i < 3; ++ i)
+    {
+        if (upper[i] - lower[i] > upper[axis] - lower[axis])
+        {
+            axis = i;
+        }
+    }
+    size_t mid = begin + (end - begin) / 2;
+    nth_element(entries + begin, entries + mid, entries + end, [axis](const Entry &a, const Entry &b) {
+        return a.point.data()[axis] < b.point.data()[axis];
+    });
+    axes[mid] = (unsigned char) axis;
+    return mid;
+}
+
+/**
+ * builds the subtree of [begin, end).
+ * @param entries of the tree
+ * @param axes split axes of the tree
+ * @param begin first entry of the subtree
+ * @param end past the last entry of the subtree
+ */
+template<typename Entry>
+void buildRange(Entry *entries, unsigned char *axes, const size_t begin, const size_t end)
+{
+    if (end - begin <= KDTREE_LEAF)
+    {
+        return;
+    }
+    size_t mid = split(entries, axes, begin, end);
+    buildRange(entries, axes, begin, mid);
+    buildRange(entries, axes, mid + 1, end);
+}
+
+/**
+ * the k nearest search of the subtree of [begin, end), nearer child first. the far child
+ * is pruned by the distance to its cell, kept incrementally: offsets[axis] is how far the
+ * query is outside the cell along the axis, and cell the sum of their squares (Arya & Mount).
+ * @param entries of the tree
+ * @param axes split axes of the tree
+ * @param begin first entry of the subtree
+ * @param end past the last entry of the subtree
+ * @param query point to search around
+ * @param offsets distances of the query from the cell of the subtree along the axes
+ * @param cell squared distance of the query from the cell of the subtree
+ * @param heap the k closest so far, a max heap by distance
+ * @param count number of elements in the heap
+ * @param k capacity of the heap
+ */
+template<typename Entry>
+void nearestRange(const Entry *entries, const unsigned char *axes, const size_t begin, const size_t end,
+                  const Vector3D &query, double offsets[3], const double cell, Neighbor *heap, size_t &count,
+                  const size_t k)
+{
+    auto consider = [&](const Entry &entry) {
+        double distance = entry.point.dist_squared(query);
+        if (count < k)
+        {
+            heap[count ++] = Neighbor{entry.index, distance};
+            push_heap(heap, heap + count, closer);
+        }
+        else if (distance < heap[0].distance_squared)
+        {
+            replaceFarthest(heap, k, Neighbor{entry.index, distance});
+        }
+    };
+    if (end - begin <= KDTREE_LEAF)
+    {
+        for (size_t i = begin; i < end; ++ i)
+        {
+            consider(entries[i]);
+        }
+        return;
+    }
+    size_t mid = begin + (end - begin) / 2;
+    int axis = axes[mid];
+    double difference = query.data()[axis] - entries[mid].point.data()[axis];
+    size_t nearBegin = difference < 0 ? begin : mid + 1, nearEnd = difference < 0 ? mid : end;
+    size_t farBegin = difference < 0 ? mid + 1 : begin, farEnd = difference < 0 ? end : mid;
+    nearestRange(entries, axes, nearBegin, nearEnd, query, offsets, cell, heap, count, k);
+    consider(entries[mid]);
+    // the far cell is |difference| away along the axis instead of offsets[axis]
+    double old = offsets[axis];
+    double far = cell - old * old + difference * difference;
+    if (count < k || far < heap[0].distance_squared)
+    {
+        offsets[axis] = difference;
+        nearestRange(entries, axes, farBegin, farEnd, query, offsets, far, heap, count, k);
+        offsets[axis] = old;
+    }
+}
+
+/**
+ * the radius search of the subtree of [begin, end).
+ * @param entries of the tree
+ * @param axes split axes of the tree
+ * @param begin first entry of the subtree
+ * @param end past the last entry of the subtree
+ * @param query point to search around
+ * @param bound squared radius
+ * @param out receives the points within the radius
+ */
+template<typename Entry>
+void withinRange(const Entry *entries, const unsigned char *axes, const size_t begin, const size_t end,
+                 const Vector3D &query, const double bound, vector<Neighbor> &out)
+{
+    auto consider = [&](const Entry &entry) {
+        double distance = entry.point.dist_squared(query);
+        if (distance <= bound)
+        {
+            out.push_back(Neighbor{entry.index, distance});
+        }
+    };
+    if (end - begin <= KDTREE_LEAF)
+    {
+        for (size_t i = begin; i < end; ++ i)
+        {
+            consider(entries[i]);
+        }
+        return;
+    }
+    size_t mid = begin + (end - begin) / 2;
+    double difference = query.data()[axes[mid]] - entries[mid].point.data()[axes[mid]];
+    consider(entries[mid]);
+    if (difference <= 0 || difference * difference <= bound)
+    {
+        withinRange(entries, axes, begin, mid, query, bound, out);
+    }
+    if (difference >= 0 || difference * difference <= bound)
+    {
+        withinRange(entries, axes, mid + 1, end, query, bound, out);
+    }
+}
+}
+
+/**
+* A constructor - builds the tree, the top levels on the calling thread and the
+* subtrees below them in parallel.
+* @param points to index, point i has index i
+*/
+KdTree::KdTree(const Span<const Vector3D> points) : _size(points.size())
+{
+    INSTRUMENT_SCOPE("KdTree::KdTree");
+    if (points.empty())
+    {
+        return;
+    }
+    _trees.emplace_back();
+    Tree &tree = _trees.back();
+    tree.entries.resize(points.size());
+    for (size_t i = 0; i < points.size(); ++ i)
+    {
+        tree.entries[i] = Entry{points[i], i};
+    }
+    build(tree);
+}
+
+/**
+* builds a tree over its entries, reordering them.
+* @param tree with the entries set
+*/
+void KdTree::build(Tree &tree)
+{
+    Entry *entries = tree.entries.data();
+    tree.axes.assign(tree.entries.size(), 0);
+    unsigned char *axes = tree.axes.data();
+    // the top levels split here until there are a few subtrees a thread
+    vector<pair<size_t, size_t>> ranges = {{0, tree.entries.size()}};
+    const size_t subtrees = parallelism() > 1 ? 4 * (size_t) parallelism() : 1;
+    bool split = true;
+    while (ranges.size() < subtrees && split)
+    {
+        split = false;
+        vector<pair<size_t, size_t>> next;
+        for (const auto &range : ranges)
+        {
+            if (range.second - range.first <= KDTREE_LEAF)
+            {
+                next.push_back(range);
+                continue;
+            }
+            size_t mid = ::split(entries, axes, range.first, range.second);
+            next.emplace_back(range.first, mid);
+            next.emplace_back(mid + 1, range.second);
+            split = true;
+        }
+        ranges.swap(next);
+    }
+    parallel_for(ranges.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++ i)
+        {
+            buildRange(entries, axes, ranges[i].first, ranges[i].second);
+        }
+    });
+}
+
+/**
+* adds a point, O(log n) amortized rebuilding.
+* @param point to add, its index is the size before the insert
+*/
+void KdTree::insert(const Vector3D &point)
+{
+    _trees.emplace_back();
+    _trees.back().entries.push_back(Entry{point, _size ++});
+    _trees.back().axes.push_back(0);
+    // merges the trees that are not larger than the one after them, like a binary counter
+    while (_trees.size() >= 2 && _trees[_trees.size() - 2].entries.size() <= _trees.back().entries.size())
+    {
+        Tree &merged = _trees[_trees.size() - 2];
+        merged.entries.insert(merged.entries.end(), _trees.back().entries.begin(), _trees.back().entries.end());
+        _trees.pop_back();
+        build(merged);
+    }
+}
+
+/**
+* the k nearest search over all the trees, into a max heap.
+* @param query point to search around
+* @param heap the k closest so far, a max heap by distance, of capacity k
+* @param count number of elements in the heap
+* @param k capacity of the heap
+*/
+void KdTree::search(const Vector3D &query, Neighbor *heap, size_t &count, const size_t k) const
+{
+    for (const Tree &tree : _trees)
+    {
+        double offsets[3] = {0, 0, 0};
+        nearestRange(tree.entries.data(), tree.axes.data(), 0, tree.entries.size(), query, offsets, 0.0, heap,
+                     count, k);
+    }
+}
+
+/**
+* the radius search over all the trees.
+* @param query point to search around
+* @param bound squared radius
+* @param out receives the points within the radius, unordered
+*/
+void KdTree::search(const Vector3D &query, const double bound, vector<Neighbor> &out) const
+{
+    for (const Tree &tree : _trees)
+    {
+        withinRange(tree.entries.data(), tree.axes.data(), 0, tree.entries.size(), query, bound, out);
+    }
+}
+
+/**
+* @param query point to search around
+* @param k number of neighbors
+* @return the min(k, size()) points closest to query, nearest first
+*/
+vector<Neighbor> KdTree::nearest(const Vector3D &query, const size_t k) const
+{
+    vector<Neighbor> ans(min(k, _size));
+    size_t count = 0;
+    if (! ans.empty())
+    {
+        search(query, ans.data(), count, ans.size());
+    }
+    sort_heap(ans.begin(), ans.end(), closer);
+    return ans;
+}
+
+/**
+* @param query point to search around
+* @param radius of the ball
+* @return the points at a distance of at most radius from query, nearest first
+*/
+vector<Neighbor> KdTree::within(const Vector3D &query, const double radius) const
+{
+    vector<Neighbor> ans;
+    search(query, radius * radius, ans);
+    sort(ans.begin(), ans.end(), closer);
+    return ans;
+}
+
+/**
+* the k nearest neighbors of every query, in parallel.
+* @param queries points to search around
+* @param k number of neighbors of a query
+* @param out the neighbors of query i, nearest first, at out[i * k, (i + 1) * k).
+* out.size() must be queries.size() * k. if size() < k the rest of a row has index
+* SIZE_MAX and an infinite distance
+*/
+void KdTree::nearest_batch(const Span<const Vector3D> queries, const size_t k, const Span<Neighbor> out) const
+{
+    INSTRUMENT_SCOPE("KdTree::nearest_batch");
+    if (out.size() != queries.size() * k)
+    {
+        cerr << SIZE_ERROR << endl;
+        return;
+    }
+    parallel_for(queries.size(), KDTREE_GRAIN, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++ i)
+        {
+            // the row of the query is its heap
+            Neighbor *row = out.data() + i * k;
+            size_t count = 0;
+            if (k != 0)
+            {
+                search(queries[i], row, count, k);
+            }
+            sort_heap(row, row + count, closer);
+            fill(row + count, row + k, Neighbor{SIZE_MAX, numeric_limits<double>::infinity()});
+        }
+    });
+}
+
+/**
+* the neighbors of every query within a radius, in parallel.
+* @param queries points to search around
+* @param radius of the balls
+* @param neighbors receives the neighbors of all the queries, query after query, each
+* nearest first
+* @return offsets, size queries.size() + 1: the neighbors of query i are
+* neighbors[offsets[i], offsets[i + 1])
+*/
+vector<size_t> KdTree::within_batch(const Span<const Vector3D> queries, const double radius,
+                                    vector<Neighbor> &neighbors) const
+{
+    INSTRUMENT_SCOPE("KdTree::within_batch");
+    // every chunk collects its own neighbors, concatenated in order after
+    vector<vector<Neighbor>> chunks((queries.size() + KDTREE_GRAIN - 1) / KDTREE_GRAIN);
+    vector<size_t> offsets(queries.size() + 1, 0);
+    parallel_for(queries.size(), KDTREE_GRAIN, [&](size_t begin, size_t end) {
+        vector<Neighbor> &chunk = chunks[begin / KDTREE_GRAIN];
+        for (size_t i = begin; i < end; ++ i)
+        {
+            size_t first = chunk.size();
+            search(queries[i], radius * radius, chunk);
+            sort(chunk.begin() + (long) first, chunk.end(), closer);
+            offsets[i + 1] = chunk.size() - first;
+        }
+    });
+    for (size_t i = 0; i < queries.size(); ++ i)
+    {
+        offsets[i + 1] += offsets[i];
+    }
+    neighbors.clear();
+    neighbors.reserve(offsets.back());
+    for (const vector<Neighbor> &chunk : chunks)
+    {
+        neighbors.insert(neighbors.end(), chunk.begin(), chunk.end());
+    }
+    return offsets;
+}
@@ -0,0 +1,154 @@
+// Created by liorP.
+//
+
+#ifndef EX1_KDTREE_H
+#define EX1_KDTREE_H
+
+#include <vector>
+#include "Span.h"
+#include "Vector3D.h"
+
+// --------------------------------------------------------------------------------------
+// A k-d tree over Vector3D for k nearest neighbor and radius queries.
+// The tree is implicit in a flat array: the points are reordered so that the subtree of a
+// range [begin, end) splits at its middle element along the axis of its widest extent, and
+// ranges of at most KDTREE_LEAF points are leaves scanned linearly. A point and its index
+// share 32 bytes, so a leaf is a few cache lines and nothing but the split axes is stored
+// besides the points.
+// Inserted points go into a forest of trees of strictly decreasing sizes (the logarithmic
+// method): an insert makes a tree of one point and merges the trees that are not smaller,
+// so a point is rebuilt O(log n) times and a query visits O(log n) trees.
+// --------------------------------------------------------------------------------------
+
+/**
+ * number of points in a leaf of the tree.
+ */
+#define KDTREE_LEAF 16
+
+/**
+ * number of queries in a chunk of the batched queries.
+ */
+#define KDTREE_GRAIN 1024
+
+/**
+ * A result of a query.
+ */
+struct Neighbor
+{
+    size_t index; /**< index of the point, in the order the points were given and inserted. */
+    double distance_squared; /**< squared distance of the point from the query. */
+};
+
+/**
+ * A KdTree class.
+ * This class represents a spatial index over a set of Vector3D.
+ */
+class KdTree
+{
+public:
+    /**
+     * A default constructor - an empty index.
+     */
+    KdTree() : _size(0) {}
+
+    /**
+     * A constructor - builds the tree, the top levels on the calling thread and the
+     * subtrees below them in parallel.
+     * @param points to index, point i has index i
+     */
+    explicit KdTree(Span<const Vector3D> points);
+
+    /**
+     * @return number of points in the index
+     */
+    size_t size() const { return _size; }
+
+    /**
+     * adds a point, O(log n) amortized rebuilding.
+     * @param point to add, its index is the size before the insert
+     */
+    void insert(const Vector3D &point);
+
+    /**
+     * @param query point to search around
+     * @param k number of neighbors
+     * @return the min(k, size()) points closest to query, nearest first
+     */
+    vector<Neighbor> nearest(const Vector3D &query, size_t k) const;
+
+    /**
+     * @param query point to search around
+     * @param radius of the ball
+     * @return the points at a distance of at most radius from query, nearest first
+     */
+    vector<Neighbor> within(const Vector3D &query, double radius) const;
+
+    /**
+     * the k nearest neighbors of every query, in parallel.
+     * @param queries points to search around
+     * @param k number of neighbors of a query
+     * @param out the neighbors of query i, nearest first, at out[i * k, (i + 1) * k).
+     * out.size() must be queries.size() * k. if size() < k the rest of a row has index
+     * SIZE_MAX and an infinite distance
+     */
+    void nearest_batch(Span<const Vector3D> queries, size_t k, Span<Neighbor> out) const;
+
+    /**
+     * the neighbors of every query within a radius, in parallel.
+     * @param queries points to search around
+     * @param radius of the balls
+     * @param neighbors receives the neighbors of all the queries, query after query, each
+     * nearest first
+     * @return offsets, size queries.size() + 1: the neighbors of query i are
+     * neighbors[offsets[i], offsets[i + 1])
+     */
+    vector<size_t> within_batch(Span<const Vector3D> queries, double radius, vector<Neighbor> &neighbors) const;
+
+private:
+    /**
+     * A point of the tree with its index, 32 bytes.
+     */
+    struct Entry
+    {
+        Vector3D point; /**< the point. */
+        size_t index; /**< its index. */
+    };
+
+    /**
+     * A static tree of the forest.
+     */
+    struct Tree
+    {
+        vector<Entry> entries; /**< the points, in tree order. */
+        vector<unsigned char> axes; /**< axes[mid]: split axis of the subtree whose middle is mid. */
+    };
+
+    /**
+     * builds a tree over its entries, reordering them.
+     * @param tree with the entries set
+     */
+    static void build(Tree &tree);
+
+    /**
+     * the k nearest search over all the trees, into a max heap.
+     * @param query point to search around
+     * @param heap the k closest so far, a max heap by distance, of capacity k
+     * @param count number of elements in the heap
+     * @param k capacity of the heap
+     */
+    void search(const Vector3D &query, Neighbor *heap, size_t &count, size_t k) const;
+
+    /**
+     * the radius search over all the trees.
+     * @param query point to search around
+     * @param bound squared radius
+     * @param out receives the points within the radius, unordered
+     */
+    void search(const Vector3D &query, double bound, vector<Neighbor> &out) const;
+
+    vector<Tree> _trees; /**< the forest, by decreasing size. */
+    size_t _size; /**< number of points. */
+
+};
+
+#endif //EX1_KDTREE_H
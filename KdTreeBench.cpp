@@ -0,0 +1,158 @@
+// Created by liorP.
+//
+
+#include <cmath>
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "KdTree.h"
+
+/**
+ * largest point set of the benchmarks. 10^8 points take ~6 GB with the tree, so it is opt
+ * in: -DKDTREE_POINTS_MAX=100000000
+ */
+#ifndef KDTREE_POINTS_MAX
+#define KDTREE_POINTS_MAX 10000000
+#endif
+
+/**
+ * number of queries of the tree searches.
+ */
+#define KDTREE_QUERIES (1 << 14)
+
+/**
+ * number of points the brute force scans visit in total, split between their queries.
+ */
+#define BRUTE_FORCE_WORK 100000000
+
+/**
+ * expected number of points in a ball of the radius queries.
+ */
+#define BALL_POINTS 16
+
+// --------------------------------------------------------------------------------------
+// Benchmarks of the KdTree against brute force dist() scans, over 10^5 points up to
+// KDTREE_POINTS_MAX uniform in [-100, 100)^3: building, the nearest neighbor, the 8
+// nearest, and the radius queries of balls of BALL_POINTS points on average, one by one
+// and batched. The brute force scans have few queries on the large sets, every query
+// costs a pass over all the points.
+// --------------------------------------------------------------------------------------
+
+/**
+ * @param points the points
+ * @param query point to search around
+ * @return index of the point closest to query
+ */
+static size_t bruteNearest(const vector<Vector3D> &points, const Vector3D &query)
+{
+    size_t best = 0;
+    double distance = numeric_limits<double>::infinity();
+    for (size_t i = 0; i < points.size(); ++ i)
+    {
+        double d = points[i].dist(query);
+        if (d < distance)
+        {
+            distance = d;
+            best = i;
+        }
+    }
+    return best;
+}
+
+/**
+ * @param points the points
+ * @param query point to search around
+ * @param radius of the ball
+ * @return number of points within radius from query
+ */
+static size_t bruteWithin(const vector<Vector3D> &points, const Vector3D &query, double radius)
+{
+    size_t count = 0;
+    for (const Vector3D &p : points)
+    {
+        count += p.dist(query) <= radius;
+    }
+    return count;
+}
+
+/**
+ * benchmarks the tree and the brute force scans on growing point sets.
+ * @param bench to measure with
+ */
+static void nearestNeighbors(Bench &bench)
+{
+    const vector<Vector3D> queries = bench_points(KDTREE_QUERIES, 9);
+    vector<Neighbor> out(KDTREE_QUERIES * 8);
+    for (size_t count = 100000; count <= KDTREE_POINTS_MAX; count *= 10)
+    {
+        const string suffix = "/" + to_string(count);
+        const vector<Vector3D> points = bench_points(count);
+        // the volume of the cube is 200^3
+        const double radius = cbrt(BALL_POINTS * 8e6 * 3 / (4 * M_PI * (double) count));
+        bench.measure("KdTree build" + suffix, count, [&]() { keep(KdTree(points).size()); });
+        const KdTree tree(points);
+        const size_t brute = max((size_t) 2, (size_t) BRUTE_FORCE_WORK / count);
+        bench.measure("brute force dist() nearest" + suffix, brute, [&]() {
+            for (size_t i = 0; i < brute; ++ i)
+            {
+                keep(bruteNearest(points, queries[i]));
+            }
+        });
+        bench.measure("loop KdTree::nearest k=1" + suffix, KDTREE_QUERIES, [&]() {
+            for (const Vector3D &query : queries)
+            {
+                keep(tree.nearest(query, 1)[0].index);
+            }
+        });
+        for (size_t k : {1, 8})
+        {
+            Span<Neighbor> rows(out.data(), KDTREE_QUERIES * k);
+            bench.measure("KdTree::nearest_batch k=" + to_string(k) + suffix, KDTREE_QUERIES, [&]() {
+                tree.nearest_batch(queries, k, rows);
+                keep(out);
+            });
+        }
+        bench.measure("brute force dist() radius" + suffix, brute, [&]() {
+            for (size_t i = 0; i < brute; ++ i)
+            {
+                keep(bruteWithin(points, queries[i], radius));
+            }
+        });
+        vector<Neighbor> neighbors;
+        bench.measure("KdTree::within_batch" + suffix, KDTREE_QUERIES, [&]() {
+            keep(tree.within_batch(queries, radius, neighbors));
+            keep(neighbors);
+        });
+    }
+}
+
+/**
+ * benchmarks growing a tree point by point.
+ * @param bench to measure with
+ */
+static void incrementalInsert(Bench &bench)
+{
+    const vector<Vector3D> points = bench_points(1000000);
+    const vector<Vector3D> queries = bench_points(KDTREE_QUERIES, 9);
+    bench.measure("KdTree::insert/" + to_string(points.size()), points.size(), [&]() {
+        KdTree tree;
+        for (const Vector3D &p : points)
+        {
+            tree.insert(p);
+        }
+        keep(tree.size());
+    });
+    // 999999 = 11110100001000111111 in binary, a forest of 12 trees
+    KdTree grown;
+    for (size_t i = 0; i + 1 < points.size(); ++ i)
+    {
+        grown.insert(points[i]);
+    }
+    vector<Neighbor> out(KDTREE_QUERIES);
+    bench.measure("KdTree::nearest_batch k=1, inserted/" + to_string(grown.size()), KDTREE_QUERIES, [&]() {
+        grown.nearest_batch(queries, 1, out);
+        keep(out);
+    });
+}
+
+BENCHMARK(nearestNeighbors);
+BENCHMARK(incrementalInsert);
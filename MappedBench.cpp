@@ -0,0 +1,114 @@
+// Created by liorP.
+//
+
+#include <fstream>
+#include <malloc.h>
+#include <unistd.h>
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "MappedSpan.h"
+#include "Parallel.h"
+#include "Transform.h"
+
+/**
+ * number of points of the mapped file benchmarks.
+ */
+#define MAPPED_POINTS (BENCH_ARRAY / 4)
+
+// --------------------------------------------------------------------------------------
+// Startup benchmarks: getting a point set from a file into a state the reductions can run
+// on, through operator>>, the bulk readers, and a mapping. The files are written once and
+// stay in the page cache, as with geometry that is reloaded again and again.
+// The growth of the anonymous (private, not file backed) resident memory that a loaded and
+// summed set holds on to is recorded with each load (resident_mib).
+// --------------------------------------------------------------------------------------
+
+/**
+ * loads a set once and measures the resident memory it adds.
+ * @param load returns the loaded set, after summing it
+ * @return the growth of the anonymous resident memory in MiB
+ */
+template<typename Load>
+static double residentGrowth(Load load)
+{
+    // returns the free heap pages to the system, or the set could reuse them and not show
+    malloc_trim(0);
+    long before = resident_anonymous();
+    auto loaded = load();
+    long after = resident_anonymous();
+    keep(loaded);
+    return (double) (after - before) / 1024;
+}
+
+/**
+ * measures a load, with the resident memory it adds.
+ * @param bench to measure with
+ * @param name of the measurement
+ * @param load returns the loaded set, after summing it
+ */
+template<typename Load>
+static void measureLoad(Bench &bench, const string &name, Load load)
+{
+    const double resident = residentGrowth(load);
+    bench.measure(name, MAPPED_POINTS, [&]() { keep(load()); }).resident_mib = resident;
+}
+
+/**
+ * benchmarks loading a point set and summing it.
+ * @param bench to measure with
+ */
+static void mappedStartup(Bench &bench)
+{
+    const string prefix = "/tmp/ex1_bench_" + to_string(getpid());
+    const string textPath = prefix + ".txt", binaryPath = prefix + ".bin";
+    {
+        vector<Vector3D> points = bench_points(MAPPED_POINTS);
+        ofstream text(textPath);
+        write_text(text, points);
+        ofstream binary(binaryPath, ios::binary);
+        write_binary(binary, points);
+    }
+    auto streamed = [&]() {
+        ifstream is(textPath);
+        vector<Vector3D> points(MAPPED_POINTS);
+        for (Vector3D &point : points)
+        {
+            is >> point;
+        }
+        keep(parallel_sum(points));
+        return points;
+    };
+    auto parsed = [&]() {
+        ifstream is(textPath);
+        vector<Vector3D> points;
+        read_text(is, points);
+        keep(parallel_sum(points));
+        return points;
+    };
+    auto read = [&]() {
+        ifstream is(binaryPath, ios::binary);
+        vector<Vector3D> points;
+        read_binary(is, points);
+        keep(parallel_sum(points));
+        return points;
+    };
+    auto mapped = [&]() {
+        MappedVector3DSpan points(binaryPath);
+        keep(parallel_sum(points));
+        return points;
+    };
+    measureLoad(bench, "operator>> + sum", streamed);
+    measureLoad(bench, "read_text + sum", parsed);
+    measureLoad(bench, "read_binary + sum", read);
+    measureLoad(bench, "MappedVector3DSpan + sum", mapped);
+    MappedVector3DSpan points(binaryPath);
+    vector<Vector3D> out(points.size());
+    bench.measure("transform_batch(MappedVector3DSpan)", MAPPED_POINTS, [&]() {
+        transform_batch(bench_matrices(1)[0], points, out);
+        keep(out);
+    });
+    remove(textPath.c_str());
+    remove(binaryPath.c_str());
+}
+
+BENCHMARK(mappedStartup);
@@ -0,0 +1,111 @@
+// Created by liorP.
+//
+
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "MappedSpan.h"
+
+#define OPEN_ERROR "Can't map the file"
+#define HEADER_ERROR "The file is not a binary file of this library"
+#define ORDER_ERROR "The file is of the other byte order, read it with read_binary"
+#define WIDTH_ERROR "The binary file holds elements of another type"
+#define SIZE_ERROR "The file is shorter than its header says"
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the class MappedFile.
+// --------------------------------------------------------------------------------------
+
+/**
+* A constructor - maps a binary file.
+* @param path of the file
+* @param width doubles per element
+*/
+MappedFile::MappedFile(const string &path, const uint32_t width) : MappedFile()
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat info{};
+    if (fd < 0 || fstat(fd, &info) != 0 || (size_t) info.st_size < sizeof(BinaryHeader))
+    {
+        cerr << OPEN_ERROR << " " << path << endl;
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return;
+    }
+    size_t bytes = (size_t) info.st_size;
+    // the mapping holds its own reference to the file
+    void *map = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED)
+    {
+        cerr << OPEN_ERROR << " " << path << endl;
+        return;
+    }
+    BinaryHeader header{};
+    memcpy(&header, map, sizeof(header));
+    const char *error = nullptr;
+    if (memcmp(header.magic, BINARY_MAGIC, sizeof(header.magic)) != 0)
+    {
+        error = HEADER_ERROR;
+    }
+    else if (header.endian != BINARY_ENDIAN)
+    {
+        error = __builtin_bswap32(header.endian) == BINARY_ENDIAN ? ORDER_ERROR : HEADER_ERROR;
+    }
+    else if (header.width != width)
+    {
+        error = WIDTH_ERROR;
+    }
+    else if (header.count > (bytes - sizeof(BinaryHeader)) / (width * sizeof(double)))
+    {
+        error = SIZE_ERROR;
+    }
+    if (error != nullptr)
+    {
+        cerr << error << " " << path << endl;
+        munmap(map, bytes);
+        return;
+    }
+    _map = map;
+    _bytes = bytes;
+    _count = header.count;
+}
+
+/**
+* A move constructor.
+* @param other file to take the mapping of
+*/
+MappedFile::MappedFile(MappedFile &&other) noexcept : _map(other._map), _bytes(other._bytes), _count(other._count)
+{
+    other._map = nullptr;
+    other._bytes = 0;
+    other._count = 0;
+}
+
+/**
+* A destructor - unmaps the file.
+*/
+MappedFile::~MappedFile()
+{
+    if (_map != nullptr)
+    {
+        munmap(_map, _bytes);
+    }
+}
+
+/**
+* = operator overload.
+* @param other file to take the mapping of
+* @return reference to this file
+*/
+MappedFile &MappedFile::operator=(MappedFile other) noexcept
+{
+    swap(_map, other._map);
+    swap(_bytes, other._bytes);
+    swap(_count, other._count);
+    return *this;
+}
@@ -0,0 +1,162 @@
+// Created by liorP.
+//
+
+#ifndef EX1_MAPPEDSPAN_H
+#define EX1_MAPPEDSPAN_H
+
+#include <string>
+#include "BulkIO.h"
+
+// --------------------------------------------------------------------------------------
+// Read only views of binary files (see BulkIO.h) mapped into memory.
+// The records are used where they lie in the page cache, as Vector3D / Matrix3D ranges:
+// nothing is parsed or copied, and pages are only read from disk when first touched.
+// A view converts to Span<const T>, so it feeds the batch and parallel paths directly.
+// Only files of the native byte order can be mapped.
+// --------------------------------------------------------------------------------------
+
+/**
+ * A binary file mapped into memory, the type independent part of MappedSpan.
+ */
+class MappedFile
+{
+public:
+    /**
+     * A constructor - maps nothing.
+     */
+    MappedFile() : _map(nullptr), _bytes(0), _count(0) {}
+
+    /**
+     * A constructor - maps a binary file. prints an error and maps nothing if the file can't
+     * be mapped or isn't a binary file of elements of width doubles.
+     * @param path of the file
+     * @param width doubles per element
+     */
+    MappedFile(const string &path, uint32_t width);
+
+    MappedFile(const MappedFile &other) = delete;
+
+    /**
+     * A move constructor.
+     * @param other file to take the mapping of
+     */
+    MappedFile(MappedFile &&other) noexcept;
+
+    /**
+     * A destructor - unmaps the file.
+     */
+    ~MappedFile();
+
+    /**
+     * = operator overload.
+     * @param other file to take the mapping of
+     * @return reference to this file
+     */
+    MappedFile &operator=(MappedFile other) noexcept;
+
+    /**
+     * @return true if a file is mapped
+     */
+    bool is_open() const { return _map != nullptr; }
+
+    /**
+     * @return the first double of the first element
+     */
+    const double *records() const
+    {
+        return _map == nullptr ? nullptr : reinterpret_cast<const double *>(static_cast<const char *>(_map) +
+                                                                             sizeof(BinaryHeader));
+    }
+
+    /**
+     * @return number of elements in the file
+     */
+    size_t count() const { return _count; }
+
+private:
+    void *_map; /**< the mapping. */
+    size_t _bytes; /**< length of the mapping. */
+    size_t _count; /**< number of elements. */
+
+};
+
+/**
+ * A read only range of T over a mapped binary file.
+ */
+template<typename T>
+class MappedSpan
+{
+public:
+    static_assert(sizeof(T) % sizeof(double) == 0 && is_standard_layout<T>::value,
+                  "the records of a mapped file are plain doubles");
+
+    /**
+     * A constructor - the empty range.
+     */
+    MappedSpan() = default;
+
+    /**
+     * A constructor - maps a binary file written by write_binary. prints an error and
+     * makes an empty range if the file can't be mapped.
+     * @param path of the file
+     */
+    explicit MappedSpan(const string &path) : _file(path, sizeof(T) / sizeof(double)) {}
+
+    /**
+     * @return true if a file is mapped
+     */
+    bool is_open() const { return _file.is_open(); }
+
+    /**
+     * @return first element of the range
+     */
+    const T *data() const { return reinterpret_cast<const T *>(_file.records()); }
+
+    /**
+     * @return number of elements in the range
+     */
+    size_t size() const { return _file.count(); }
+
+    /**
+     * @return true if the range is empty
+     */
+    bool empty() const { return size() == 0; }
+
+    /**
+     *[] operator overload
+     * @param i index of element
+     * @return reference to the element
+     */
+    const T &operator[](size_t i) const { return data()[i]; }
+
+    /**
+     * @return iterator to the first element
+     */
+    const T *begin() const { return data(); }
+
+    /**
+     * @return iterator past the last element
+     */
+    const T *end() const { return data() + size(); }
+
+    /**
+     * @return the whole range as a span
+     */
+    operator Span<const T>() const { return Span<const T>(data(), size()); }
+
+private:
+    MappedFile _file; /**< the mapping. */
+
+};
+
+/**
+ * a mapped binary file of vectors.
+ */
+typedef MappedSpan<Vector3D> MappedVector3DSpan;
+
+/**
+ * a mapped binary file of matrices.
+ */
+typedef MappedSpan<Matrix3D> MappedMatrix3DSpan;
+
+#endif //EX1_MAPPEDSPAN_H
@@ -0,0 +1,683 @@
+// Created by liorP.
+//
+
+#ifndef EX1_MATRIX_H
+#define EX1_MATRIX_H
+
+#include "Vector.h"
+
+
+/**
+ * default tolerance of the singularity test, relative to the scale of the matrix (see is_singular).
+ */
+#define SINGULAR_TOLERANCE 1e-12
+
+/**
+ * A Matrix class.
+ * This class represents a Matrix R*C of type T, kept as R row vectors.
+ * Like Vector, all the arithmetic is defined inline (and constexpr) in this header, with the
+ * loops over the rows and columns unrolled at compile time.
+ */
+template<size_t R, size_t C, typename T = double>
+class Matrix
+{
+public:
+    /**
+     * the type of an element.
+     */
+    typedef T value_type;
+
+    /**
+     * the type of a row.
+     */
+    typedef Vector<C, T> row_type;
+
+    /**
+     * the type of a column.
+     */
+    typedef Vector<R, T> column_type;
+
+    /**
+     * A Constructor.
+     * inits with R row vectors, each copied once. 3 rows have the constructor below.
+     * @param rows R Vector<C, T>
+     */
+    template<typename... Rows, typename = enable_if_t<sizeof...(Rows) == R && R != 3 &&
+                                                      conjunction<is_same<Rows, row_type>...>::value>>
+    constexpr Matrix(const Rows &... rows) : _rows{rows...} {}
+
+    /**
+     * A Constructor - 3 rows, each copied once. the rows are not deduced, so they may be
+     * anything a row converts from, e.g. Matrix3D({1, 2, 3}, {4, 5, 6}, {7, 8, 10}).
+     * @param row0 first row
+     * @param row1 second row
+     * @param row2 third row
+     */
+    template<size_t N = R, typename = enable_if_t<N == 3>>
+    constexpr Matrix(const row_type &row0, const row_type &row1, const row_type &row2) : _rows{row0, row1, row2} {}
+
+    /**
+     * A Constructor - R*C numbers, row after row.
+     * @param elements R*C numbers
+     */
+    template<typename... Elements, typename = enable_if_t<sizeof...(Elements) == R * C && (R > 1 || C > 1) &&
+                                                          conjunction<is_arithmetic<Elements>...>::value>,
+            typename = void>
+    constexpr Matrix(Elements... elements) : Matrix(initializer(elements...)) {}
+
+    /**
+     * A default Constructor - zero matrix.
+     */
+    constexpr Matrix() : _rows{} {}
+
+    /**
+     * A Constructor - scalar matrix.
+     * @param scalar as the elements of the diagonal
+     */
+    constexpr explicit Matrix(T scalar) : _rows{}
+    {
+        unroll<(R < C ? R : C)>([&](size_t i) { _rows[i][(int) i] = scalar; });
+    }
+
+    /**
+     * A Copy Constructor - trivial, so Matrix is trivially copyable and bulk copies are memcpy.
+     * @param matrix to copy from
+     */
+    constexpr Matrix(const Matrix &matrix) = default;
+
+    /**
+     * A constructor - array of R*C elements, row after row
+     * @param arr T[R * C]
+     */
+    constexpr explicit Matrix(const T arr[R * C]) : _rows{}
+    {
+        unroll<R>([&](size_t i) { _rows[i] = row_type(arr + i * C); });
+    }
+
+    /**
+     * A Constructor - 2 dimensional array R*C
+     * @param arr T[R][C]
+     */
+    constexpr explicit Matrix(const T arr[R][C]) : _rows{}
+    {
+        unroll<R>([&](size_t i) { _rows[i] = row_type(arr[i]); });
+    }
+
+    /**
+     * + operator overload
+     * @param matrix2 matrix to be added with this matrix
+     * @return new matrix which is the addition of these two matrix.
+     */
+    constexpr Matrix operator+(const Matrix &matrix2) const;
+
+    /**
+     *- operator overload
+     * @param matrix2 matrix to be deducted from this matrix
+     * @return new matrix which is the deduction of these two matrix.
+     */
+    constexpr Matrix operator-(const Matrix &matrix2) const;
+
+    /**
+     * += operator overload
+     * @param other matrix to be added
+     * @return reference to this matrix
+     */
+    constexpr Matrix &operator+=(const Matrix &other);
+
+    /**
+     * -= operator overload
+     * @param other other matrix to be deducted from
+     * @return reference to this matrix
+     */
+    constexpr Matrix &operator-=(const Matrix &other);
+
+    /**
+     * * operator overload
+     * @param vector to multiply with
+     * @return result vector
+     */
+    constexpr column_type operator*(const row_type &vector) const;
+
+    /**
+     * * operator overload
+     * @param other matrix to multiply with
+     * @return result Matrix
+     */
+    template<size_t K>
+    constexpr Matrix<R, K, T> operator*(const Matrix<C, K, T> &other) const;
+
+    /**
+     * *= operator overload
+     * @param other matrix to multiply with
+     * @return reference to this matrix
+     */
+    constexpr Matrix &operator*=(const Matrix<C, C, T> &other);
+
+    /**
+     * *= operator overload
+     * @param scalar to multiply with - each of the elements with that that scalar
+     * @return reference to this matrix
+     */
+    constexpr Matrix &operator*=(T scalar);
+
+    /**
+     * /= operator overload
+     * @param scalar to divide with - each of the elements with that that scalar
+     * @return reference to this matrix
+     */
+    constexpr Matrix &operator/=(T scalar);
+
+    /**
+     *[] operator overload. the index is checked according to BOUNDS_CHECK (see Bounds.h).
+     * @param i index of row to approach to
+     * @return the i'th row of the matrix
+     */
+    constexpr row_type &operator[](int i);
+
+    /**
+     *[] const operator overload. the index is checked according to BOUNDS_CHECK (see Bounds.h).
+     * @param i index of row to approach to
+     * @return the i'th row of the matrix
+     */
+    constexpr const row_type &operator[](int i) const;
+
+    /**
+     * = operator overload - trivial, like the copy constructor.
+     * @param matrix to copy
+     * @return refrence to copied matrix
+     */
+    constexpr Matrix &operator=(const Matrix &matrix) = default;
+
+    /**
+     * returns the i row of the matrix. the index is checked according to BOUNDS_CHECK (see Bounds.h).
+     * @param index of row to return
+     * @return row_type
+     */
+    constexpr row_type row(short index) const;
+
+    /**
+     * returns the i column of the matrix. the index is checked according to BOUNDS_CHECK (see Bounds.h).
+     * @param index of column to return
+     * @return column_type
+     */
+    constexpr column_type column(short index) const;
+
+    /**
+     * gives the transposed matrix.
+     * @return transpose
+     */
+    constexpr Matrix<C, R, T> transpose() const;
+
+    /**
+     * gives the trace of the matrix. square matrices only.
+     * @return trace
+     */
+    constexpr T trace() const;
+
+    /**
+     * gives the determinant of the matrix. square matrices only.
+     * @return determinant
+     */
+    constexpr T determinant() const;
+
+    /**
+     * checks if the matrix is singular relative to its scale: |det| <= tolerance * |row 0| * ... * |row R-1|.
+     * the product of the row norms bounds |det| (Hadamard), so the test doesn't depend on the
+     * units of the elements. square matrices only.
+     * @param tolerance relative to the product of the row norms
+     * @return true if singular
+     */
+    constexpr bool is_singular(T tolerance = SINGULAR_TOLERANCE) const;
+
+    /**
+     * gives the inverse of the matrix, the adjugate divided by the determinant. square matrices only.
+     * reports an error and returns the zero matrix if the matrix is singular (see is_singular and Errors.h).
+     * @param tolerance of the singularity test
+     * @return inverse
+     */
+    constexpr Matrix inverse(T tolerance = SINGULAR_TOLERANCE) const;
+
+    /**
+     * returns the matrix without one row and one column.
+     * @param row index of the row to drop
+     * @param col index of the column to drop
+     * @return the submatrix
+     */
+    constexpr Matrix<R - 1, C - 1, T> submatrix(size_t row, size_t col) const;
+
+private:
+    /**
+     * the singularity test of a known determinant.
+     * @param det determinant of the matrix
+     * @param tolerance relative to the product of the row norms
+     * @return true if singular
+     */
+    constexpr bool singular(T det, T tolerance) const;
+
+    /**
+     * the elements, as an array the array constructor can delegate to.
+     */
+    struct Elements
+    {
+        T values[R * C]; /**< the elements, row after row. */
+    };
+
+    /**
+     * A constructor - used by the R*C numbers constructor.
+     * @param elements the elements, row after row
+     */
+    constexpr explicit Matrix(const Elements &elements) : Matrix(elements.values) {}
+
+    /**
+     * packs R*C numbers into an Elements.
+     * @param elements R*C numbers
+     * @return the elements
+     */
+    template<typename... Args>
+    static constexpr Elements initializer(Args... elements)
+    {
+        return Elements{{static_cast<T>(elements)...}};
+    }
+
+    row_type _rows[R]; /**< the rows. */
+
+};
+
+// --------------------------------------------------------------------------------------
+// Inline implementation of the class Matrix.
+// --------------------------------------------------------------------------------------
+
+// ------------------ Operators Overloading ------------------------
+
+/**
+* + operator overload
+* @param matrix2 matrix to be added with this matrix
+* @return new matrix which is the addition of these two matrix.
+*/
+template<size_t R, size_t C, typename T>
+constexpr Matrix<R, C, T> Matrix<R, C, T>::operator+(const Matrix &matrix2) const
+{
+    auto ans = Matrix(*this);
+    ans += matrix2;
+    return ans;
+}
+
+/**
+* - operator overload
+* @param matrix2 matrix to be deducted from this matrix
+* @return new matrix which is the deduction of these two matrix.
+*/
+template<size_t R, size_t C, typename T>
+constexpr Matrix<R, C, T> Matrix<R, C, T>::operator-(const Matrix &matrix2) const
+{
+    auto ans = Matrix(*this);
+    ans -= matrix2;
+    return ans;
+}
+
+/**
+* += operator overload
+* @param other matrix to be added
+* @return reference to this matrix
+*/
+template<size_t R, size_t C, typename T>
+constexpr Matrix<R, C, T> &Matrix<R, C, T>::operator+=(const Matrix &other)
+{
+    unroll<R>([&](size_t i) { _rows[i] += other._rows[i]; });
+    return *this;
+}
+
+/**
+* -= operator overload
+* @param other other matrix to be deducted from
+* @return reference to this matrix
+*/
+template<size_t R, size_t C, typename T>
+constexpr Matrix<R, C, T> &Matrix<R, C, T>::operator-=(const Matrix &other)
+{
+    unroll<R>([&](size_t i) { _rows[i] -= other._rows[i]; });
+    return *this;
+}
+
+/**
+* * operator overload
+* @param vector to multiply with
+* @return result vector
+*/
+template<size_t R, size_t C, typename T>
+constexpr typename Matrix<R, C, T>::column_type Matrix<R, C, T>::operator*(const row_type &vector) const
+{
+    INSTRUMENT_CALL("Matrix::operator*(Vector)");
+    //R dot products
+    column_type ans;
+    unroll<R>([&](size_t i) { ans[(int) i] = _rows[i] * vector; });
+    return ans;
+}
+
+/**
+* * operator overload
+* @param other matrix to multiply with
+* @return result Matrix
+*/
+template<size_t R, size_t C, typename T>
+template<size_t K>
+constexpr Matrix<R, K, T> Matrix<R, C, T>::operator*(const Matrix<C, K, T> &other) const
+{
+    INSTRUMENT_CALL("Matrix::operator*(Matrix)");
+    //every row of the product is a combination of the rows of other, so no column is extracted
+    Matrix<R, K, T> ans;
+    unroll<R>([&](size_t i) {
+        Vector<K, T> &row = ans[(int) i];
+        unroll<C>([&](size_t k) { row += other[(int) k] * _rows[i].data()[k]; });
+    });
+    return ans;
+}
+
+/**
+* *= operator overload
+* @param other matrix to multiply with
+* @return reference to this matrix
+*/
+template<size_t R, size_t C, typename T>
+constexpr Matrix<R, C, T> &Matrix<R, C, T>::operator*=(const Matrix<C, C, T> &other)
+{
+    return *this = *this * other;
+}
+
+/**
+* *= operator overload
+* @param scalar to multiply with - each of the elements with that that scalar
+* @return reference to this matrix
+*/
+template<size_t R, size_t C, typename T>
+constexpr Matrix<R, C, T> &Matrix<R, C, T>::operator*=(const T scalar)
+{
+    unroll<R>([&](size_t i) { _rows[i] *= scalar; });
+    return *this;
+}
+
+/**
+* /= operator overload
+* @param scalar to divide with - each of the elements with that that scalar
+* @return reference to this matrix
+*/
+template<size_t R, size_t C, typename T>
+constexpr Matrix<R, C, T> &Matrix<R, C, T>::operator/=(const T scalar)
+{
+    if (error_if(scalar == 0))
+    {
+        report_error(ERROR_ZERO);
+        return *this;
+    }
+    return *this *= (1 / scalar);
+}
+
+/**
+*[] operator overload. the index is checked according to BOUNDS_CHECK (see Bounds.h).
+* @param i index of row to approach to
+* @return the i'th row of the matrix
+*/
+template<size_t R, size_t C, typename T>
+constexpr typename Matrix<R, C, T>::row_type &Matrix<R, C, T>::operator[](const int i)
+{
+    return _rows[checked_index<R>(i)];
+}
+
+/**
+*[] const operator overload. the index is checked according to BOUNDS_CHECK (see Bounds.h).
+* @param i index of row to approach to
+* @return the i'th row of the matrix
+*/
+template<size_t R, size_t C, typename T>
+constexpr const typename Matrix<R, C, T>::row_type &Matrix<R, C, T>::operator[](const int i) const
+{
+    return _rows[checked_index<R>(i)];
+}
+
+// ------------------ Other methods ------------------------
+
+/**
+* returns the i row of the matrix. the index is checked according to BOUNDS_CHECK (see Bounds.h).
+* @param index of row to return
+* @return row_type
+*/
+template<size_t R, size_t C, typename T>
+constexpr typename Matrix<R, C, T>::row_type Matrix<R, C, T>::row(const short index) const
+{
+    return (*this)[index];
+}
+
+/**
+* returns the i column of the matrix. the index is checked according to BOUNDS_CHECK (see Bounds.h).
+* @param index of column to return
+* @return column_type
+*/
+template<size_t R, size_t C, typename T>
+constexpr typename Matrix<R, C, T>::column_type Matrix<R, C, T>::column(const short index) const
+{
+    size_t j = checked_index<C>(index);
+    column_type ans;
+    unroll<R>([&](size_t i) { ans.data()[i] = _rows[i].data()[j]; });
+    return ans;
+}
+
+/**
+* gives the transposed matrix.
+* @return transpose
+*/
+template<size_t R, size_t C, typename T>
+constexpr Matrix<C, R, T> Matrix<R, C, T>::transpose() const
+{
+    Matrix<C, R, T> ans;
+    unroll<R>([&](size_t i) {
+        unroll<C>([&](size_t j) { ans[(int) j].data()[i] = _rows[i].data()[j]; });
+    });
+    return ans;
+}
+
+/**
+* gives the trace of the matrix. square matrices only.
+* @return trace
+*/
+template<size_t R, size_t C, typename T>
+constexpr T Matrix<R, C, T>::trace() const
+{
+    static_assert(R == C, "trace of a non square matrix");
+    //trace algorithm
+    T ans = 0;
+    unroll<R>([&](size_t i) { ans += _rows[i][(int) i]; });
+    return ans;
+}
+
+/**
+* gives the determinant of the matrix. square matrices only.
+* @return determinant
+*/
+template<size_t R, size_t C, typename T>
+constexpr T Matrix<R, C, T>::determinant() const
+{
+    INSTRUMENT_CALL("Matrix::determinant");
+    static_assert(R == C, "determinant of a non square matrix");
+    const Matrix &m = *this;
+    //determinant algorithm
+    if constexpr (R == 1)
+    {
+        return m[0][0];
+    }
+    else if constexpr (R == 2)
+    {
+        return m[0][0] * m[1][1] - m[0][1] * m[1][0];
+    }
+    else if constexpr (R == 3)
+    {
+        return m[0][0] * (m[1][1] * m[2][2] - m[2][1] * m[1][2])
+               - m[1][0] * (m[0][1] * m[2][2] - m[2][1] * m[0][2])
+               + m[2][0] * (m[0][1] * m[1][2] - m[1][1] * m[0][2]);
+    }
+    else
+    {
+        // laplace expansion along the first row
+        T ans = 0;
+        unroll<C>([&](size_t j) {
+            T cofactor = m[0][(int) j] * submatrix(0, j).determinant();
+            ans += (j % 2 == 0) ? cofactor : - cofactor;
+        });
+        return ans;
+    }
+}
+
+/**
+* checks if the matrix is singular relative to its scale: |det| <= tolerance * |row 0| * ... * |row R-1|.
+* @param tolerance relative to the product of the row norms
+* @return true if singular
+*/
+template<size_t R, size_t C, typename T>
+constexpr bool Matrix<R, C, T>::is_singular(const T tolerance) const
+{
+    static_assert(R == C, "singularity of a non square matrix");
+    return singular(determinant(), tolerance);
+}
+
+/**
+* gives the inverse of the matrix, the adjugate divided by the determinant. square matrices only.
+* @param tolerance of the singularity test
+* @return inverse
+*/
+template<size_t R, size_t C, typename T>
+constexpr Matrix<R, C, T> Matrix<R, C, T>::inverse(const T tolerance) const
+{
+    static_assert(R == C, "inverse of a non square matrix");
+    T det = determinant();
+    if (error_if(singular(det, tolerance)))
+    {
+        report_error(ERROR_SINGULAR);
+        return Matrix();
+    }
+    Matrix ans;
+    if constexpr (R == 1)
+    {
+        ans._rows[0].data()[0] = 1 / det;
+    }
+    else if constexpr (R == 3)
+    {
+        // the columns of the adjugate are the cross products of the rows
+        T scale = 1 / det;
+        const row_type c0 = cross(_rows[1], _rows[2]) * scale;
+        const row_type c1 = cross(_rows[2], _rows[0]) * scale;
+        const row_type c2 = cross(_rows[0], _rows[1]) * scale;
+        unroll<3>([&](size_t i) { ans._rows[i] = row_type(c0.data()[i], c1.data()[i], c2.data()[i]); });
+    }
+    else
+    {
+        // the transposed matrix of the cofactors
+        T scale = 1 / det;
+        unroll<R>([&](size_t i) {
+            unroll<C>([&](size_t j) {
+                T minor = submatrix(i, j).determinant();
+                ans._rows[j].data()[i] = ((i + j) % 2 == 0 ? minor : - minor) * scale;
+            });
+        });
+    }
+    return ans;
+}
+
+/**
+* returns the matrix without one row and one column.
+* @param row index of the row to drop
+* @param col index of the column to drop
+* @return the submatrix
+*/
+template<size_t R, size_t C, typename T>
+constexpr Matrix<R - 1, C - 1, T> Matrix<R, C, T>::submatrix(const size_t row, const size_t col) const
+{
+    Matrix<R - 1, C - 1, T> ans;
+    for (size_t i = 0, k = 0; i < R; ++ i)
+    {
+        if (i == row)
+        {
+            continue;
+        }
+        for (size_t j = 0, l = 0; j < C; ++ j)
+        {
+            if (j != col)
+            {
+                ans[(int) k][(int) l ++] = _rows[i][(int) j];
+            }
+        }
+        ++ k;
+    }
+    return ans;
+}
+
+/**
+* the singularity test of a known determinant.
+* @param det determinant of the matrix
+* @param tolerance relative to the product of the row norms
+* @return true if singular
+*/
+template<size_t R, size_t C, typename T>
+constexpr bool Matrix<R, C, T>::singular(const T det, const T tolerance) const
+{
+    // squared on both sides, so no square root is taken
+    T bound = tolerance * tolerance;
+    unroll<R>([&](size_t i) { bound *= _rows[i].norm_squared(); });
+    return ! (det * det > bound);
+}
+
+// ------------------ Free functions ------------------------
+
+/**
+* solves matrix * x = b. reports an error and returns the zero vector if the matrix is singular
+* (see Matrix::is_singular).
+* @param matrix square matrix of the system
+* @param b right hand side
+* @param tolerance of the singularity test
+* @return x
+*/
+template<size_t N, typename T>
+constexpr Vector<N, T> solve(const Matrix<N, N, T> &matrix, const Vector<N, T> &b,
+                             const typename Vector<N, T>::value_type tolerance = SINGULAR_TOLERANCE)
+{
+    // the singular case gives the zero matrix, so the zero vector
+    return matrix.inverse(tolerance) * b;
+}
+
+/**
+* << operator overload, to send data of the matrix to out-stream.
+* @param os out-stream
+* @param matrix to print
+* @return out stream with matrix
+*/
+template<size_t R, size_t C, typename T>
+ostream &operator<<(ostream &os, const Matrix<R, C, T> &matrix)
+{
+    INSTRUMENT_SCOPE("operator<<(Matrix)");
+    for (int i = 0; i < (int) R; ++ i)
+    {
+        if (i != 0)
+        {
+            os << endl;
+        }
+        os << matrix[i];
+    }
+    return os;
+}
+
+/**
+* >> operator overload, to receive data of matrix from in stream.
+* @param is in-stream
+* @param matrix to receive data into
+* @return in stream
+*/
+template<size_t R, size_t C, typename T>
+istream &operator>>(istream &is, Matrix<R, C, T> &matrix)
+{
+    INSTRUMENT_SCOPE("operator>>(Matrix)");
+    for (int i = 0; i < (int) R; ++ i)
+    {
+        is >> matrix[i];
+    }
+    return is;
+}
+
+#endif //EX1_MATRIX_H
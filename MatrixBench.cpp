@@ -0,0 +1,192 @@
+// Created by liorP.
+//
+
+#include <sstream>
+#include "BenchData.h"
+#include "Benchmark.h"
+
+// the arithmetic is constexpr, so it can be folded away entirely at compile time.
+static_assert(Matrix3D(2.0).determinant() == 8, "constexpr determinant");
+static_assert((Matrix3D(2.0) * Vector3D(1, 2, 3))[2] == 6, "constexpr matrix * vector");
+
+/**
+ * number of matrices in the arrays of the throughput benchmarks.
+ */
+#define MATRICES (BENCH_ARRAY / 8)
+
+// --------------------------------------------------------------------------------------
+// Micro benchmarks of every operator of Matrix3D.
+// "latency" runs a chain of BENCH_CHAIN dependent ops, "throughput" runs the op over
+// arrays of MATRICES matrices.
+// --------------------------------------------------------------------------------------
+
+/**
+ * @return a rotation, so chains of products neither overflow nor vanish
+ */
+static Matrix3D rotation()
+{
+    const double c = cos(0.1), s = sin(0.1);
+    return Matrix3D(c, - s, 0, s, c, 0, 0, 0, 1);
+}
+
+/**
+ * times a chain of dependent ops on a single matrix.
+ * @param bench to measure with
+ * @param name of the op
+ * @param op changes the matrix it gets, so the next op depends on it
+ */
+template<typename Op>
+static void latency(Bench &bench, const string &name, Op op)
+{
+    Matrix3D acc = rotation();
+    bench.measure(name + "/latency", BENCH_CHAIN, [&]() {
+        for (int i = 0; i < BENCH_CHAIN; ++ i)
+        {
+            op(acc);
+        }
+        keep(acc);
+    });
+}
+
+/**
+ * times an op over all the indices of the benchmark arrays.
+ * @param bench to measure with
+ * @param name of the op
+ * @param op called with every index
+ */
+template<typename Op>
+static void throughput(Bench &bench, const string &name, Op op)
+{
+    bench.measure(name + "/throughput", MATRICES, [&]() {
+        for (size_t i = 0; i < MATRICES; ++ i)
+        {
+            op(i);
+        }
+    });
+}
+
+/**
+ * benchmarks the constructors, assignment and element access.
+ * @param bench to measure with
+ */
+static void matrixBasics(Bench &bench)
+{
+    vector<Matrix3D> matrices = bench_matrices(MATRICES), out(MATRICES);
+    vector<Vector3D> points = bench_points(MATRICES), rows(MATRICES);
+    vector<double> scalars(MATRICES * 9 + 9);
+    const double (*grid)[3] = reinterpret_cast<const double (*)[3]>(scalars.data());
+    throughput(bench, "Matrix3D(v, v, v)", [&](size_t i) {
+        out[i] = Matrix3D(points[i], points[i], points[i]);
+        keep(out[i]);
+    });
+    throughput(bench, "Matrix3D(double)", [&](size_t i) { out[i] = Matrix3D(scalars[i]); keep(out[i]); });
+    throughput(bench, "Matrix3D(double x 9)", [&](size_t i) {
+        out[i] = Matrix3D(scalars[i], 0, 0, 0, scalars[i], 0, 0, 0, 1);
+        keep(out[i]);
+    });
+    throughput(bench, "Matrix3D(double[9])", [&](size_t i) {
+        out[i] = Matrix3D(scalars.data() + 9 * i);
+        keep(out[i]);
+    });
+    throughput(bench, "Matrix3D(double[3][3])", [&](size_t i) { out[i] = Matrix3D(grid + 3 * i); keep(out[i]); });
+    throughput(bench, "Matrix3D(const Matrix3D &)", [&](size_t i) {
+        Matrix3D copy(matrices[i]);
+        keep(copy);
+    });
+    throughput(bench, "Matrix3D::operator=", [&](size_t i) { out[i] = matrices[i]; keep(out[i]); });
+    throughput(bench, "Matrix3D::operator[]", [&](size_t i) { out[i][(int) (i % 3)] = points[i]; });
+    throughput(bench, "Matrix3D::operator[] const", [&](size_t i) {
+        const Matrix3D &matrix = matrices[i];
+        rows[i] = matrix[(int) (i % 3)];
+    });
+    throughput(bench, "Matrix3D::row", [&](size_t i) { rows[i] = matrices[i].row((short) (i % 3)); });
+    throughput(bench, "Matrix3D::column", [&](size_t i) { rows[i] = matrices[i].column((short) (i % 3)); });
+    keep(rows);
+}
+
+BENCHMARK(matrixBasics);
+
+/**
+ * benchmarks the arithmetic operators.
+ * @param bench to measure with
+ */
+static void matrixArithmetic(Bench &bench)
+{
+    vector<Matrix3D> matrices = bench_matrices(MATRICES), others = bench_matrices(MATRICES, 2), out(MATRICES);
+    vector<Vector3D> points = bench_points(MATRICES), results(MATRICES);
+    const Matrix3D turn = rotation(), small(0.001);
+    latency(bench, "Matrix3D::operator+", [&](Matrix3D &m) { m = m + small; });
+    throughput(bench, "Matrix3D::operator+", [&](size_t i) { out[i] = matrices[i] + others[i]; });
+    latency(bench, "Matrix3D::operator-", [&](Matrix3D &m) { m = m - small; });
+    throughput(bench, "Matrix3D::operator-", [&](size_t i) { out[i] = matrices[i] - others[i]; });
+    latency(bench, "Matrix3D::operator+=", [&](Matrix3D &m) { m += small; });
+    throughput(bench, "Matrix3D::operator+=", [&](size_t i) { out[i] += matrices[i]; });
+    latency(bench, "Matrix3D::operator-=", [&](Matrix3D &m) { m -= small; });
+    throughput(bench, "Matrix3D::operator-=", [&](size_t i) { out[i] -= matrices[i]; });
+    latency(bench, "Matrix3D::operator*(v)", [&](Matrix3D &m) { m[0] = turn * m[0]; });
+    throughput(bench, "Matrix3D::operator*(v)", [&](size_t i) { results[i] = matrices[i] * points[i]; });
+    latency(bench, "Matrix3D::operator*(m)", [&](Matrix3D &m) { m = m * turn; });
+    throughput(bench, "Matrix3D::operator*(m)", [&](size_t i) { out[i] = matrices[i] * others[i]; });
+    latency(bench, "Matrix3D::operator*=(m)", [&](Matrix3D &m) { m *= turn; });
+    throughput(bench, "Matrix3D::operator*=(m)", [&](size_t i) { out[i] *= others[i]; });
+    latency(bench, "Matrix3D::operator*=(d)", [](Matrix3D &m) { m *= - 1.0; });
+    throughput(bench, "Matrix3D::operator*=(d)", [&](size_t i) { out[i] *= - 1.0; });
+    latency(bench, "Matrix3D::operator/=", [](Matrix3D &m) { m /= - 1.0; });
+    throughput(bench, "Matrix3D::operator/=", [&](size_t i) { out[i] /= - 1.0; });
+    keep(out);
+    keep(results);
+}
+
+BENCHMARK(matrixArithmetic);
+
+/**
+ * benchmarks trace and determinant.
+ * @param bench to measure with
+ */
+static void matrixMetrics(Bench &bench)
+{
+    vector<Matrix3D> matrices = bench_matrices(MATRICES);
+    vector<double> scalars(MATRICES);
+    latency(bench, "Matrix3D::trace", [](Matrix3D &m) { m[1][1] = m.trace() * 0.5; });
+    throughput(bench, "Matrix3D::trace", [&](size_t i) { scalars[i] = matrices[i].trace(); });
+    latency(bench, "Matrix3D::determinant", [](Matrix3D &m) { m[1][1] = m.determinant(); });
+    throughput(bench, "Matrix3D::determinant", [&](size_t i) { scalars[i] = matrices[i].determinant(); });
+    keep(scalars);
+}
+
+BENCHMARK(matrixMetrics);
+
+/**
+ * benchmarks the stream operators.
+ * @param bench to measure with
+ */
+static void matrixStreams(Bench &bench)
+{
+    const size_t count = MATRICES / 8;
+    vector<Matrix3D> matrices = bench_matrices(count);
+    bench.measure("operator<<(ostream, Matrix3D)/throughput", count, [&]() {
+        ostringstream os;
+        for (const Matrix3D &matrix : matrices)
+        {
+            os << matrix << '\n';
+        }
+        keep(os);
+    });
+    ostringstream text;
+    for (const Matrix3D &matrix : matrices)
+    {
+        text << matrix << '\n';
+    }
+    const string input = text.str();
+    bench.measure("operator>>(istream, Matrix3D)/throughput", count, [&]() {
+        istringstream is(input);
+        Matrix3D matrix;
+        for (size_t i = 0; i < count; ++ i)
+        {
+            is >> matrix;
+        }
+        keep(matrix);
+    });
+}
+
+BENCHMARK(matrixStreams);
@@ -0,0 +1,150 @@
+// Created by liorP.
+//
+
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "Vector3DArray.h"
+
+// --------------------------------------------------------------------------------------
+// Benchmarks of the norm / distance family against the implementation it replaced, which
+// built a zero vector and a temporary difference and summed pow(x, 2).
+// Every fast path is first checked against the old one: the largest relative error over
+// points spread across 200 orders of magnitude is recorded with it (max_error).
+// --------------------------------------------------------------------------------------
+
+/**
+ * the old Vector3D::operator|
+ * @param a first vector
+ * @param b second vector
+ * @return distance
+ */
+static double legacyDist(const Vector3D &a, const Vector3D &b)
+{
+    Vector3D temp = a + b * (- 1);
+    double sum = 0;
+    for (int i = 0; i < 3; ++ i)
+    {
+        sum += pow(temp[i], 2);
+    }
+    return sqrt(sum);
+}
+
+/**
+ * the old Vector3D::norm
+ * @param a vector
+ * @return norm
+ */
+static double legacyNorm(const Vector3D &a)
+{
+    return legacyDist(Vector3D(), a);
+}
+
+/**
+ * @param count number of points
+ * @param seed of the points
+ * @return points scaled by 1e-100, 1 and 1e100 in turn
+ */
+static vector<Vector3D> spreadPoints(size_t count, unsigned seed)
+{
+    vector<Vector3D> points = bench_points(count, seed);
+    const double scales[] = {1e-100, 1, 1e100};
+    for (size_t i = 0; i < count; ++ i)
+    {
+        points[i] *= scales[i % 3];
+    }
+    return points;
+}
+
+/**
+ * benchmarks norm, dist and their squared forms against the old implementation.
+ * @param bench to measure with
+ */
+static void normFamily(Bench &bench)
+{
+    vector<Vector3D> points = bench_points(BENCH_ARRAY), others = bench_points(BENCH_ARRAY, 2);
+    vector<Vector3D> spread = spreadPoints(BENCH_ARRAY, 1), spreadOthers = spreadPoints(BENCH_ARRAY, 2);
+    vector<double> scalars(BENCH_ARRAY);
+    double normError = 0, distError = 0;
+    for (size_t i = 0; i < BENCH_ARRAY; ++ i)
+    {
+        double expected = legacyNorm(spread[i]);
+        normError = max(normError, fabs(spread[i].norm() - expected) / expected);
+        expected = legacyDist(spread[i], spreadOthers[i]);
+        distError = max(distError, fabs(spread[i].dist(spreadOthers[i]) - expected) / expected);
+    }
+    bench.measure("old norm", BENCH_ARRAY, [&]() {
+        for (size_t i = 0; i < BENCH_ARRAY; ++ i)
+        {
+            scalars[i] = legacyNorm(points[i]);
+        }
+        keep(scalars);
+    });
+    bench.measure("Vector3D::norm", BENCH_ARRAY, [&]() {
+        for (size_t i = 0; i < BENCH_ARRAY; ++ i)
+        {
+            scalars[i] = points[i].norm();
+        }
+        keep(scalars);
+    }).max_error = normError;
+    bench.measure("Vector3D::norm_squared", BENCH_ARRAY, [&]() {
+        for (size_t i = 0; i < BENCH_ARRAY; ++ i)
+        {
+            scalars[i] = points[i].norm_squared();
+        }
+        keep(scalars);
+    });
+    bench.measure("old dist", BENCH_ARRAY, [&]() {
+        for (size_t i = 0; i < BENCH_ARRAY; ++ i)
+        {
+            scalars[i] = legacyDist(points[i], others[i]);
+        }
+        keep(scalars);
+    });
+    bench.measure("Vector3D::dist", BENCH_ARRAY, [&]() {
+        for (size_t i = 0; i < BENCH_ARRAY; ++ i)
+        {
+            scalars[i] = points[i].dist(others[i]);
+        }
+        keep(scalars);
+    }).max_error = distError;
+    bench.measure("Vector3D::dist_squared", BENCH_ARRAY, [&]() {
+        for (size_t i = 0; i < BENCH_ARRAY; ++ i)
+        {
+            scalars[i] = points[i].dist_squared(others[i]);
+        }
+        keep(scalars);
+    });
+}
+
+BENCHMARK(normFamily);
+
+/**
+ * benchmarks batch_normalize against dividing every vector by its norm.
+ * @param bench to measure with
+ */
+static void normalize(Bench &bench)
+{
+    vector<Vector3D> points = bench_points(BENCH_ARRAY), out(BENCH_ARRAY);
+    vector<Vector3D> spread = spreadPoints(BENCH_ARRAY, 1);
+    Vector3DArray a(points), result(BENCH_ARRAY), spreadArray(spread);
+    batch_normalize(spreadArray, result);
+    double error = 0;
+    for (size_t i = 0; i < BENCH_ARRAY; ++ i)
+    {
+        Vector3D expected = spread[i] / legacyNorm(spread[i]);
+        error = max(error, (result[i] - expected).norm());
+    }
+    bench.measure("loop v / v.norm()", BENCH_ARRAY, [&]() {
+        for (size_t i = 0; i < BENCH_ARRAY; ++ i)
+        {
+            out[i] = points[i] / points[i].norm();
+        }
+        keep(out);
+    });
+    bench.measure("batch_normalize", BENCH_ARRAY, [&]() {
+        batch_normalize(a, result);
+        keep(result);
+    }).max_error = error;
+}
+
+BENCHMARK(normalize);
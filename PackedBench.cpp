@@ -0,0 +1,99 @@
+// Created by liorP.
+//
+
+#include <sstream>
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "PackedPoints.h"
+#include "Parallel.h"
+
+/**
+ * number of points of the packed benchmarks, well past the last level cache.
+ */
+#define PACKED_POINTS (BENCH_ARRAY * 8)
+
+// --------------------------------------------------------------------------------------
+// The memory bound sum and transform passes over points uniform in [-100, 100)^3, stored as
+// Vector3D and in every PackedPoints encoding: the bytes a point takes, the largest error
+// of the decoded points against the given ones (max_error, next to the bound of the
+// encoding), the encoding, and the passes decoding a block at a time.
+// --------------------------------------------------------------------------------------
+
+/**
+ * @param packing an encoding
+ * @return its name
+ */
+static string packingName(Packing packing)
+{
+    switch (packing)
+    {
+        case Packing::FLOAT32:
+            return "FLOAT32";
+        case Packing::FLOAT16:
+            return "FLOAT16";
+        case Packing::FIXED16:
+            return "FIXED16";
+    }
+    return "";
+}
+
+/**
+ * @param points the given points
+ * @param packed the same points encoded
+ * @return the largest |decoded - given| of a coordinate
+ */
+static double maxError(const vector<Vector3D> &points, const PackedPoints &packed)
+{
+    double ans = 0;
+    vector<Vector3D> block(PACKED_BLOCK);
+    for (size_t first = 0; first < points.size(); first += PACKED_BLOCK)
+    {
+        size_t n = min((size_t) PACKED_BLOCK, points.size() - first);
+        packed.decode(first, Span<Vector3D>(block.data(), n));
+        for (size_t i = 0; i < n; ++ i)
+        {
+            for (int axis = 0; axis < 3; ++ axis)
+            {
+                ans = max(ans, abs(block[i][axis] - points[first + i][axis]));
+            }
+        }
+    }
+    return ans;
+}
+
+/**
+ * benchmarks the passes over Vector3D and over every encoding.
+ * @param bench to measure with
+ */
+static void packedStreams(Bench &bench)
+{
+    const vector<Vector3D> points = bench_points(PACKED_POINTS);
+    const Matrix3D matrix = bench_matrices(1)[0];
+    vector<Vector3D> out(PACKED_POINTS);
+    const string plain = " (" + to_string(sizeof(Vector3D)) + " B/point)";
+    bench.measure("parallel_sum Vector3D" + plain, points.size(), [&]() { keep(parallel_sum(points)); });
+    bench.measure("parallel_transform Vector3D" + plain, points.size(), [&]() {
+        parallel_transform(matrix, points, out);
+        keep(out);
+    });
+    for (Packing packing : {Packing::FLOAT32, Packing::FLOAT16, Packing::FIXED16})
+    {
+        const string name = packingName(packing);
+        bench.measure("PackedPoints encode " + name, points.size(), [&]() {
+            keep(PackedPoints(points, packing).size());
+        });
+        const PackedPoints packed(points, packing);
+        ostringstream bytes;
+        bytes << " (" << (double) packed.bytes() / (double) packed.size() << " B/point, bound "
+              << packed.error_bound() << ")";
+        bench.measure("parallel_sum " + name + bytes.str(), points.size(), [&]() {
+            keep(parallel_sum(packed));
+        }).max_error = maxError(points, packed);
+        bench.measure("parallel_transform " + name, points.size(), [&]() {
+            parallel_transform(matrix, packed, out);
+            keep(out);
+        });
+    }
+}
+
+BENCHMARK(packedStreams);
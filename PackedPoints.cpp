@@ -0,0 +1,403 @@
+// Created by liorP.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <type_traits>
+#include "PackedPoints.h"
+#include "Parallel.h"
+#include "Transform.h"
+
+#if defined(__AVX__) || defined(__F16C__)
+#include <immintrin.h>
+#endif
+
+#define SIZE_ERROR "Input and output sizes differ"
+#define RANGE_ERROR "Range out of the packed points"
+#define HALF_ERROR "Coordinates out of the half precision range were clamped"
+
+/**
+ * the largest half precision number.
+ */
+#define HALF_MAX 65504.0
+
+/**
+ * the largest FIXED16 level.
+ */
+#define LEVEL_MAX 65535
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the PackedPoints encodings and batch kernels.
+// --------------------------------------------------------------------------------------
+
+static_assert(sizeof(Vector3D) == 3 * sizeof(double) && is_standard_layout<Vector3D>::value,
+              "the kernels read Vector3D arrays as interleaved doubles");
+
+namespace
+{
+/**
+ * @param value a float
+ * @return the nearest half precision number, as its bits
+ */
+inline uint16_t halfBits(const float value)
+{
+#ifdef __F16C__
+    return (uint16_t) _cvtss_sh(value, _MM_FROUND_TO_NEAREST_INT);
+#else
+    uint32_t x;
+    memcpy(&x, &value, sizeof(x));
+    const uint16_t sign = (uint16_t) ((x >> 16) & 0x8000);
+    const uint32_t magnitude = x & 0x7fffffff;
+    if (magnitude >= 0x47800000)
+    {
+        // 2^16 and up: infinity, or a quiet NaN
+        return (uint16_t) (sign | (magnitude > 0x7f800000 ? 0x7e00 : 0x7c00));
+    }
+    if (magnitude < 0x38800000)
+    {
+        // below 2^-14: a subnormal, a multiple of 2^-24 rounded to nearest even
+        float scaled;
+        memcpy(&scaled, &magnitude, sizeof(scaled));
+        return (uint16_t) (sign | (uint16_t) lrintf(scaled * 16777216.0f));
+    }
+    // rebiases the exponent and rounds the 13 dropped bits to nearest even, a carry may
+    // bump the exponent, up to infinity
+    uint32_t bits = magnitude - 0x38000000;
+    bits += 0xfff + ((bits >> 13) & 1);
+    return (uint16_t) (sign | (bits >> 13));
+#endif
+}
+
+/**
+ * @param bits of a half precision number
+ * @return its value
+ */
+inline float halfValue(const uint16_t bits)
+{
+#ifdef __F16C__
+    return _cvtsh_ss(bits);
+#else
+    const uint32_t exponent = (bits >> 10) & 0x1f, mantissa = bits & 0x3ff;
+    float magnitude;
+    if (exponent == 0)
+    {
+        magnitude = (float) mantissa * 5.9604644775390625e-8f;
+    }
+    else if (exponent == 31)
+    {
+        magnitude = mantissa != 0 ? numeric_limits<float>::quiet_NaN() : numeric_limits<float>::infinity();
+    }
+    else
+    {
+        uint32_t x = ((exponent + 112) << 23) | (mantissa << 13);
+        memcpy(&magnitude, &x, sizeof(magnitude));
+    }
+    return bits & 0x8000 ? - magnitude : magnitude;
+#endif
+}
+
+/**
+ * converts floats to double, 8 at a time with AVX.
+ * @param in the floats
+ * @param out receives the values
+ * @param n number of floats
+ */
+inline void decodeFloats(const float *in, double *out, const size_t n)
+{
+    size_t i = 0;
+#ifdef __AVX__
+    for (; i + 8 <= n; i += 8)
+    {
+        _mm256_storeu_pd(out + i, _mm256_cvtps_pd(_mm_loadu_ps(in + i)));
+        _mm256_storeu_pd(out + i + 4, _mm256_cvtps_pd(_mm_loadu_ps(in + i + 4)));
+    }
+#endif
+    for (; i < n; ++ i)
+    {
+        out[i] = in[i];
+    }
+}
+
+/**
+ * converts half precision numbers to double, 8 at a time with F16C.
+ * @param in the bits of the numbers
+ * @param out receives the values
+ * @param n number of numbers
+ */
+inline void decodeHalves(const uint16_t *in, double *out, const size_t n)
+{
+    size_t i = 0;
+#ifdef __F16C__
+    for (; i + 8 <= n; i += 8)
+    {
+        __m256 f = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i)));
+        _mm256_storeu_pd(out + i, _mm256_cvtps_pd(_mm256_castps256_ps128(f)));
+        _mm256_storeu_pd(out + i + 4, _mm256_cvtps_pd(_mm256_extractf128_ps(f, 1)));
+    }
+#endif
+    for (; i < n; ++ i)
+    {
+        out[i] = halfValue(in[i]);
+    }
+}
+
+/**
+ * converts FIXED16 levels of interleaved coordinates to double. the loop runs over 24
+ * coordinates, 8 points, at a time with the per axis constants repeated, so it vectorizes
+ * like a loop without axes.
+ * @param in the levels, starting at an x coordinate
+ * @param out receives the values
+ * @param n number of coordinates, a multiple of 3
+ * @param lower the value of level 0 along every axis
+ * @param step distance between the levels along every axis
+ */
+inline void decodeLevels(const uint16_t *in, double *out, const size_t n, const Vector3D &lower,
+                         const Vector3D &step)
+{
+    double offsets[24], scales[24];
+    for (int i = 0; i < 24; ++ i)
+    {
+        offsets[i] = lower.data()[i % 3];
+        scales[i] = step.data()[i % 3];
+    }
+    size_t i = 0;
+    for (; i + 24 <= n; i += 24)
+    {
+        for (int j = 0; j < 24; ++ j)
+        {
+            out[i + j] = offsets[j] + in[i + j] * scales[j];
+        }
+    }
+    for (; i < n; ++ i)
+    {
+        out[i] = offsets[i % 3] + in[i] * scales[i % 3];
+    }
+}
+}
+
+/**
+* A constructor - encodes points.
+* @param points to encode
+* @param packing the encoding
+*/
+PackedPoints::PackedPoints(const Span<const Vector3D> points, const Packing packing) : _packing(packing),
+                                                                                        _size(points.size()),
+                                                                                        _step(), _error(0)
+{
+    if (points.empty())
+    {
+        return;
+    }
+    _bounds = Box3D(points);
+    double largest = 0;
+    for (int axis = 0; axis < 3; ++ axis)
+    {
+        largest = max(largest, max(abs(_bounds.lower()[axis]), abs(_bounds.upper()[axis])));
+    }
+    const double *in = reinterpret_cast<const double *>(points.data());
+    const size_t n = 3 * points.size();
+    switch (packing)
+    {
+        case Packing::FLOAT32:
+        {
+            _floats.resize(n);
+            parallel_for(n, PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++ i)
+                {
+                    _floats[i] = (float) in[i];
+                }
+            });
+            _error = ldexp(largest, - 24) + ldexp(1.0, - 150);
+            break;
+        }
+        case Packing::FLOAT16:
+        {
+            _levels.resize(n);
+            parallel_for(n, PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++ i)
+                {
+                    _levels[i] = halfBits((float) min(HALF_MAX, max(- HALF_MAX, in[i])));
+                }
+            });
+            _error = ldexp(largest, - 11) + ldexp(largest, - 24) + ldexp(1.0, - 25);
+            if (largest > HALF_MAX)
+            {
+                cerr << HALF_ERROR << endl;
+                _error = numeric_limits<double>::infinity();
+            }
+            break;
+        }
+        case Packing::FIXED16:
+        {
+            _levels.resize(n);
+            Vector3D inverse;
+            double widest = 0;
+            for (int axis = 0; axis < 3; ++ axis)
+            {
+                _step[axis] = _bounds.extent()[axis] / LEVEL_MAX;
+                inverse[axis] = _step[axis] > 0 ? 1 / _step[axis] : 0;
+                widest = max(widest, _step[axis]);
+            }
+            const double *lower = _bounds.lower().data(), *scale = inverse.data();
+            parallel_for(points.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++ i)
+                {
+                    for (int axis = 0; axis < 3; ++ axis)
+                    {
+                        double level = nearbyint((in[3 * i + axis] - lower[axis]) * scale[axis]);
+                        _levels[3 * i + axis] = (uint16_t) min((double) LEVEL_MAX, max(0.0, level));
+                    }
+                }
+            });
+            _error = widest / 2 + ldexp(largest, - 49);
+            break;
+        }
+    }
+}
+
+/**
+* [] operator overload, decodes a point.
+* @param i index of the point, below size()
+* @return the decoded point
+*/
+Vector3D PackedPoints::operator[](const size_t i) const
+{
+    Vector3D ans;
+    decode(i, Span<Vector3D>(&ans, 1));
+    return ans;
+}
+
+/**
+* decodes consecutive points.
+* @param begin index of the first point
+* @param out receives points [begin, begin + out.size()), which must be at most size()
+*/
+void PackedPoints::decode(const size_t begin, const Span<Vector3D> out) const
+{
+    if (begin > _size || out.size() > _size - begin)
+    {
+        cerr << RANGE_ERROR << endl;
+        return;
+    }
+    double *values = reinterpret_cast<double *>(out.data());
+    const size_t first = 3 * begin, n = 3 * out.size();
+    switch (_packing)
+    {
+        case Packing::FLOAT32:
+            decodeFloats(_floats.data() + first, values, n);
+            break;
+        case Packing::FLOAT16:
+            decodeHalves(_levels.data() + first, values, n);
+            break;
+        case Packing::FIXED16:
+            decodeLevels(_levels.data() + first, values, n, _bounds.lower(), _step);
+            break;
+    }
+}
+
+/**
+* @param begin index of the first point
+* @param end past the index of the last point, at most size()
+* @return the sum of the decoded points [begin, end)
+*/
+Vector3D PackedPoints::sum(const size_t begin, const size_t end) const
+{
+    if (begin > end || end > _size)
+    {
+        cerr << RANGE_ERROR << endl;
+        return Vector3D();
+    }
+    if (_packing == Packing::FIXED16)
+    {
+        // the decoding is linear, so the sum is the exact sum of the levels decoded once,
+        // accumulated 8 points at a time like decodeLevels
+        const uint16_t *levels = _levels.data() + 3 * begin;
+        const size_t n = 3 * (end - begin);
+        uint64_t sums[24] = {};
+        size_t i = 0;
+        for (; i + 24 <= n; i += 24)
+        {
+            for (int j = 0; j < 24; ++ j)
+            {
+                sums[j] += levels[i + j];
+            }
+        }
+        for (; i < n; ++ i)
+        {
+            sums[i % 3] += levels[i];
+        }
+        Vector3D ans;
+        for (int axis = 0; axis < 3; ++ axis)
+        {
+            uint64_t total = 0;
+            for (int j = axis; j < 24; j += 3)
+            {
+                total += sums[j];
+            }
+            ans[axis] = _bounds.lower()[axis] * (double) (end - begin) + _step[axis] * (double) total;
+        }
+        return ans;
+    }
+    Vector3D block[PACKED_BLOCK], ans;
+    for (size_t first = begin; first < end; first += PACKED_BLOCK)
+    {
+        size_t n = min((size_t) PACKED_BLOCK, end - first);
+        decode(first, Span<Vector3D>(block, n));
+        for (size_t i = 0; i < n; ++ i)
+        {
+            ans += block[i];
+        }
+    }
+    return ans;
+}
+
+/**
+* out[i] = matrix * points[i], decoding a block at a time, in parallel.
+* @param matrix to transform by
+* @param points to transform
+* @param out transformed points, same size as points
+*/
+void parallel_transform(const Matrix3D &matrix, const PackedPoints &points, const Span<Vector3D> out)
+{
+    INSTRUMENT_SCOPE("parallel_transform(PackedPoints)");
+    if (points.size() != out.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return;
+    }
+    parallel_for(points.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+        // a block is decoded into its place in out, and transformed there while in L1
+        for (size_t first = begin; first < end; first += PACKED_BLOCK)
+        {
+            Span<Vector3D> block = out.subspan(first, min((size_t) PACKED_BLOCK, end - first));
+            points.decode(first, block);
+            transform_batch(matrix, block);
+        }
+    });
+}
+
+/**
+* @param points vectors to add
+* @return the sum of the decoded points, computed in parallel
+*/
+Vector3D parallel_sum(const PackedPoints &points)
+{
+    INSTRUMENT_SCOPE("parallel_sum(PackedPoints)");
+    return parallel_reduce(points.size(), PARALLEL_GRAIN, Vector3D(), [&](size_t begin, size_t end) {
+        return points.sum(begin, end);
+    }, [](const Vector3D &a, const Vector3D &b) { return a + b; });
+}
+
+/**
+* @param points vectors to average
+* @return the centroid of the decoded points, the zero vector if there are none
+*/
+Vector3D parallel_centroid(const PackedPoints &points)
+{
+    if (points.size() == 0)
+    {
+        return Vector3D();
+    }
+    return parallel_sum(points) / (double) points.size();
+}
@@ -0,0 +1,139 @@
+// Created by liorP.
+//
+
+#ifndef EX1_PACKEDPOINTS_H
+#define EX1_PACKEDPOINTS_H
+
+#include <cstdint>
+#include <vector>
+#include "Box3D.h"
+#include "Matrix3D.h"
+
+// --------------------------------------------------------------------------------------
+// Compressed storage of Vector3D, for point sets that are streamed more than they are
+// edited. The coordinates are kept in one of 3 encodings, and the batch kernels decode
+// PACKED_BLOCK points at a time into an L1 resident buffer of Vector3D that the usual
+// kernels then run on, so a memory bound pass reads 12 or 6 bytes a point instead of 24.
+//   FLOAT32  12 B/point, |error| <= 2^-24 * max |coordinate| + 2^-150, the range of float.
+//   FLOAT16   6 B/point, |error| <= (2^-11 + 2^-24) * max |coordinate| + 2^-25, for
+//            coordinates of at most 65504 in magnitude (larger ones are clamped, with an
+//            error printed and an infinite bound).
+//   FIXED16   6 B/point, coordinates quantized to 65536 levels across the bounding box:
+//            |error| <= extent / 131070 + 2^-49 * max |coordinate| along every axis.
+// error_bound() evaluates the bound of the encoding for the points it holds. The half
+// precision conversions are the F16C instructions where available. The sum of FIXED16
+// points is the sum of their integer levels, exact and without decoding.
+// --------------------------------------------------------------------------------------
+
+/**
+ * number of points the batch kernels decode at a time.
+ */
+#define PACKED_BLOCK 256
+
+/**
+ * the encodings of PackedPoints.
+ */
+enum class Packing
+{
+    FLOAT32, /**< the coordinates as float. */
+    FLOAT16, /**< the coordinates as IEEE half precision. */
+    FIXED16 /**< the coordinates as 16 bit levels across the bounding box. */
+};
+
+/**
+ * A PackedPoints class.
+ * This class represents an immutable array of Vector3D in a compressed encoding.
+ */
+class PackedPoints
+{
+public:
+    /**
+     * A default constructor - no points.
+     */
+    PackedPoints() : _packing(Packing::FLOAT32), _size(0), _step(), _error(0) {}
+
+    /**
+     * A constructor - encodes points.
+     * @param points to encode
+     * @param packing the encoding
+     */
+    PackedPoints(Span<const Vector3D> points, Packing packing);
+
+    /**
+     * @return number of points
+     */
+    size_t size() const { return _size; }
+
+    /**
+     * @return the encoding
+     */
+    Packing packing() const { return _packing; }
+
+    /**
+     * @return bytes taken by the encoded coordinates
+     */
+    size_t bytes() const { return _floats.size() * sizeof(float) + _levels.size() * sizeof(uint16_t); }
+
+    /**
+     * @return bounding box of the points as given
+     */
+    const Box3D &bounds() const { return _bounds; }
+
+    /**
+     * @return bound on |decoded - given| of every coordinate of every point
+     */
+    double error_bound() const { return _error; }
+
+    /**
+     * [] operator overload, decodes a point.
+     * @param i index of the point, below size()
+     * @return the decoded point
+     */
+    Vector3D operator[](size_t i) const;
+
+    /**
+     * decodes consecutive points.
+     * @param begin index of the first point
+     * @param out receives points [begin, begin + out.size()), which must be at most size()
+     */
+    void decode(size_t begin, Span<Vector3D> out) const;
+
+    /**
+     * @param begin index of the first point
+     * @param end past the index of the last point, at most size()
+     * @return the sum of the decoded points [begin, end)
+     */
+    Vector3D sum(size_t begin, size_t end) const;
+
+private:
+    Packing _packing; /**< the encoding. */
+    size_t _size; /**< number of points. */
+    vector<float> _floats; /**< the coordinates of FLOAT32, interleaved. */
+    vector<uint16_t> _levels; /**< the coordinates of FLOAT16 and FIXED16, interleaved. */
+    Box3D _bounds; /**< bounding box of the points, the frame of FIXED16. */
+    Vector3D _step; /**< distance between the levels of FIXED16 along every axis. */
+    double _error; /**< the error bound. */
+
+};
+
+/**
+ * out[i] = matrix * points[i], decoding a block at a time, in parallel.
+ * @param matrix to transform by
+ * @param points to transform
+ * @param out transformed points, same size as points
+ */
+void parallel_transform(const Matrix3D &matrix, const PackedPoints &points, Span<Vector3D> out);
+
+/**
+ * @param points vectors to add
+ * @return the sum of the decoded points, computed in parallel
+ */
+Vector3D parallel_sum(const PackedPoints &points);
+
+/**
+ * @param points vectors to average
+ * @return the centroid of the decoded points, the zero vector if there are none
+ */
+Vector3D parallel_centroid(const PackedPoints &points);
+
+#endif //EX1_PACKEDPOINTS_H
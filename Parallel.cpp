@@ -0,0 +1,431 @@
+// Created by liorP.
+//
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include "Parallel.h"
+#include "Transform.h"
+
+#define SIZE_ERROR "Input and output sizes differ"
+
+// --------------------------------------------------------------------------------------
+// This file contains the thread pool behind the parallel layer, and the parallel ops.
+// --------------------------------------------------------------------------------------
+
+namespace
+{
+/**
+ * true on the threads of the pool, so nested parallel calls run serially.
+ */
+thread_local bool insidePool = false;
+
+/**
+ * An InsidePool class.
+ * This class sets insidePool for its lifetime, and restores it however the scope is left.
+ */
+class InsidePool
+{
+public:
+    /**
+     * A constructor - sets insidePool.
+     */
+    InsidePool() : _previous(insidePool) { insidePool = true; }
+
+    InsidePool(const InsidePool &) = delete;
+
+    InsidePool &operator=(const InsidePool &) = delete;
+
+    /**
+     * A destructor - restores insidePool.
+     */
+    ~InsidePool() { insidePool = _previous; }
+
+private:
+    bool _previous; /**< insidePool before the scope. */
+
+};
+
+/**
+ * A pool of persistent worker threads running one job at a time.
+ * A job is a number of chunks, claimed one by one from an atomic counter by the workers
+ * and by the thread that submitted it. The first exception a chunk throws, on any thread,
+ * cancels the chunks not claimed yet and is rethrown to the submitter once all the threads
+ * are done with the job.
+ */
+class ThreadPool
+{
+public:
+    /**
+     * A constructor - one thread per hardware thread.
+     */
+    ThreadPool() { start(thread::hardware_concurrency()); }
+
+    /**
+     * A destructor - stops and joins the workers.
+     */
+    ~ThreadPool() { stop(); }
+
+    /**
+     * restarts the pool with a new number of threads.
+     * @param threads number of threads including the caller, 0 for the hardware threads
+     */
+    void resize(unsigned threads)
+    {
+        lock_guard<mutex> submit(_submit);
+        stop();
+        start(threads == 0 ? thread::hardware_concurrency() : threads);
+    }
+
+    /**
+     * @return number of threads including the caller
+     */
+    unsigned size() const { return (unsigned) _workers.size() + 1; }
+
+    /**
+     * runs task(0) ... task(chunks - 1) on all the threads, returns when all are done.
+     * if a chunk throws, the chunks not started yet are skipped, and the first exception
+     * is rethrown here after all the threads are done.
+     * @param chunks number of chunks
+     * @param task called with the index of every chunk
+     */
+    void run(size_t chunks, const function<void(size_t)> &task)
+    {
+        lock_guard<mutex> submit(_submit);
+        {
+            lock_guard<mutex> lock(_lock);
+            _task = &task;
+            _chunks = chunks;
+            _next = 0;
+            _busy = _workers.size();
+            _error = nullptr;
+            ++ _generation;
+        }
+        _wake.notify_all();
+        {
+            const InsidePool inside;
+            drain();
+        }
+        exception_ptr error;
+        {
+            unique_lock<mutex> lock(_lock);
+            _done.wait(lock, [this]() { return _busy == 0; });
+            _task = nullptr;
+            swap(error, _error);
+        }
+        if (error)
+        {
+            rethrow_exception(error);
+        }
+    }
+
+private:
+    /**
+     * spawns the workers.
+     * @param threads number of threads including the caller
+     */
+    void start(unsigned threads)
+    {
+        _stop = false;
+        for (unsigned i = 1; i < max(threads, 1u); ++ i)
+        {
+            // the generation is read here, a worker may only get scheduled after the next job is posted
+            _workers.emplace_back([this, seen = _generation]() { work(seen); });
+        }
+    }
+
+    /**
+     * stops and joins the workers.
+     */
+    void stop()
+    {
+        {
+            lock_guard<mutex> lock(_lock);
+            _stop = true;
+        }
+        _wake.notify_all();
+        for (thread &worker : _workers)
+        {
+            worker.join();
+        }
+        _workers.clear();
+    }
+
+    /**
+     * claims and runs chunks of the current job until there are none left. never throws:
+     * the first exception of a chunk is kept for run(), and the chunks not claimed yet
+     * are cancelled.
+     */
+    void drain()
+    {
+        for (size_t chunk = _next.fetch_add(1); chunk < _chunks; chunk = _next.fetch_add(1))
+        {
+            try
+            {
+                (*_task)(chunk);
+            }
+            catch (...)
+            {
+                lock_guard<mutex> lock(_lock);
+                if (! _error)
+                {
+                    _error = current_exception();
+                }
+                _next = _chunks;
+            }
+        }
+    }
+
+    /**
+     * the loop of a worker thread.
+     * @param seen the last job generation before the worker was started
+     */
+    void work(uint64_t seen)
+    {
+        insidePool = true;
+        while (true)
+        {
+            {
+                unique_lock<mutex> lock(_lock);
+                _wake.wait(lock, [&]() { return _stop || _generation != seen; });
+                if (_stop)
+                {
+                    return;
+                }
+                seen = _generation;
+            }
+            drain();
+            lock_guard<mutex> lock(_lock);
+            if (-- _busy == 0)
+            {
+                _done.notify_one();
+            }
+        }
+    }
+
+    mutex _submit; /**< serializes jobs and resizes. */
+    mutex _lock; /**< guards the job state below. */
+    condition_variable _wake; /**< signals the workers of a new job or of stop. */
+    condition_variable _done; /**< signals the submitter that all the workers are done. */
+    vector<thread> _workers; /**< the worker threads. */
+    const function<void(size_t)> *_task = nullptr; /**< the task of the current job. */
+    size_t _chunks = 0; /**< number of chunks in the current job. */
+    atomic<size_t> _next{0}; /**< next chunk to claim. */
+    size_t _busy = 0; /**< workers that did not finish the current job yet. */
+    uint64_t _generation = 0; /**< counts the jobs, wakes the workers. */
+    exception_ptr _error; /**< the first exception of the current job, nullptr if none. */
+    bool _stop = false; /**< tells the workers to exit. */
+};
+
+/**
+ * @return the pool of the process
+ */
+ThreadPool &pool()
+{
+    static ThreadPool instance;
+    return instance;
+}
+
+/**
+ * An axis aligned bounding box, the value of the bounding box reduction.
+ */
+struct Bounds
+{
+    Vector3D lower; /**< per coordinate minimum. */
+    Vector3D upper; /**< per coordinate maximum. */
+};
+}
+
+// ------------------ Execution ------------------------
+
+/**
+* sets the number of threads the parallel calls use (the calling thread included).
+* @param threads number of threads, 0 for the number of hardware threads
+*/
+void set_parallelism(const unsigned threads)
+{
+    pool().resize(threads);
+}
+
+/**
+* @return the number of threads the parallel calls use
+*/
+unsigned parallelism()
+{
+    return pool().size();
+}
+
+/**
+* runs body over [0, count) in chunks of grain elements on all the threads.
+* calls made from inside a body run serially on the calling thread.
+* @param count number of elements
+* @param grain number of elements in a chunk
+* @param body called with the [begin, end) range of every chunk
+*/
+void parallel_for(const size_t count, size_t grain, const function<void(size_t, size_t)> &body)
+{
+    grain = max(grain, (size_t) 1);
+    size_t chunks = (count + grain - 1) / grain;
+    if (chunks <= 1 || insidePool || pool().size() == 1)
+    {
+        for (size_t begin = 0; begin < count; begin += grain)
+        {
+            body(begin, min(count, begin + grain));
+        }
+        return;
+    }
+    pool().run(chunks, [&](size_t chunk) {
+        body(chunk * grain, min(count, (chunk + 1) * grain));
+    });
+}
+
+// ------------------ Transform ------------------------
+
+/**
+* out[i] = matrix * in[i], in parallel.
+* @param matrix to multiply with
+* @param in points to transform
+* @param out transformed points, same size as in. may be the same range as in
+*/
+void parallel_transform(const Matrix3D &matrix, const Span<const Vector3D> in, const Span<Vector3D> out)
+{
+    INSTRUMENT_SCOPE("parallel_transform");
+    if (in.size() != out.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return;
+    }
+    parallel_for(in.size(), PARALLEL_GRAIN, [&](size_t begin, size_t end) {
+        transform_batch(matrix, in.subspan(begin, end - begin), out.subspan(begin, end - begin));
+    });
+}
+
+/**
+* out[i] = a[i] * b[i], in parallel.
+* @param a left matrices
+* @param b right matrices, same size as a
+* @param out the products, same size as a
+*/
+void parallel_multiply(const Span<const Matrix3D> a, const Span<const Matrix3D> b, const Span<Matrix3D> out)
+{
+    INSTRUMENT_SCOPE("parallel_multiply");
+    if (a.size() != b.size() || a.size() != out.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return;
+    }
+    parallel_for(a.size(), PARALLEL_GRAIN / 4, [&](size_t begin, size_t end) {
+        multiply_batch(a.subspan(begin, end - begin), b.subspan(begin, end - begin), out.subspan(begin, end - begin));
+    });
+}
+
+// ------------------ Reductions ------------------------
+
+/**
+* @param points vectors to sum
+* @return the sum of all the vectors
+*/
+Vector3D parallel_sum(const Span<const Vector3D> points)
+{
+    INSTRUMENT_SCOPE("parallel_sum");
+    return parallel_reduce(points.size(), PARALLEL_GRAIN, Vector3D(), [&](size_t begin, size_t end) {
+        Vector3D sum;
+        for (size_t i = begin; i < end; ++ i)
+        {
+            sum += points[i];
+        }
+        return sum;
+    }, [](const Vector3D &a, const Vector3D &b) { return a + b; });
+}
+
+/**
+* @param points vectors to average
+* @return the centroid of the vectors, the zero vector if there are none
+*/
+Vector3D parallel_centroid(const Span<const Vector3D> points)
+{
+    if (points.empty())
+    {
+        return Vector3D();
+    }
+    return parallel_sum(points) / (double) points.size();
+}
+
+/**
+* computes the axis aligned bounding box of the vectors.
+* with no vectors, lower is +inf and upper is -inf in every coordinate.
+* @param points vectors to bound
+* @param lower receives the per coordinate minimum
+* @param upper receives the per coordinate maximum
+*/
+void parallel_bounding_box(const Span<const Vector3D> points, Vector3D &lower, Vector3D &upper)
+{
+    INSTRUMENT_SCOPE("parallel_bounding_box");
+    const double inf = numeric_limits<double>::infinity();
+    const Bounds empty = {Vector3D(inf, inf, inf), Vector3D(- inf, - inf, - inf)};
+    auto merge = [](const Bounds &a, const Bounds &b) {
+        Bounds ans = a;
+        for (int axis = 0; axis < 3; ++ axis)
+        {
+            ans.lower[axis] = min(a.lower[axis], b.lower[axis]);
+            ans.upper[axis] = max(a.upper[axis], b.upper[axis]);
+        }
+        return ans;
+    };
+    Bounds bounds = parallel_reduce(points.size(), PARALLEL_GRAIN, empty, [&](size_t begin, size_t end) {
+        double lo[3] = {inf, inf, inf}, hi[3] = {- inf, - inf, - inf};
+        for (size_t i = begin; i < end; ++ i)
+        {
+            for (int axis = 0; axis < 3; ++ axis)
+            {
+                lo[axis] = min(lo[axis], points[i][axis]);
+                hi[axis] = max(hi[axis], points[i][axis]);
+            }
+        }
+        return Bounds{Vector3D(lo), Vector3D(hi)};
+    }, merge);
+    lower = bounds.lower;
+    upper = bounds.upper;
+}
+
+/**
+* @param points vectors to search
+* @return the smallest norm of the vectors, +inf if there are none
+*/
+double parallel_min_norm(const Span<const Vector3D> points)
+{
+    INSTRUMENT_SCOPE("parallel_min_norm");
+    const double inf = numeric_limits<double>::infinity();
+    // compared squared, a single sqrt at the end
+    double squared = parallel_reduce(points.size(), PARALLEL_GRAIN, inf, [&](size_t begin, size_t end) {
+        double best = inf;
+        for (size_t i = begin; i < end; ++ i)
+        {
+            best = min(best, points[i] * points[i]);
+        }
+        return best;
+    }, [](double a, double b) { return min(a, b); });
+    return sqrt(squared);
+}
+
+/**
+* @param points vectors to search
+* @return the largest norm of the vectors, 0 if there are none
+*/
+double parallel_max_norm(const Span<const Vector3D> points)
+{
+    INSTRUMENT_SCOPE("parallel_max_norm");
+    double squared = parallel_reduce(points.size(), PARALLEL_GRAIN, 0.0, [&](size_t begin, size_t end) {
+        double best = 0;
+        for (size_t i = begin; i < end; ++ i)
+        {
+            best = max(best, points[i] * points[i]);
+        }
+        return best;
+    }, [](double a, double b) { return max(a, b); });
+    return sqrt(squared);
+}
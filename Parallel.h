@@ -0,0 +1,126 @@
+// Created by liorP.
+//
+
+#ifndef EX1_PARALLEL_H
+#define EX1_PARALLEL_H
+
+#include <functional>
+#include <vector>
+#include "Matrix3D.h"
+#include "Span.h"
+
+// --------------------------------------------------------------------------------------
+// A parallel execution layer over the 3D types.
+// Work is cut into chunks of PARALLEL_GRAIN elements, and a persistent pool of threads
+// (the caller included) claim chunks one at a time from a shared counter, so a thread
+// that finishes early keeps taking work from the slower ones.
+// --------------------------------------------------------------------------------------
+
+/**
+ * default number of elements in a chunk.
+ */
+#define PARALLEL_GRAIN 16384
+
+/**
+ * sets the number of threads the parallel calls use (the calling thread included).
+ * @param threads number of threads, 0 for the number of hardware threads
+ */
+void set_parallelism(unsigned threads);
+
+/**
+ * @return the number of threads the parallel calls use
+ */
+unsigned parallelism();
+
+/**
+ * runs body over [0, count) in chunks of grain elements on all the threads.
+ * calls made from inside a body run serially on the calling thread.
+ * @param count number of elements
+ * @param grain number of elements in a chunk
+ * @param body called with the [begin, end) range of every chunk
+ */
+void parallel_for(size_t count, size_t grain, const function<void(size_t, size_t)> &body);
+
+/**
+ * a deterministic parallel reduction: every chunk is reduced on its own, and the chunk
+ * results are combined in order on the calling thread.
+ * @param count number of elements
+ * @param grain number of elements in a chunk
+ * @param identity the neutral value
+ * @param chunk reduces the [begin, end) range, returns T
+ * @param combine combines two T into one
+ * @return the reduction of all the elements
+ */
+template<typename T, typename Chunk, typename Combine>
+T parallel_reduce(size_t count, size_t grain, T identity, Chunk chunk, Combine combine)
+{
+    if (count == 0)
+    {
+        return identity;
+    }
+    vector<T> partial((count + grain - 1) / grain, identity);
+    parallel_for(count, grain, [&](size_t begin, size_t end) {
+        partial[begin / grain] = chunk(begin, end);
+    });
+    T ans = identity;
+    for (const T &value : partial)
+    {
+        ans = combine(ans, value);
+    }
+    return ans;
+}
+
+// ------------------ Transform ------------------------
+
+/**
+ * out[i] = matrix * in[i], in parallel.
+ * @param matrix to multiply with
+ * @param in points to transform
+ * @param out transformed points, same size as in. may be the same range as in
+ */
+void parallel_transform(const Matrix3D &matrix, Span<const Vector3D> in, Span<Vector3D> out);
+
+/**
+ * out[i] = a[i] * b[i], in parallel.
+ * @param a left matrices
+ * @param b right matrices, same size as a
+ * @param out the products, same size as a
+ */
+void parallel_multiply(Span<const Matrix3D> a, Span<const Matrix3D> b, Span<Matrix3D> out);
+
+// ------------------ Reductions ------------------------
+
+/**
+ * @param points vectors to sum
+ * @return the sum of all the vectors
+ */
+Vector3D parallel_sum(Span<const Vector3D> points);
+
+/**
+ * @param points vectors to average
+ * @return the centroid of the vectors, the zero vector if there are none
+ */
+Vector3D parallel_centroid(Span<const Vector3D> points);
+
+/**
+ * computes the axis aligned bounding box of the vectors.
+ * with no vectors, lower is +inf and upper is -inf in every coordinate.
+ * @param points vectors to bound
+ * @param lower receives the per coordinate minimum
+ * @param upper receives the per coordinate maximum
+ */
+void parallel_bounding_box(Span<const Vector3D> points, Vector3D &lower, Vector3D &upper);
+
+/**
+ * @param points vectors to search
+ * @return the smallest norm of the vectors, +inf if there are none
+ */
+double parallel_min_norm(Span<const Vector3D> points);
+
+/**
+ * @param points vectors to search
+ * @return the largest norm of the vectors, 0 if there are none
+ */
+double parallel_max_norm(Span<const Vector3D> points);
+
+#endif //EX1_PARALLEL_H
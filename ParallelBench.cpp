@@ -0,0 +1,72 @@
+// Created by liorP.
+//
+
+#include <thread>
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "Covariance.h"
+#include "Parallel.h"
+
+/**
+ * number of points of the parallel benchmarks.
+ */
+#define PARALLEL_POINTS (1 << 22)
+
+// --------------------------------------------------------------------------------------
+// Scaling of the parallel layer, from 1 thread up to all the hardware threads.
+// --------------------------------------------------------------------------------------
+
+/**
+ * @return 1, 2, 4 ... and the number of hardware threads
+ */
+static vector<unsigned> threadCounts()
+{
+    unsigned hardware = max(thread::hardware_concurrency(), 1u);
+    vector<unsigned> counts;
+    for (unsigned threads = 1; threads < hardware; threads *= 2)
+    {
+        counts.push_back(threads);
+    }
+    counts.push_back(hardware);
+    return counts;
+}
+
+/**
+ * benchmarks the parallel transform, reductions and products with every thread count.
+ * @param bench to measure with
+ */
+static void parallelScaling(Bench &bench)
+{
+    const Matrix3D m = bench_matrices(1)[0];
+    vector<Vector3D> points = bench_points(PARALLEL_POINTS), out(PARALLEL_POINTS);
+    vector<Matrix3D> matrices = bench_matrices(PARALLEL_POINTS / 8), products(PARALLEL_POINTS / 8);
+    for (unsigned threads : threadCounts())
+    {
+        set_parallelism(threads);
+        const string suffix = "/threads:" + to_string(threads);
+        bench.measure("parallel_transform" + suffix, points.size(), [&]() {
+            parallel_transform(m, points, out);
+            keep(out);
+        });
+        bench.measure("parallel_sum" + suffix, points.size(), [&]() { keep(parallel_sum(points)); });
+        bench.measure("parallel_centroid" + suffix, points.size(), [&]() { keep(parallel_centroid(points)); });
+        bench.measure("parallel_covariance" + suffix, points.size(), [&]() {
+            keep(parallel_covariance(points).covariance());
+        });
+        bench.measure("parallel_bounding_box" + suffix, points.size(), [&]() {
+            Vector3D lower, upper;
+            parallel_bounding_box(points, lower, upper);
+            keep(lower);
+            keep(upper);
+        });
+        bench.measure("parallel_min_norm" + suffix, points.size(), [&]() { keep(parallel_min_norm(points)); });
+        bench.measure("parallel_max_norm" + suffix, points.size(), [&]() { keep(parallel_max_norm(points)); });
+        bench.measure("parallel_multiply" + suffix, matrices.size(), [&]() {
+            parallel_multiply(matrices, matrices, products);
+            keep(products);
+        });
+    }
+    set_parallelism(0);
+}
+
+BENCHMARK(parallelScaling);
@@ -0,0 +1,238 @@
+// Created by liorP.
+//
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include "BulkIO.h"
+#include "Parallel.h"
+#include "Pipeline.h"
+#include "Transform.h"
+
+#define HEADER_ERROR "The binary input has a bad header"
+#define READ_ERROR "The binary input ends before the count of its header"
+#define WRITE_ERROR "Failed writing the text output"
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the class Pipeline, its sources and its sinks.
+// --------------------------------------------------------------------------------------
+
+/**
+* A constructor.
+* @param source the input
+* @param chunk number of points in a chunk
+*/
+Pipeline::Pipeline(PointSource source, const size_t chunk) : _source(move(source)), _chunk(max(chunk, (size_t) 1))
+{
+}
+
+/**
+* adds a stage.
+* @param stage to run on every chunk, after the stages added before it
+* @return reference to this pipeline
+*/
+Pipeline &Pipeline::stage(PointStage stage)
+{
+    _stages.push_back(move(stage));
+    return *this;
+}
+
+/**
+* adds a stage of point = matrix * point.
+* @param matrix to multiply with
+* @return reference to this pipeline
+*/
+Pipeline &Pipeline::transform(const Matrix3D &matrix)
+{
+    return stage([matrix](Span<Vector3D> chunk) {
+        transform_batch(matrix, chunk);
+        return chunk.size();
+    });
+}
+
+/**
+* runs the whole input through the stages into the sink.
+* an exception of the source, a stage or the sink stops the reader and is rethrown here.
+* @param sink called with every chunk that has points left
+* @return number of points that reached the sink
+*/
+size_t Pipeline::run(const PointSink &sink)
+{
+    // buffer b is either being filled by the reader (full[b] false) or waiting for / being
+    // processed by the caller (full[b] true). the two sides alternate between the buffers.
+    // an exception of the source ends the input like an empty chunk, and is handed over
+    // with it.
+    vector<Vector3D> buffers[2] = {vector<Vector3D>(_chunk), vector<Vector3D>(_chunk)};
+    size_t filled[2] = {0, 0};
+    bool full[2] = {false, false};
+    bool stop = false;
+    exception_ptr failure;
+    mutex lock;
+    condition_variable changed;
+    thread reader([&]() {
+        for (int b = 0;; b ^= 1)
+        {
+            {
+                unique_lock<mutex> guard(lock);
+                changed.wait(guard, [&]() { return ! full[b] || stop; });
+                if (stop)
+                {
+                    return;
+                }
+            }
+            size_t count = 0;
+            exception_ptr error;
+            try
+            {
+                count = _source(Span<Vector3D>(buffers[b]));
+            }
+            catch (...)
+            {
+                error = current_exception();
+            }
+            {
+                lock_guard<mutex> guard(lock);
+                filled[b] = count;
+                full[b] = true;
+                failure = error;
+            }
+            changed.notify_all();
+            if (count == 0)
+            {
+                return;
+            }
+        }
+    });
+    size_t total = 0;
+    try
+    {
+        for (int b = 0;; b ^= 1)
+        {
+            size_t count;
+            {
+                unique_lock<mutex> guard(lock);
+                changed.wait(guard, [&]() { return full[b]; });
+                count = filled[b];
+            }
+            if (count == 0)
+            {
+                break;
+            }
+            Span<Vector3D> chunk(buffers[b].data(), count);
+            for (const PointStage &stage : _stages)
+            {
+                if (chunk.empty())
+                {
+                    break;
+                }
+                chunk = chunk.subspan(0, stage(chunk));
+            }
+            if (! chunk.empty())
+            {
+                sink(chunk);
+                total += chunk.size();
+            }
+            {
+                lock_guard<mutex> guard(lock);
+                full[b] = false;
+            }
+            changed.notify_all();
+        }
+    }
+    catch (...)
+    {
+        {
+            lock_guard<mutex> guard(lock);
+            stop = true;
+        }
+        changed.notify_all();
+        reader.join();
+        throw;
+    }
+    reader.join();
+    if (failure)
+    {
+        rethrow_exception(failure);
+    }
+    return total;
+}
+
+/**
+* runs the whole input through the stages and sums the points.
+* @return the sum
+*/
+Vector3D Pipeline::sum()
+{
+    return reduce(Vector3D(), [](const Vector3D &sum, Span<const Vector3D> chunk) {
+        return sum + parallel_sum(chunk);
+    });
+}
+
+// ------------------ Sources and sinks ------------------------
+
+/**
+* reads a binary file of vectors chunk by chunk. the source throws runtime_error, so
+* Pipeline::run does, if the header is bad or the stream fails before the count of its header.
+* @param is stream to read, opened in binary mode. must outlive the source
+* @return the source
+*/
+PointSource binary_source(istream &is)
+{
+    uint64_t count = 0;
+    bool swap = false;
+    const bool valid = read_header(is, 3, count, swap);
+    auto left = make_shared<uint64_t>(count);
+    return [&is, left, swap, valid](Span<Vector3D> chunk) {
+        if (! valid)
+        {
+            throw runtime_error(HEADER_ERROR);
+        }
+        size_t n = (size_t) min((uint64_t) chunk.size(), *left);
+        if (n == 0)
+        {
+            return (size_t) 0;
+        }
+        if (! read_records(is, reinterpret_cast<double *>(chunk.data()), 3 * n, swap))
+        {
+            *left = 0;
+            throw runtime_error(READ_ERROR);
+        }
+        *left -= n;
+        return n;
+    };
+}
+
+/**
+* gives the points of an array chunk by chunk.
+* @param points to give. must outlive the source
+* @return the source
+*/
+PointSource span_source(const Span<const Vector3D> points)
+{
+    auto next = make_shared<size_t>(0);
+    return [points, next](Span<Vector3D> chunk) {
+        size_t n = min(chunk.size(), points.size() - *next);
+        copy(points.begin() + *next, points.begin() + *next + n, chunk.begin());
+        *next += n;
+        return n;
+    };
+}
+
+/**
+* writes the chunks as text, a vector per line. the sink throws runtime_error, so
+* Pipeline::run does, if the stream fails.
+* @param os stream to write. must outlive the sink
+* @return the sink
+*/
+PointSink text_sink(ostream &os)
+{
+    return [&os](Span<const Vector3D> chunk) {
+        if (! write_text(os, chunk))
+        {
+            throw runtime_error(WRITE_ERROR);
+        }
+    };
+}
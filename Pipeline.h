@@ -0,0 +1,150 @@
+// Created by liorP.
+//
+
+#ifndef EX1_PIPELINE_H
+#define EX1_PIPELINE_H
+
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <vector>
+#include "Matrix3D.h"
+#include "Span.h"
+
+// --------------------------------------------------------------------------------------
+// A streaming pipeline over point sets larger than memory: source -> stages -> sink.
+// The source fills fixed size chunks of points on a background thread while the calling
+// thread runs the stages and the sink over the previous chunk (double buffering), so
+// reading overlaps the compute, and the memory in use is two chunks whatever the input size.
+// --------------------------------------------------------------------------------------
+
+/**
+ * default number of points in a chunk (1.5 MiB).
+ */
+#define PIPELINE_CHUNK (1 << 16)
+
+/**
+ * fills the front of a chunk with the next points of the input.
+ * returns the number of points it filled, 0 at the end of the input.
+ */
+typedef function<size_t(Span<Vector3D> chunk)> PointSource;
+
+/**
+ * changes a chunk in place, and may drop points by moving the kept ones to its front.
+ * returns the number of points kept.
+ */
+typedef function<size_t(Span<Vector3D> chunk)> PointStage;
+
+/**
+ * consumes a chunk of points that went through all the stages.
+ */
+typedef function<void(Span<const Vector3D> chunk)> PointSink;
+
+/**
+ * A source followed by stages, run chunk by chunk into a sink.
+ */
+class Pipeline
+{
+public:
+    /**
+     * A constructor.
+     * @param source the input
+     * @param chunk number of points in a chunk
+     */
+    explicit Pipeline(PointSource source, size_t chunk = PIPELINE_CHUNK);
+
+    /**
+     * adds a stage.
+     * @param stage to run on every chunk, after the stages added before it
+     * @return reference to this pipeline
+     */
+    Pipeline &stage(PointStage stage);
+
+    /**
+     * adds a stage of point = matrix * point (see transform_batch).
+     * @param matrix to multiply with
+     * @return reference to this pipeline
+     */
+    Pipeline &transform(const Matrix3D &matrix);
+
+    /**
+     * adds a stage that keeps the points predicate accepts, in order. a template, so that
+     * the predicate is inlined into the loop over the chunk.
+     * @param predicate returns true for the points to keep
+     * @return reference to this pipeline
+     */
+    template<typename Predicate>
+    Pipeline &filter(Predicate predicate)
+    {
+        return stage([predicate](Span<Vector3D> chunk) {
+            // remove_if keeps the order of the kept points, and unlike stable_partition needs no buffer
+            auto kept = remove_if(chunk.begin(), chunk.end(), [&](const Vector3D &point) {
+                return ! predicate(point);
+            });
+            return (size_t) (kept - chunk.begin());
+        });
+    }
+
+    /**
+     * runs the whole input through the stages into the sink. the source is read on a
+     * background thread, the stages and the sink run on the calling thread. an exception
+     * of the source, a stage or the sink stops the reading and is rethrown here.
+     * @param sink called with every chunk that has points left
+     * @return number of points that reached the sink
+     */
+    size_t run(const PointSink &sink);
+
+    /**
+     * runs the whole input through the stages and folds the chunks into a single value.
+     * @param identity the initial value
+     * @param fold returns the value after one more chunk: fold(value, chunk)
+     * @return the value after the last chunk
+     */
+    template<typename T, typename Fold>
+    T reduce(T identity, Fold fold)
+    {
+        T value = identity;
+        run([&](Span<const Vector3D> chunk) { value = fold(value, chunk); });
+        return value;
+    }
+
+    /**
+     * runs the whole input through the stages and sums the points (see parallel_sum).
+     * @return the sum
+     */
+    Vector3D sum();
+
+private:
+    PointSource _source; /**< the input. */
+    vector<PointStage> _stages; /**< the stages, in order. */
+    size_t _chunk; /**< number of points in a chunk. */
+
+};
+
+// ------------------ Sources and sinks ------------------------
+
+/**
+ * reads a binary file of vectors (see BulkIO.h) chunk by chunk. prints an error, and the
+ * source throws runtime_error (so Pipeline::run does), if the header is bad or the stream
+ * fails before the count of its header.
+ * @param is stream to read, opened in binary mode. must outlive the source
+ * @return the source
+ */
+PointSource binary_source(istream &is);
+
+/**
+ * gives the points of an array chunk by chunk.
+ * @param points to give. must outlive the source
+ * @return the source
+ */
+PointSource span_source(Span<const Vector3D> points);
+
+/**
+ * writes the chunks as text, a vector per line (see write_text). prints an error, and the
+ * sink throws runtime_error (so Pipeline::run does), if the stream fails.
+ * @param os stream to write. must outlive the sink
+ * @return the sink
+ */
+PointSink text_sink(ostream &os);
+
+#endif //EX1_PIPELINE_H
@@ -0,0 +1,143 @@
+// Created by liorP.
+//
+
+#include <algorithm>
+#include <malloc.h>
+#include <unistd.h>
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "BulkIO.h"
+#include "Parallel.h"
+#include "Pipeline.h"
+#include "Transform.h"
+
+/**
+ * number of points of the pipeline file (3 GiB).
+ */
+#define PIPELINE_POINTS ((size_t) 1 << 27)
+
+// --------------------------------------------------------------------------------------
+// Out of core benchmarks: transform, filter and sum a binary file of vectors larger than
+// what a process would want to hold, point by point through istream::read, chunk by chunk
+// on a single thread, and through a Pipeline, where the reads overlap the compute.
+// The peak growth of the anonymous resident memory during a run is recorded with it (peak_mib).
+// --------------------------------------------------------------------------------------
+
+/**
+ * the filter of the benchmarks, keeps about half of the points.
+ */
+struct Upper
+{
+    /**
+     * @param point to test
+     * @return true to keep the point
+     */
+    bool operator()(const Vector3D &point) const { return point[2] > 0; }
+};
+
+/**
+ * writes PIPELINE_POINTS points to a binary file.
+ * @param path of the file
+ */
+static void writePipelineFile(const string &path)
+{
+    vector<Vector3D> block = bench_points(BENCH_ARRAY);
+    ofstream os(path, ios::binary);
+    write_header(os, 3, PIPELINE_POINTS);
+    for (size_t written = 0; written < PIPELINE_POINTS; written += block.size())
+    {
+        os.write(reinterpret_cast<const char *>(block.data()), (streamsize) (block.size() * sizeof(Vector3D)));
+    }
+}
+
+/**
+ * @param run the benchmarked op, calls sample between chunks
+ * @return the peak growth of the anonymous resident memory during a run in MiB
+ */
+template<typename Run>
+static double peakGrowth(Run run)
+{
+    // returns the free heap pages to the system, or the run could reuse them and not show
+    malloc_trim(0);
+    long before = resident_anonymous(), peak = before;
+    run([&]() { peak = max(peak, resident_anonymous()); });
+    return (double) (peak - before) / 1024;
+}
+
+/**
+ * measures a run, with the peak memory it takes.
+ * @param bench to measure with
+ * @param name of the measurement
+ * @param run the benchmarked op, calls sample between chunks
+ */
+template<typename Run>
+static void measureRun(Bench &bench, const string &name, Run run)
+{
+    const double peak = peakGrowth(run);
+    bench.measure(name, PIPELINE_POINTS, [&]() { keep(run([]() {})); }).peak_mib = peak;
+}
+
+/**
+ * benchmarks streaming a file through transform, filter and sum.
+ * @param bench to measure with
+ */
+static void pipelineStream(Bench &bench)
+{
+    const string path = "/tmp/ex1_pipeline_" + to_string(getpid()) + ".bin";
+    writePipelineFile(path);
+    const Matrix3D matrix = bench_matrices(1)[0];
+    auto pointwise = [&](const function<void()> &sample) {
+        ifstream is(path, ios::binary);
+        uint64_t count;
+        bool swap;
+        read_header(is, 3, count, swap);
+        Vector3D sum, point;
+        for (uint64_t i = 0; i < count; ++ i)
+        {
+            is.read(reinterpret_cast<char *>(&point), sizeof(point));
+            point = matrix * point;
+            if (Upper()(point))
+            {
+                sum += point;
+            }
+            if (i % PIPELINE_CHUNK == 0)
+            {
+                sample();
+            }
+        }
+        return sum;
+    };
+    auto chunked = [&](const function<void()> &sample) {
+        ifstream is(path, ios::binary);
+        uint64_t count;
+        bool swap;
+        read_header(is, 3, count, swap);
+        vector<Vector3D> chunk(PIPELINE_CHUNK);
+        Vector3D sum;
+        for (uint64_t done = 0; done < count; done += chunk.size())
+        {
+            chunk.resize((size_t) min((uint64_t) PIPELINE_CHUNK, count - done));
+            read_records(is, reinterpret_cast<double *>(chunk.data()), 3 * chunk.size(), swap);
+            transform_batch(matrix, chunk);
+            auto kept = remove_if(chunk.begin(), chunk.end(), [](const Vector3D &point) { return ! Upper()(point); });
+            sum += parallel_sum(Span<const Vector3D>(chunk.data(), (size_t) (kept - chunk.begin())));
+            sample();
+        }
+        return sum;
+    };
+    auto piped = [&](const function<void()> &sample) {
+        ifstream is(path, ios::binary);
+        Pipeline pipeline(binary_source(is));
+        pipeline.transform(matrix).filter(Upper()).stage([&](Span<Vector3D> chunk) {
+            sample();
+            return chunk.size();
+        });
+        return pipeline.sum();
+    };
+    measureRun(bench, "istream::read per point", pointwise);
+    measureRun(bench, "chunks, one thread", chunked);
+    measureRun(bench, "Pipeline, double buffered", piped);
+    remove(path.c_str());
+}
+
+BENCHMARK(pipelineStream);
@@ -0,0 +1,67 @@
+// Created by liorP.
+//
+
+#include "BenchData.h"
+#include "Benchmark.h"
+
+/**
+ * number of points of the precision benchmarks, well past the last level cache.
+ */
+#define PRECISION_POINTS (BENCH_ARRAY * 8)
+
+// --------------------------------------------------------------------------------------
+// Memory bound loops over float and double points, Vector3F (12 bytes) against Vector3D
+// (24 bytes): with half the bytes to stream, the float loops should run up to twice as fast.
+// --------------------------------------------------------------------------------------
+
+/**
+ * runs the streaming loops over points of one precision.
+ * @param bench to measure with
+ * @param label name of the vector type
+ */
+template<typename T>
+static void streamLoops(Bench &bench, const string &label)
+{
+    typedef Vector<3, T> Point;
+    typedef Matrix<3, 3, T> Transform;
+    const string suffix = " (" + to_string(sizeof(Point)) + " B/point)";
+    vector<Vector3D> source = bench_points(PRECISION_POINTS);
+    vector<Point> points(PRECISION_POINTS), out(PRECISION_POINTS);
+    for (size_t i = 0; i < source.size(); ++ i)
+    {
+        points[i] = Point(source[i][0], source[i][1], source[i][2]);
+    }
+    const Matrix3D m = bench_matrices(1)[0];
+    Transform transform;
+    for (int row = 0; row < 3; ++ row)
+    {
+        transform[row] = Point(m[row][0], m[row][1], m[row][2]);
+    }
+    bench.measure(label + " sum" + suffix, points.size(), [&]() {
+        Point sum;
+        for (const Point &point : points)
+        {
+            sum += point;
+        }
+        keep(sum);
+    });
+    bench.measure(label + " transform" + suffix, points.size(), [&]() {
+        for (size_t i = 0; i < points.size(); ++ i)
+        {
+            out[i] = transform * points[i];
+        }
+        keep(out);
+    });
+}
+
+/**
+ * benchmarks the same streaming loops with Vector3F and with Vector3D.
+ * @param bench to measure with
+ */
+static void floatPrecision(Bench &bench)
+{
+    streamLoops<float>(bench, "Vector3F");
+    streamLoops<double>(bench, "Vector3D");
+}
+
+BENCHMARK(floatPrecision);
@@ -0,0 +1,169 @@
+// Created by liorP.
+//
+
+#include "Quaternion.h"
+#include "Transform.h"
+
+#define SIZE_ERROR "Input and output sizes differ"
+#define SPACE " "
+
+/**
+ * dot product above which slerp falls back to nlerp, where sin(angle) loses its precision.
+ */
+#define SLERP_LINEAR 0.9995
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the Quaternion class.
+// --------------------------------------------------------------------------------------
+
+/**
+* A constructor - the rotation of a matrix (Shepperd's method), normalized, so a matrix
+* that drifted away from orthonormal gives a rotation close to it.
+* @param rotation a rotation matrix
+*/
+Quaternion::Quaternion(const Matrix3D &rotation) : _w(1), _v()
+{
+    const Matrix3D &m = rotation;
+    double trace = m.trace();
+    // from the largest of 4w^2 - 1, 4x^2 - 1, 4y^2 - 1, 4z^2 - 1, so never dividing by a small number
+    int largest = 0;
+    double best = trace;
+    for (int i = 0; i < 3; ++ i)
+    {
+        if (m[i][i] > best)
+        {
+            best = m[i][i];
+            largest = i + 1;
+        }
+    }
+    if (largest == 0)
+    {
+        double r = std::sqrt(1 + trace);
+        double s = 0.5 / r;
+        *this = Quaternion(0.5 * r, (m[2][1] - m[1][2]) * s, (m[0][2] - m[2][0]) * s, (m[1][0] - m[0][1]) * s);
+    }
+    else
+    {
+        int i = largest - 1, j = (i + 1) % 3, k = (i + 2) % 3;
+        double r = std::sqrt(1 + m[i][i] - m[j][j] - m[k][k]);
+        double s = 0.5 / r;
+        _w = (m[k][j] - m[j][k]) * s;
+        _v[i] = 0.5 * r;
+        _v[j] = (m[j][i] + m[i][j]) * s;
+        _v[k] = (m[k][i] + m[i][k]) * s;
+    }
+    normalize();
+}
+
+/**
+* @param axis of the rotation, not necessarily unit
+* @param angle of the rotation in radians, counterclockwise around the axis
+* @return the rotation, the identity if the axis is zero
+*/
+Quaternion Quaternion::from_axis_angle(const Vector3D &axis, const double angle)
+{
+    double length = axis.norm();
+    if (length == 0)
+    {
+        return Quaternion();
+    }
+    return Quaternion(cos(angle / 2), axis * (sin(angle / 2) / length));
+}
+
+/**
+* normalized linear interpolation along the shorter arc: cheaper than slerp, exact at the
+* ends, and with the angular speed off by a few percent in between.
+* @param a the rotation at t = 0, unit
+* @param b the rotation at t = 1, unit
+* @param t the parameter, in [0, 1]
+* @return the unit interpolated rotation
+*/
+Quaternion nlerp(const Quaternion &a, const Quaternion &b, const double t)
+{
+    // q and -q are the same rotation, the one closer to a is the shorter arc
+    double u = a.dot(b) < 0 ? - t : t;
+    Quaternion ans(a.w() * (1 - t) + b.w() * u, a.vec() * (1 - t) + b.vec() * u);
+    return ans.normalize();
+}
+
+/**
+* spherical linear interpolation along the shorter arc, at constant angular speed.
+* @param a the rotation at t = 0, unit
+* @param b the rotation at t = 1, unit
+* @param t the parameter, in [0, 1]
+* @return the unit interpolated rotation
+*/
+Quaternion slerp(const Quaternion &a, const Quaternion &b, const double t)
+{
+    double cosine = a.dot(b);
+    double sign = cosine < 0 ? -1 : 1;
+    cosine *= sign;
+    if (cosine > SLERP_LINEAR)
+    {
+        return nlerp(a, b, t);
+    }
+    double angle = acos(cosine), sine = sin(angle);
+    double p = sin((1 - t) * angle) / sine, q = sign * sin(t * angle) / sine;
+    Quaternion ans(a.w() * p + b.w() * q, a.vec() * p + b.vec() * q);
+    return ans.normalize();
+}
+
+/**
+* out[i] = rotation * in[i], through the batched transform of rotation.matrix()
+* @param rotation unit quaternion to rotate with
+* @param in points to rotate
+* @param out rotated points, same size as in. may be the same range as in
+*/
+void rotate_batch(const Quaternion &rotation, const Span<const Vector3D> in, const Span<Vector3D> out)
+{
+    // 15 operations a point for the matrix against 18 for the quaternion, and the SIMD kernel
+    transform_batch(rotation.matrix(), in, out);
+}
+
+/**
+* out[i] = rotations[i] * in[i]
+* @param rotations unit quaternions
+* @param in points to rotate, same size as rotations
+* @param out rotated points, same size as in. may be the same range as in
+*/
+void rotate_batch(const Span<const Quaternion> rotations, const Span<const Vector3D> in, const Span<Vector3D> out)
+{
+    INSTRUMENT_SCOPE("rotate_batch");
+    if (rotations.size() != in.size() || in.size() != out.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return;
+    }
+    for (size_t i = 0; i < in.size(); ++ i)
+    {
+        out[i] = rotations[i] * in[i];
+    }
+}
+
+/**
+* << operator overload, prints w x y z.
+* @param os out-stream
+* @param quaternion quaternion to print
+* @return out stream with the quaternion
+*/
+ostream &operator<<(ostream &os, const Quaternion &quaternion)
+{
+    return os << quaternion.w() << SPACE << quaternion.vec();
+}
+
+/**
+* >> operator overload, reads w x y z.
+* @param is in-stream
+* @param quaternion quaternion to receive data into
+* @return in stream
+*/
+istream &operator>>(istream &is, Quaternion &quaternion)
+{
+    double w;
+    Vector3D v;
+    if (is >> w >> v)
+    {
+        quaternion = Quaternion(w, v);
+    }
+    return is;
+}
@@ -0,0 +1,253 @@
+// Created by liorP.
+//
+
+#ifndef EX1_QUATERNION_H
+#define EX1_QUATERNION_H
+
+#include "Matrix3D.h"
+#include "Span.h"
+
+// --------------------------------------------------------------------------------------
+// A unit quaternion rotation, interchangeable with the rotation Matrix3D.
+// A composition is 16 multiplies against the 27 of Matrix3D * Matrix3D, and a product of
+// many compositions is brought back to a rotation by normalizing 4 numbers, where a matrix
+// has to be orthonormalized. The points of a batch are rotated through matrix(), the
+// cheapest way to rotate many vectors with one rotation.
+// --------------------------------------------------------------------------------------
+
+/**
+ * A Quaternion class.
+ * This class represents the quaternion w + x i + y j + z k, as the scalar w and the vector
+ * (x, y, z). q * v rotates v by the unit quaternion q, and q1 * q2 rotates by q2 then by q1,
+ * like the product of their matrices.
+ */
+class Quaternion
+{
+public:
+    /**
+     * A default constructor - the identity rotation.
+     */
+    constexpr Quaternion() : _w(1), _v() {}
+
+    /**
+     * A constructor.
+     * @param w the scalar part
+     * @param x,y,z the vector part
+     */
+    constexpr Quaternion(double w, double x, double y, double z) : _w(w), _v(x, y, z) {}
+
+    /**
+     * A constructor.
+     * @param w the scalar part
+     * @param v the vector part
+     */
+    constexpr Quaternion(double w, const Vector3D &v) : _w(w), _v(v) {}
+
+    /**
+     * A constructor - the rotation of a matrix (Shepperd's method), normalized, so a matrix
+     * that drifted away from orthonormal gives a rotation close to it.
+     * @param rotation a rotation matrix
+     */
+    explicit Quaternion(const Matrix3D &rotation);
+
+    /**
+     * @param axis of the rotation, not necessarily unit
+     * @param angle of the rotation in radians, counterclockwise around the axis
+     * @return the rotation, the identity if the axis is zero
+     */
+    static Quaternion from_axis_angle(const Vector3D &axis, double angle);
+
+    /**
+     * @return the scalar part
+     */
+    constexpr double w() const { return _w; }
+
+    /**
+     * @return the vector part
+     */
+    constexpr const Vector3D &vec() const { return _v; }
+
+    /**
+     * * operator overload as the Hamilton product, the composition of rotations
+     * @param other the rotation applied first
+     * @return the product
+     */
+    constexpr Quaternion operator*(const Quaternion &other) const;
+
+    /**
+     * *= operator overload, *this = *this * other
+     * @param other the rotation applied first
+     * @return reference to this quaternion
+     */
+    constexpr Quaternion &operator*=(const Quaternion &other);
+
+    /**
+     * * operator overload, rotates a vector
+     * @param vector to rotate
+     * @return the rotated vector, for a unit quaternion
+     */
+    constexpr Vector3D operator*(const Vector3D &vector) const;
+
+    /**
+     * @return the conjugate, the inverse rotation of a unit quaternion
+     */
+    constexpr Quaternion conjugate() const { return Quaternion(_w, - _v); }
+
+    /**
+     * @param other quaternion to dot with
+     * @return the 4D dot product
+     */
+    constexpr double dot(const Quaternion &other) const { return _w * other._w + _v * other._v; }
+
+    /**
+     * @return the squared norm
+     */
+    constexpr double norm_squared() const { return dot(*this); }
+
+    /**
+     * @return the norm
+     */
+    inline double norm() const { return std::sqrt(norm_squared()); }
+
+    /**
+     * divides by the norm, e.g. after many compositions. reports an error for the zero quaternion (see Errors.h).
+     * @return reference to this quaternion
+     */
+    inline Quaternion &normalize();
+
+    /**
+     * @return the rotation matrix of the quaternion. a non unit quaternion gives the rotation
+     * of the normalized one
+     */
+    constexpr Matrix3D matrix() const;
+
+private:
+    double _w; /**< the scalar part. */
+    Vector3D _v; /**< the vector part. */
+
+};
+
+// copied as raw bytes, like Vector3D
+static_assert(is_trivially_copyable<Quaternion>::value, "Quaternion is copied with memcpy");
+
+/**
+* * operator overload as the Hamilton product, the composition of rotations
+* @param other the rotation applied first
+* @return the product
+*/
+constexpr Quaternion Quaternion::operator*(const Quaternion &other) const
+{
+    // component by component, as sums of pairs: a short dependency chain for a long product chain
+    const double *a = _v.data(), *b = other._v.data();
+    const double w = _w, x = a[0], y = a[1], z = a[2], ow = other._w, ox = b[0], oy = b[1], oz = b[2];
+    return Quaternion((w * ow - x * ox) - (y * oy + z * oz), (w * ox + x * ow) + (y * oz - z * oy),
+                      (w * oy + y * ow) + (z * ox - x * oz), (w * oz + z * ow) + (x * oy - y * ox));
+}
+
+/**
+* *= operator overload, *this = *this * other
+* @param other the rotation applied first
+* @return reference to this quaternion
+*/
+constexpr Quaternion &Quaternion::operator*=(const Quaternion &other)
+{
+    return *this = *this * other;
+}
+
+/**
+* * operator overload, rotates a vector
+* @param vector to rotate
+* @return the rotated vector, for a unit quaternion
+*/
+constexpr Vector3D Quaternion::operator*(const Vector3D &vector) const
+{
+    // v + w * t + u x t, t = 2 * u x v: two cross products instead of q * v * conjugate
+    Vector3D t = cross(_v, vector) * 2.0;
+    return vector + t * _w + cross(_v, t);
+}
+
+/**
+* divides by the norm, e.g. after many compositions. reports an error for the zero quaternion (see Errors.h).
+* @return reference to this quaternion
+*/
+inline Quaternion &Quaternion::normalize()
+{
+    double n = norm();
+    if (error_if(n == 0))
+    {
+        report_error(ERROR_ZERO);
+        return *this;
+    }
+    _w /= n;
+    _v /= n;
+    return *this;
+}
+
+/**
+* @return the rotation matrix of the quaternion. a non unit quaternion gives the rotation
+* of the normalized one
+*/
+constexpr Matrix3D Quaternion::matrix() const
+{
+    const double s = 2 / norm_squared();
+    const double x = _v[0], y = _v[1], z = _v[2];
+    const double xx = s * x * x, yy = s * y * y, zz = s * z * z;
+    const double xy = s * x * y, xz = s * x * z, yz = s * y * z;
+    const double wx = s * _w * x, wy = s * _w * y, wz = s * _w * z;
+    return Matrix3D(1 - yy - zz, xy - wz, xz + wy,
+                    xy + wz, 1 - xx - zz, yz - wx,
+                    xz - wy, yz + wx, 1 - xx - yy);
+}
+
+/**
+ * normalized linear interpolation along the shorter arc: cheaper than slerp, exact at the
+ * ends, and with the angular speed off by a few percent in between.
+ * @param a the rotation at t = 0, unit
+ * @param b the rotation at t = 1, unit
+ * @param t the parameter, in [0, 1]
+ * @return the unit interpolated rotation
+ */
+Quaternion nlerp(const Quaternion &a, const Quaternion &b, double t);
+
+/**
+ * spherical linear interpolation along the shorter arc, at constant angular speed.
+ * @param a the rotation at t = 0, unit
+ * @param b the rotation at t = 1, unit
+ * @param t the parameter, in [0, 1]
+ * @return the unit interpolated rotation
+ */
+Quaternion slerp(const Quaternion &a, const Quaternion &b, double t);
+
+/**
+ * out[i] = rotation * in[i], through the batched transform of rotation.matrix()
+ * @param rotation unit quaternion to rotate with
+ * @param in points to rotate
+ * @param out rotated points, same size as in. may be the same range as in
+ */
+void rotate_batch(const Quaternion &rotation, Span<const Vector3D> in, Span<Vector3D> out);
+
+/**
+ * out[i] = rotations[i] * in[i]
+ * @param rotations unit quaternions
+ * @param in points to rotate, same size as rotations
+ * @param out rotated points, same size as in. may be the same range as in
+ */
+void rotate_batch(Span<const Quaternion> rotations, Span<const Vector3D> in, Span<Vector3D> out);
+
+/**
+ * << operator overload, prints w x y z.
+ * @param os out-stream
+ * @param quaternion quaternion to print
+ * @return out stream with the quaternion
+ */
+ostream &operator<<(ostream &os, const Quaternion &quaternion);
+
+/**
+ * >> operator overload, reads w x y z.
+ * @param is in-stream
+ * @param quaternion quaternion to receive data into
+ * @return in stream
+ */
+istream &operator>>(istream &is, Quaternion &quaternion);
+
+#endif //EX1_QUATERNION_H
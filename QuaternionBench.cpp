@@ -0,0 +1,168 @@
+// Created by liorP.
+//
+
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "Quaternion.h"
+#include "Transform.h"
+
+/**
+ * number of rotations composed by the composition benchmarks.
+ */
+#define COMPOSITIONS (1 << 20)
+
+// --------------------------------------------------------------------------------------
+// Benchmarks of Quaternion against the rotation Matrix3D: composing a long chain of small
+// rotations (with how far the product drifted from a rotation as max_error), rotating points
+// one at a time and in batches, and interpolating.
+// --------------------------------------------------------------------------------------
+
+/**
+ * @param count number of rotations
+ * @return random unit quaternions
+ */
+static vector<Quaternion> randomRotations(size_t count)
+{
+    vector<Vector3D> axes = bench_points(count, 7);
+    vector<Quaternion> rotations(count);
+    for (size_t i = 0; i < count; ++ i)
+    {
+        rotations[i] = Quaternion::from_axis_angle(axes[i], axes[i].norm());
+    }
+    return rotations;
+}
+
+/**
+ * @param m a matrix
+ * @return |transpose(m) * m - I|, largest element
+ */
+static double orthogonality(const Matrix3D &m)
+{
+    Matrix3D d = m.transpose() * m - Matrix3D(1.0);
+    double error = 0;
+    for (int i = 0; i < 3; ++ i)
+    {
+        for (int j = 0; j < 3; ++ j)
+        {
+            error = max(error, std::abs(d[i][j]));
+        }
+    }
+    return error;
+}
+
+/**
+ * benchmarks composing a chain of rotations as matrices and as quaternions.
+ * @param bench to measure with
+ */
+static void composition(Bench &bench)
+{
+    const vector<Quaternion> steps = randomRotations(1024);
+    vector<Matrix3D> matrices(steps.size());
+    for (size_t i = 0; i < steps.size(); ++ i)
+    {
+        matrices[i] = steps[i].matrix();
+    }
+    auto matrixChain = [&]() {
+        Matrix3D product(1.0);
+        for (size_t i = 0; i < COMPOSITIONS; i += matrices.size())
+        {
+            for (const Matrix3D &step : matrices)
+            {
+                product *= step;
+            }
+        }
+        return product;
+    };
+    auto quaternionChain = [&](bool normalize) {
+        Quaternion product;
+        for (size_t i = 0; i < COMPOSITIONS; i += steps.size())
+        {
+            for (const Quaternion &step : steps)
+            {
+                product *= step;
+            }
+            if (normalize)
+            {
+                product.normalize();
+            }
+        }
+        return product;
+    };
+    const string count = "/" + to_string(COMPOSITIONS);
+    bench.measure("Matrix3D *= chain" + count, COMPOSITIONS, [&]() {
+        keep(matrixChain());
+    }).max_error = orthogonality(matrixChain());
+    bench.measure("Quaternion *= chain" + count, COMPOSITIONS, [&]() {
+        keep(quaternionChain(false));
+    }).max_error = std::abs(quaternionChain(false).norm() - 1);
+    bench.measure("Quaternion *= chain, normalize every 1024" + count, COMPOSITIONS, [&]() {
+        keep(quaternionChain(true));
+    }).max_error = std::abs(quaternionChain(true).norm() - 1);
+}
+
+/**
+ * benchmarks rotating points by a matrix and by a quaternion.
+ * @param bench to measure with
+ */
+static void rotation(Bench &bench)
+{
+    const Quaternion q = randomRotations(1)[0];
+    const Matrix3D m = q.matrix();
+    const vector<Vector3D> points = bench_points(BENCH_ARRAY);
+    vector<Vector3D> out(points.size());
+    const vector<Quaternion> rotations = randomRotations(points.size());
+    const string count = "/" + to_string(points.size());
+    bench.measure("loop Matrix3D * Vector3D" + count, points.size(), [&]() {
+        for (size_t i = 0; i < points.size(); ++ i)
+        {
+            out[i] = m * points[i];
+        }
+        keep(out);
+    });
+    bench.measure("loop Quaternion * Vector3D" + count, points.size(), [&]() {
+        for (size_t i = 0; i < points.size(); ++ i)
+        {
+            out[i] = q * points[i];
+        }
+        keep(out);
+    });
+    bench.measure("rotate_batch(Quaternion)" + count, points.size(), [&]() {
+        rotate_batch(q, points, out);
+        keep(out);
+    });
+    bench.measure("loop Quaternion::matrix() * Vector3D, a rotation per point" + count, points.size(), [&]() {
+        for (size_t i = 0; i < points.size(); ++ i)
+        {
+            out[i] = rotations[i].matrix() * points[i];
+        }
+        keep(out);
+    });
+    bench.measure("rotate_batch(Span<Quaternion>), a rotation per point" + count, points.size(), [&]() {
+        rotate_batch(rotations, points, out);
+        keep(out);
+    });
+}
+
+/**
+ * benchmarks the interpolations between random rotations.
+ * @param bench to measure with
+ */
+static void interpolation(Bench &bench)
+{
+    const vector<Quaternion> a = randomRotations(BENCH_ARRAY / 4), b = randomRotations(BENCH_ARRAY / 4 + 1);
+    vector<Quaternion> out(a.size());
+    for (auto [name, interpolate] : {make_pair("nlerp", nlerp), make_pair("slerp", slerp)})
+    {
+        bench.measure(string("loop ") + name + "/" + to_string(a.size()), a.size(), [&]() {
+            for (size_t i = 0; i < a.size(); ++ i)
+            {
+                out[i] = interpolate(a[i], b[i + 1], 0.3);
+            }
+            keep(out);
+        });
+    }
+}
+
+BENCHMARK(composition);
+BENCHMARK(rotation);
+BENCHMARK(interpolation);
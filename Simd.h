@@ -0,0 +1,212 @@
+// Created by liorP.
+//
+
+#ifndef EX1_SIMD_H
+#define EX1_SIMD_H
+
+#include <cmath>
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// --------------------------------------------------------------------------------------
+// A thin wrapper over the widest double precision vector registers the target supports.
+// The ISA is selected at compile time (see ARCHFLAGS in the Makefile): AVX-512, AVX2 or a
+// scalar fallback of width 1, so the batch kernels are written once against simd_t.
+// --------------------------------------------------------------------------------------
+
+#if defined(__AVX512F__)
+
+#define SIMD_WIDTH 8
+#define SIMD_ISA "avx512"
+
+typedef __m512d simd_t;
+
+inline simd_t simd_load(const double *p) { return _mm512_loadu_pd(p); }
+
+inline void simd_store(double *p, simd_t a) { _mm512_storeu_pd(p, a); }
+
+inline simd_t simd_set(double a) { return _mm512_set1_pd(a); }
+
+// loads p[0], p[stride] ... p[7 * stride]. masked for the same reason as simd_sqrt
+inline simd_t simd_gather(const double *p, long long stride)
+{
+    __m512i index = _mm512_set_epi64(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+    return _mm512_mask_i64gather_pd(_mm512_setzero_pd(), (__mmask8) 0xff, index, p, 8);
+}
+
+// stores to p[0], p[stride] ... p[7 * stride]
+inline void simd_scatter(double *p, long long stride, simd_t a)
+{
+    __m512i index = _mm512_set_epi64(7 * stride, 6 * stride, 5 * stride, 4 * stride, 3 * stride, 2 * stride, stride, 0);
+    _mm512_i64scatter_pd(p, index, a, 8);
+}
+
+inline simd_t simd_add(simd_t a, simd_t b) { return _mm512_add_pd(a, b); }
+
+inline simd_t simd_sub(simd_t a, simd_t b) { return _mm512_sub_pd(a, b); }
+
+inline simd_t simd_mul(simd_t a, simd_t b) { return _mm512_mul_pd(a, b); }
+
+inline simd_t simd_div(simd_t a, simd_t b) { return _mm512_div_pd(a, b); }
+
+inline simd_t simd_fmadd(simd_t a, simd_t b, simd_t c) { return _mm512_fmadd_pd(a, b, c); }
+
+// the masked form, since _mm512_sqrt_pd trips -Wmaybe-uninitialized in the gcc 12 headers
+inline simd_t simd_sqrt(simd_t a) { return _mm512_mask_sqrt_pd(a, (__mmask8) 0xff, a); }
+
+// a 14 bit estimate refined by two Newton-Raphson steps, each doubling the correct bits.
+// masked for the same reason as simd_sqrt
+inline simd_t simd_rsqrt(simd_t a)
+{
+    const simd_t half = _mm512_mul_pd(a, _mm512_set1_pd(0.5)), threeHalves = _mm512_set1_pd(1.5);
+    simd_t y = _mm512_mask_rsqrt14_pd(a, (__mmask8) 0xff, a);
+    y = _mm512_mul_pd(y, _mm512_fnmadd_pd(_mm512_mul_pd(half, y), y, threeHalves));
+    return _mm512_mul_pd(y, _mm512_fnmadd_pd(_mm512_mul_pd(half, y), y, threeHalves));
+}
+
+// masked for the same reason as simd_sqrt
+inline simd_t simd_min(simd_t a, simd_t b) { return _mm512_mask_min_pd(a, (__mmask8) 0xff, a, b); }
+
+inline simd_t simd_max(simd_t a, simd_t b) { return _mm512_mask_max_pd(a, (__mmask8) 0xff, a, b); }
+
+// the sign bit with integer ops: the double ones are AVX512DQ, and gcc 12 warns in _mm512_abs_pd
+// and _mm512_andnot_si512
+inline simd_t simd_abs(simd_t a)
+{
+    const __m512i magnitude = _mm512_set1_epi64(0x7fffffffffffffffll);
+    return _mm512_castsi512_pd(_mm512_and_si512(magnitude, _mm512_castpd_si512(a)));
+}
+
+// the magnitude of a with the sign of b
+inline simd_t simd_copysign(simd_t a, simd_t b)
+{
+    const __m512i sign = _mm512_set1_epi64((long long) 0x8000000000000000ull);
+    return _mm512_castsi512_pd(_mm512_or_si512(_mm512_castpd_si512(simd_abs(a)),
+                                               _mm512_and_si512(sign, _mm512_castpd_si512(b))));
+}
+
+// true if a lane of a is below lo, above hi or NaN
+inline bool simd_outside(simd_t a, simd_t lo, simd_t hi)
+{
+    return (_mm512_cmp_pd_mask(a, lo, _CMP_NGE_UQ) | _mm512_cmp_pd_mask(a, hi, _CMP_NLE_UQ)) != 0;
+}
+
+#elif defined(__AVX2__)
+
+#define SIMD_WIDTH 4
+#define SIMD_ISA "avx2"
+
+typedef __m256d simd_t;
+
+inline simd_t simd_load(const double *p) { return _mm256_loadu_pd(p); }
+
+inline void simd_store(double *p, simd_t a) { _mm256_storeu_pd(p, a); }
+
+inline simd_t simd_set(double a) { return _mm256_set1_pd(a); }
+
+// loads p[0], p[stride], p[2 * stride], p[3 * stride]
+inline simd_t simd_gather(const double *p, long long stride)
+{
+    return _mm256_i64gather_pd(p, _mm256_set_epi64x(3 * stride, 2 * stride, stride, 0), 8);
+}
+
+// stores to p[0], p[stride], p[2 * stride], p[3 * stride]. AVX2 has no scatter
+inline void simd_scatter(double *p, long long stride, simd_t a)
+{
+    alignas(32) double lanes[4];
+    _mm256_store_pd(lanes, a);
+    for (int i = 0; i < 4; ++ i)
+    {
+        p[i * stride] = lanes[i];
+    }
+}
+
+inline simd_t simd_add(simd_t a, simd_t b) { return _mm256_add_pd(a, b); }
+
+inline simd_t simd_sub(simd_t a, simd_t b) { return _mm256_sub_pd(a, b); }
+
+inline simd_t simd_mul(simd_t a, simd_t b) { return _mm256_mul_pd(a, b); }
+
+inline simd_t simd_div(simd_t a, simd_t b) { return _mm256_div_pd(a, b); }
+
+#if defined(__FMA__)
+inline simd_t simd_fmadd(simd_t a, simd_t b, simd_t c) { return _mm256_fmadd_pd(a, b, c); }
+#else
+inline simd_t simd_fmadd(simd_t a, simd_t b, simd_t c) { return _mm256_add_pd(_mm256_mul_pd(a, b), c); }
+#endif
+
+inline simd_t simd_sqrt(simd_t a) { return _mm256_sqrt_pd(a); }
+
+// AVX2 has no double precision estimate, so this is the exact division
+inline simd_t simd_rsqrt(simd_t a) { return _mm256_div_pd(_mm256_set1_pd(1), _mm256_sqrt_pd(a)); }
+
+inline simd_t simd_min(simd_t a, simd_t b) { return _mm256_min_pd(a, b); }
+
+inline simd_t simd_max(simd_t a, simd_t b) { return _mm256_max_pd(a, b); }
+
+inline simd_t simd_abs(simd_t a) { return _mm256_andnot_pd(_mm256_set1_pd(- 0.0), a); }
+
+// the magnitude of a with the sign of b
+inline simd_t simd_copysign(simd_t a, simd_t b)
+{
+    const simd_t sign = _mm256_set1_pd(- 0.0);
+    return _mm256_or_pd(_mm256_andnot_pd(sign, a), _mm256_and_pd(sign, b));
+}
+
+// true if a lane of a is below lo, above hi or NaN
+inline bool simd_outside(simd_t a, simd_t lo, simd_t hi)
+{
+    return _mm256_movemask_pd(_mm256_or_pd(_mm256_cmp_pd(a, lo, _CMP_NGE_UQ), _mm256_cmp_pd(a, hi, _CMP_NLE_UQ))) != 0;
+}
+
+#else
+
+#define SIMD_WIDTH 1
+#define SIMD_ISA "scalar"
+
+typedef double simd_t;
+
+inline simd_t simd_load(const double *p) { return *p; }
+
+inline void simd_store(double *p, simd_t a) { *p = a; }
+
+inline simd_t simd_set(double a) { return a; }
+
+inline simd_t simd_gather(const double *p, long long) { return *p; }
+
+inline void simd_scatter(double *p, long long, simd_t a) { *p = a; }
+
+inline simd_t simd_add(simd_t a, simd_t b) { return a + b; }
+
+inline simd_t simd_sub(simd_t a, simd_t b) { return a - b; }
+
+inline simd_t simd_mul(simd_t a, simd_t b) { return a * b; }
+
+inline simd_t simd_div(simd_t a, simd_t b) { return a / b; }
+
+inline simd_t simd_fmadd(simd_t a, simd_t b, simd_t c) { return a * b + c; }
+
+inline simd_t simd_sqrt(simd_t a) { return std::sqrt(a); }
+
+inline simd_t simd_rsqrt(simd_t a) { return 1 / std::sqrt(a); }
+
+inline simd_t simd_min(simd_t a, simd_t b) { return a < b ? a : b; }
+
+inline simd_t simd_max(simd_t a, simd_t b) { return a > b ? a : b; }
+
+inline simd_t simd_abs(simd_t a) { return std::abs(a); }
+
+inline simd_t simd_copysign(simd_t a, simd_t b) { return std::copysign(a, b); }
+
+inline bool simd_outside(simd_t a, simd_t lo, simd_t hi) { return ! (a >= lo && a <= hi); }
+
+#endif
+
+/**
+ * the alignment (in bytes) of the SoA streams, a full cache line.
+ */
+#define SIMD_ALIGN 64
+
+#endif //EX1_SIMD_H
@@ -0,0 +1,218 @@
+// Created by liorP.
+//
+
+#include <algorithm>
+#include "Simd.h"
+#include "Solve.h"
+
+#define SIZE_ERROR "Input and output sizes differ"
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the batched solvers.
+// --------------------------------------------------------------------------------------
+
+namespace
+{
+/**
+ * The adjugates and inverse determinants of a group of SIMD_WIDTH matrices.
+ */
+struct AdjugateGroup
+{
+    simd_t column[3][3]; /**< column[j][i]: element i of column j of the adjugate. */
+    simd_t scale; /**< 1 / determinant. */
+    bool singular[SIMD_WIDTH]; /**< the lanes of singular matrices. */
+    size_t singulars; /**< number of singular lanes. */
+
+    /**
+     * A constructor - the adjugates of n <= SIMD_WIDTH matrices. the missing lanes are
+     * computed over identity matrices and ignored.
+     * @param m the matrices, row major doubles
+     * @param n number of matrices
+     * @param tolerance of the singularity test
+     */
+    AdjugateGroup(const double *m, const size_t n, const double tolerance) : singular{}, singulars(0)
+    {
+        // transposes the group to SoA, a register per element
+        simd_t r[3][3];
+        if (n == SIMD_WIDTH)
+        {
+            for (int k = 0; k < 9; ++ k)
+            {
+                r[k / 3][k % 3] = simd_gather(m + k, 9);
+            }
+        }
+        else
+        {
+            alignas(SIMD_ALIGN) double e[9][SIMD_WIDTH];
+            for (size_t lane = 0; lane < SIMD_WIDTH; ++ lane)
+            {
+                for (int k = 0; k < 9; ++ k)
+                {
+                    e[k][lane] = lane < n ? m[9 * lane + k] : (k % 4 == 0 ? 1 : 0);
+                }
+            }
+            for (int k = 0; k < 9; ++ k)
+            {
+                r[k / 3][k % 3] = simd_load(e[k]);
+            }
+        }
+        // the columns of the adjugate are the cross products of the rows
+        for (int j = 0; j < 3; ++ j)
+        {
+            const simd_t *p = r[(j + 1) % 3], *q = r[(j + 2) % 3];
+            column[j][0] = simd_sub(simd_mul(p[1], q[2]), simd_mul(p[2], q[1]));
+            column[j][1] = simd_sub(simd_mul(p[2], q[0]), simd_mul(p[0], q[2]));
+            column[j][2] = simd_sub(simd_mul(p[0], q[1]), simd_mul(p[1], q[0]));
+        }
+        simd_t det = simd_fmadd(r[0][2], column[0][2], simd_fmadd(r[0][1], column[0][1],
+                                                                 simd_mul(r[0][0], column[0][0])));
+        simd_t bound = simd_set(tolerance * tolerance);
+        for (int i = 0; i < 3; ++ i)
+        {
+            simd_t norm = simd_fmadd(r[i][2], r[i][2], simd_fmadd(r[i][1], r[i][1], simd_mul(r[i][0], r[i][0])));
+            bound = simd_mul(bound, norm);
+        }
+        scale = simd_div(simd_set(1), det);
+        // the singularity test, see Matrix::is_singular
+        alignas(SIMD_ALIGN) double dets[SIMD_WIDTH], bounds[SIMD_WIDTH];
+        simd_store(dets, det);
+        simd_store(bounds, bound);
+        for (size_t lane = 0; lane < n; ++ lane)
+        {
+            singular[lane] = ! (dets[lane] * dets[lane] > bounds[lane]);
+            singulars += singular[lane];
+        }
+    }
+
+    /**
+     * stores a value of every matrix of the group.
+     * @param p where the value of the first matrix goes
+     * @param stride doubles from a matrix to the next
+     * @param n number of matrices
+     * @param value the values
+     */
+    static void store(double *p, const long long stride, const size_t n, const simd_t value)
+    {
+        if (n == SIMD_WIDTH)
+        {
+            simd_scatter(p, stride, value);
+            return;
+        }
+        alignas(SIMD_ALIGN) double lanes[SIMD_WIDTH];
+        simd_store(lanes, value);
+        for (size_t lane = 0; lane < n; ++ lane)
+        {
+            p[lane * stride] = lanes[lane];
+        }
+    }
+
+    /**
+     * zeroes the results of the singular matrices.
+     * @param p results of the first matrix
+     * @param stride doubles from a matrix to the next, the number of doubles of a result
+     * @param n number of matrices
+     */
+    void zeroSingular(double *p, const long long stride, const size_t n) const
+    {
+        for (size_t lane = 0; singulars != 0 && lane < n; ++ lane)
+        {
+            if (singular[lane])
+            {
+                fill(p + lane * stride, p + (lane + 1) * stride, 0.0);
+            }
+        }
+    }
+};
+}
+
+/**
+* out[i] = matrices[i].inverse()
+* @param matrices to invert
+* @param out the inverses, the zero matrix for a singular one
+* @param tolerance of the singularity test
+* @return number of singular matrices
+*/
+size_t inverse_batch(const Span<const Matrix3D> matrices, const Span<Matrix3D> out, const double tolerance)
+{
+    INSTRUMENT_SCOPE("inverse_batch");
+    if (matrices.size() != out.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return 0;
+    }
+    size_t singulars = 0;
+    for (size_t first = 0; first < matrices.size(); first += SIMD_WIDTH)
+    {
+        size_t n = min((size_t) SIMD_WIDTH, matrices.size() - first);
+        AdjugateGroup group(reinterpret_cast<const double *>(matrices.data() + first), n, tolerance);
+        // row i of the inverse is element i of the three adjugate columns
+        auto *m = reinterpret_cast<double *>(out.data() + first);
+        for (int k = 0; k < 9; ++ k)
+        {
+            group.store(m + k, 9, n, simd_mul(group.column[k % 3][k / 3], group.scale));
+        }
+        group.zeroSingular(m, 9, n);
+        singulars += group.singulars;
+    }
+    return singulars;
+}
+
+/**
+* x[i] = solve(a[i], b[i])
+* @param a matrices of the systems
+* @param b right hand sides, same size as a
+* @param x the solutions, the zero vector for a singular system
+* @param tolerance of the singularity test
+* @return number of singular systems
+*/
+size_t solve_batch(const Span<const Matrix3D> a, const Span<const Vector3D> b, const Span<Vector3D> x,
+                   const double tolerance)
+{
+    INSTRUMENT_SCOPE("solve_batch");
+    if (a.size() != b.size() || a.size() != x.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return 0;
+    }
+    size_t singulars = 0;
+    for (size_t first = 0; first < a.size(); first += SIMD_WIDTH)
+    {
+        size_t n = min((size_t) SIMD_WIDTH, a.size() - first);
+        AdjugateGroup group(reinterpret_cast<const double *>(a.data() + first), n, tolerance);
+        const auto *rhs = reinterpret_cast<const double *>(b.data() + first);
+        simd_t v[3];
+        if (n == SIMD_WIDTH)
+        {
+            for (int j = 0; j < 3; ++ j)
+            {
+                v[j] = simd_gather(rhs + j, 3);
+            }
+        }
+        else
+        {
+            alignas(SIMD_ALIGN) double e[3][SIMD_WIDTH] = {};
+            for (size_t lane = 0; lane < n; ++ lane)
+            {
+                for (int j = 0; j < 3; ++ j)
+                {
+                    e[j][lane] = rhs[3 * lane + j];
+                }
+            }
+            for (int j = 0; j < 3; ++ j)
+            {
+                v[j] = simd_load(e[j]);
+            }
+        }
+        // x = (column 0 * b[0] + column 1 * b[1] + column 2 * b[2]) / det
+        auto *out = reinterpret_cast<double *>(x.data() + first);
+        for (int i = 0; i < 3; ++ i)
+        {
+            simd_t sum = simd_fmadd(group.column[2][i], v[2], simd_fmadd(group.column[1][i], v[1],
+                                                                        simd_mul(group.column[0][i], v[0])));
+            group.store(out + i, 3, n, simd_mul(sum, group.scale));
+        }
+        group.zeroSingular(out, 3, n);
+        singulars += group.singulars;
+    }
+    return singulars;
+}
@@ -0,0 +1,40 @@
+// Created by liorP.
+//
+
+#ifndef EX1_SOLVE_H
+#define EX1_SOLVE_H
+
+#include "Matrix3D.h"
+#include "Span.h"
+
+// --------------------------------------------------------------------------------------
+// Batched closed form inverses and 3x3 linear systems over arrays of Matrix3D.
+// SIMD_WIDTH matrices are transposed into 9 SoA registers, and their adjugates (the cross
+// products of the rows), determinants and singularity tests are computed lane by lane.
+// Singular matrices (see Matrix::is_singular) give zeros and are counted instead of
+// printing an error each, as a million of them can be in a batch.
+// --------------------------------------------------------------------------------------
+
+/**
+ * out[i] = matrices[i].inverse()
+ * @param matrices to invert
+ * @param out the inverses, the zero matrix for a singular one. same size as matrices, may
+ * be the same range
+ * @param tolerance of the singularity test
+ * @return number of singular matrices
+ */
+size_t inverse_batch(Span<const Matrix3D> matrices, Span<Matrix3D> out, double tolerance = SINGULAR_TOLERANCE);
+
+/**
+ * x[i] = solve(a[i], b[i])
+ * @param a matrices of the systems
+ * @param b right hand sides, same size as a
+ * @param x the solutions, the zero vector for a singular system. same size as a, may be the
+ * same range as b
+ * @param tolerance of the singularity test
+ * @return number of singular systems
+ */
+size_t solve_batch(Span<const Matrix3D> a, Span<const Vector3D> b, Span<Vector3D> x,
+                   double tolerance = SINGULAR_TOLERANCE);
+
+#endif //EX1_SOLVE_H
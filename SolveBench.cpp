@@ -0,0 +1,169 @@
+// Created by liorP.
+//
+
+#include "BenchData.h"
+#include "Benchmark.h"
+#include "Solve.h"
+
+/**
+ * number of systems of the cache resident runs.
+ */
+#define CACHED (1 << 12)
+
+/**
+ * number of systems of the memory bound runs.
+ */
+#define SYSTEMS (BENCH_ARRAY / 4)
+
+// --------------------------------------------------------------------------------------
+// Benchmarks of the closed form 3x3 solvers against Gaussian elimination with partial
+// pivoting, the general method of the linear algebra libraries.
+// Every solver runs over CACHED and SYSTEMS random systems, and over as many ill conditioned
+// ones (a row close to the sum of the others). The largest error of every solver against a
+// long double elimination is recorded with it (max_error).
+// --------------------------------------------------------------------------------------
+
+/**
+ * solves matrix * x = b by Gaussian elimination with partial pivoting.
+ * @param matrix of the system
+ * @param b right hand side
+ * @param x the solution
+ */
+template<typename T>
+static void eliminate(const Matrix3D &matrix, const Vector3D &b, T x[3])
+{
+    T a[3][4];
+    for (int i = 0; i < 3; ++ i)
+    {
+        for (int j = 0; j < 3; ++ j)
+        {
+            a[i][j] = matrix[i][j];
+        }
+        a[i][3] = b[i];
+    }
+    for (int k = 0; k < 3; ++ k)
+    {
+        int pivot = k;
+        for (int i = k + 1; i < 3; ++ i)
+        {
+            if (std::abs(a[i][k]) > std::abs(a[pivot][k]))
+            {
+                pivot = i;
+            }
+        }
+        for (int j = 0; j < 4; ++ j)
+        {
+            swap(a[k][j], a[pivot][j]);
+        }
+        for (int i = k + 1; i < 3; ++ i)
+        {
+            T factor = a[i][k] / a[k][k];
+            for (int j = k; j < 4; ++ j)
+            {
+                a[i][j] -= factor * a[k][j];
+            }
+        }
+    }
+    for (int i = 2; i >= 0; -- i)
+    {
+        T sum = a[i][3];
+        for (int j = i + 1; j < 3; ++ j)
+        {
+            sum -= a[i][j] * x[j];
+        }
+        x[i] = sum / a[i][i];
+    }
+}
+
+/**
+ * @param count number of matrices
+ * @param seed of the matrices
+ * @return matrices whose last row is the sum of the others plus 1e-8 of noise
+ */
+static vector<Matrix3D> illConditioned(size_t count, unsigned seed)
+{
+    vector<Matrix3D> matrices = bench_matrices(count, seed);
+    for (Matrix3D &m : matrices)
+    {
+        m[2] = m[0] + m[1] + m[2] * 1e-8;
+    }
+    return matrices;
+}
+
+/**
+ * @param a matrices of the systems
+ * @param b right hand sides
+ * @param x solutions to check
+ * @return the largest |x - exact| / |exact|, with the exact solution by a long double elimination
+ */
+static double maxError(const vector<Matrix3D> &a, const vector<Vector3D> &b, const vector<Vector3D> &x)
+{
+    double error = 0;
+    for (size_t i = 0; i < a.size(); ++ i)
+    {
+        long double exact[3];
+        eliminate(a[i], b[i], exact);
+        Vector3D reference((double) exact[0], (double) exact[1], (double) exact[2]);
+        error = max(error, (x[i] - reference).norm() / reference.norm());
+    }
+    return error;
+}
+
+/**
+ * benchmarks the solvers over random and ill conditioned systems.
+ * @param bench to measure with
+ */
+static void solvers(Bench &bench)
+{
+    for (size_t count : {(size_t) CACHED, (size_t) SYSTEMS})
+    {
+        vector<Vector3D> b = bench_points(count), x(count);
+        vector<Matrix3D> out(count);
+        for (bool ill : {false, true})
+        {
+            const string kind = (ill ? " ill conditioned/" : "/") + to_string(count);
+            const vector<Matrix3D> a = ill ? illConditioned(count, 1) : bench_matrices(count);
+            auto elimination = [&]() {
+                for (size_t i = 0; i < count; ++ i)
+                {
+                    eliminate(a[i], b[i], x[i].data());
+                }
+            };
+            elimination();
+            bench.measure("loop Gaussian elimination" + kind, count, [&]() {
+                elimination();
+                keep(x);
+            }).max_error = maxError(a, b, x);
+            // the ill conditioned systems are solved, not rejected: no singularity test
+            auto closed = [&]() {
+                for (size_t i = 0; i < count; ++ i)
+                {
+                    x[i] = solve(a[i], b[i], 0.0);
+                }
+            };
+            closed();
+            bench.measure("loop solve(Matrix3D, Vector3D)" + kind, count, [&]() {
+                closed();
+                keep(x);
+            }).max_error = maxError(a, b, x);
+            solve_batch(a, b, x, 0);
+            bench.measure("solve_batch" + kind, count, [&]() {
+                keep(solve_batch(a, b, x, 0));
+                keep(x);
+            }).max_error = maxError(a, b, x);
+            bench.measure("loop Matrix3D::inverse" + kind, count, [&]() {
+                for (size_t i = 0; i < count; ++ i)
+                {
+                    out[i] = a[i].inverse(0);
+                }
+                keep(out);
+            });
+            bench.measure("inverse_batch" + kind, count, [&]() {
+                keep(inverse_batch(a, out, 0));
+                keep(out);
+            });
+        }
+    }
+}
+
+BENCHMARK(solvers);
@@ -0,0 +1,100 @@
+// Created by liorP.
+//
+
+#ifndef EX1_SPAN_H
+#define EX1_SPAN_H
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+/**
+ * A non owning view of a contiguous range of T (a minimal std::span for c++17).
+ * Span<const T> is the read only view, and converts implicitly from Span<T>.
+ */
+template<typename T>
+class Span
+{
+public:
+    /**
+     * A default constructor - the empty span.
+     */
+    constexpr Span() : _data(nullptr), _size(0) {}
+
+    /**
+     * A constructor.
+     * @param data first element of the range
+     * @param size number of elements in the range
+     */
+    constexpr Span(T *data, size_t size) : _data(data), _size(size) {}
+
+    /**
+     * A constructor - views the whole vector, of any allocator.
+     * @param vec vector to view
+     */
+    template<typename U, typename A, typename = enable_if_t<is_same<const U, T>::value || is_same<U, T>::value>>
+    Span(vector<U, A> &vec) : _data(vec.data()), _size(vec.size()) {}
+
+    /**
+     * A constructor - read only view of the whole vector, of any allocator.
+     * @param vec vector to view
+     */
+    template<typename U, typename A, typename = enable_if_t<is_same<const U, T>::value>>
+    Span(const vector<U, A> &vec) : _data(vec.data()), _size(vec.size()) {}
+
+    /**
+     * A constructor - Span<T> to Span<const T>.
+     * @param other span to view
+     */
+    template<typename U, typename = enable_if_t<is_same<const U, T>::value>>
+    constexpr Span(const Span<U> &other) : _data(other.data()), _size(other.size()) {}
+
+    /**
+     *[] operator overload
+     * @param i index of element
+     * @return reference to the element
+     */
+    constexpr T &operator[](size_t i) const { return _data[i]; }
+
+    /**
+     * @return first element of the range
+     */
+    constexpr T *data() const { return _data; }
+
+    /**
+     * @return number of elements in the range
+     */
+    constexpr size_t size() const { return _size; }
+
+    /**
+     * @return true if the range is empty
+     */
+    constexpr bool empty() const { return _size == 0; }
+
+    /**
+     * @return iterator to the first element
+     */
+    constexpr T *begin() const { return _data; }
+
+    /**
+     * @return iterator past the last element
+     */
+    constexpr T *end() const { return _data + _size; }
+
+    /**
+     * returns a part of this range.
+     * @param offset index of the first element of the part
+     * @param count number of elements in the part
+     * @return the part
+     */
+    constexpr Span subspan(size_t offset, size_t count) const { return Span(_data + offset, count); }
+
+private:
+    T *_data; /**< first element of the range. */
+    size_t _size; /**< number of elements in the range. */
+
+};
+
+#endif //EX1_SPAN_H
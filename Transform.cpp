@@ -0,0 +1,312 @@
+// Created by liorP.
+//
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include "Simd.h"
+#include "Transform.h"
+
+#define SIZE_ERROR "Input and output sizes differ"
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the batched transform engine.
+// --------------------------------------------------------------------------------------
+
+static_assert(sizeof(Vector3D) == 3 * sizeof(double) && is_standard_layout<Vector3D>::value,
+              "the kernels read Vector3D arrays as interleaved doubles");
+static_assert(sizeof(Matrix3D) == 9 * sizeof(double) && is_standard_layout<Matrix3D>::value,
+              "the kernels read Matrix3D arrays as row major doubles");
+
+namespace
+{
+#if defined(__AVX2__) && defined(__FMA__)
+/**
+ * loads the 3 rows of a row major matrix, a row per register (the 4th lane is garbage).
+ * the last row is loaded from element 5 and shifted, so nothing past the matrix is read.
+ * @param m the 9 elements
+ * @param rows the rows
+ */
+inline void loadRows(const double *m, __m256d rows[3])
+{
+    rows[0] = _mm256_loadu_pd(m);
+    rows[1] = _mm256_loadu_pd(m + 3);
+    rows[2] = _mm256_permute4x64_pd(_mm256_loadu_pd(m + 5), 0xf9);
+}
+
+/**
+ * stores 3 rows as a row major matrix. each 4 wide store spills a lane into the next row,
+ * which that row's store then overwrites, and the last row is stored 2 + 1.
+ * @param rows the rows
+ * @param m the 9 elements
+ */
+inline void storeRows(const __m256d rows[3], double *m)
+{
+    _mm256_storeu_pd(m, rows[0]);
+    _mm256_storeu_pd(m + 3, rows[1]);
+    _mm_storeu_pd(m + 6, _mm256_castpd256_pd128(rows[2]));
+    _mm_store_sd(m + 8, _mm256_extractf128_pd(rows[2], 1));
+}
+#endif
+
+/**
+ * out = a * b, on row major matrices. both are fully loaded before out is stored, so out
+ * may be a or b.
+ * @param a the left matrix
+ * @param b the right matrix
+ * @param out the product
+ */
+inline void product(const double *a, const double *b, double *out)
+{
+#if defined(__AVX2__) && defined(__FMA__)
+    __m256d rows[3], result[3];
+    loadRows(b, rows);
+    for (int i = 0; i < 3; ++ i)
+    {
+        result[i] = _mm256_fmadd_pd(_mm256_broadcast_sd(a + 3 * i + 2), rows[2],
+                                    _mm256_fmadd_pd(_mm256_broadcast_sd(a + 3 * i + 1), rows[1],
+                                                    _mm256_mul_pd(_mm256_broadcast_sd(a + 3 * i), rows[0])));
+    }
+    storeRows(result, out);
+#else
+    double result[9];
+    for (int i = 0; i < 3; ++ i)
+    {
+        for (int j = 0; j < 3; ++ j)
+        {
+            result[3 * i + j] = a[3 * i] * b[j] + a[3 * i + 1] * b[3 + j] + a[3 * i + 2] * b[6 + j];
+        }
+    }
+    copy(result, result + 9, out);
+#endif
+}
+
+/**
+ * The matrix and translation, broadcast once into SIMD registers and kept as scalars for the tails.
+ * the translation is the addend of the first fma, so the linear transform pays nothing for a zero one.
+ */
+struct TransformKernel
+{
+    simd_t m[9]; /**< element (row, col) broadcast at m[3 * row + col]. */
+    double s[9]; /**< element (row, col) at s[3 * row + col]. */
+    simd_t t[3]; /**< the translation, broadcast. */
+    double u[3]; /**< the translation. */
+
+    /**
+     * A constructor.
+     * @param matrix to broadcast
+     * @param translation added after the matrix
+     */
+    TransformKernel(const Matrix3D &matrix, const Vector3D &translation)
+    {
+        for (int row = 0; row < 3; ++ row)
+        {
+            Vector3D line = matrix[row];
+            for (int col = 0; col < 3; ++ col)
+            {
+                s[3 * row + col] = line[col];
+                m[3 * row + col] = simd_set(line[col]);
+            }
+            u[row] = translation[row];
+            t[row] = simd_set(translation[row]);
+        }
+    }
+
+    /**
+     * transforms a single point.
+     * @param in interleaved x, y, z of the point
+     * @param out interleaved x, y, z of the result, may be in
+     */
+    void point(const double *in, double *out) const
+    {
+        double x = in[0], y = in[1], z = in[2];
+        out[0] = s[0] * x + u[0] + s[1] * y + s[2] * z;
+        out[1] = s[3] * x + u[1] + s[4] * y + s[5] * z;
+        out[2] = s[6] * x + u[2] + s[7] * y + s[8] * z;
+    }
+
+    /**
+     * transforms points, 8 at a time with AVX-512 or 4 with AVX2, and one at a time after.
+     * each group is fully loaded before it is stored, so in and out may alias.
+     * @param in interleaved x, y, z of the points
+     * @param out interleaved x, y, z of the results
+     * @param n number of points
+     */
+    void block(const double *in, double *out, size_t n) const
+    {
+        size_t i = 0;
+#if defined(__AVX512F__)
+        // 8 points are 3 registers of interleaved x y z, split into x, y and z registers
+        // with two 2-source permutes each, then merged back the same way.
+        static const int64_t splitX[2][8] = {{0, 3, 6, 9, 12, 15, 0, 0}, {0, 1, 2, 3, 4, 5, 10, 13}};
+        static const int64_t splitY[2][8] = {{1, 4, 7, 10, 13, 0, 0, 0}, {0, 1, 2, 3, 4, 8, 11, 14}};
+        static const int64_t splitZ[2][8] = {{2, 5, 8, 11, 14, 0, 0, 0}, {0, 1, 2, 3, 4, 9, 12, 15}};
+        static const int64_t merge0[2][8] = {{0, 8, 0, 1, 9, 0, 2, 10}, {0, 1, 8, 3, 4, 9, 6, 7}};
+        static const int64_t merge1[2][8] = {{0, 3, 11, 0, 4, 12, 0, 5}, {10, 1, 2, 11, 4, 5, 12, 7}};
+        static const int64_t merge2[2][8] = {{13, 0, 6, 14, 0, 7, 15, 0}, {0, 13, 2, 3, 14, 5, 6, 15}};
+        auto index = [](const int64_t *idx) { return _mm512_loadu_si512(idx); };
+        const __m512i sx0 = index(splitX[0]), sx1 = index(splitX[1]);
+        const __m512i sy0 = index(splitY[0]), sy1 = index(splitY[1]);
+        const __m512i sz0 = index(splitZ[0]), sz1 = index(splitZ[1]);
+        const __m512i m00 = index(merge0[0]), m01 = index(merge0[1]);
+        const __m512i m10 = index(merge1[0]), m11 = index(merge1[1]);
+        const __m512i m20 = index(merge2[0]), m21 = index(merge2[1]);
+        for (; i + 8 <= n; i += 8)
+        {
+            const double *p = in + 3 * i;
+            __m512d v0 = _mm512_loadu_pd(p), v1 = _mm512_loadu_pd(p + 8), v2 = _mm512_loadu_pd(p + 16);
+            __m512d x = _mm512_permutex2var_pd(_mm512_permutex2var_pd(v0, sx0, v1), sx1, v2);
+            __m512d y = _mm512_permutex2var_pd(_mm512_permutex2var_pd(v0, sy0, v1), sy1, v2);
+            __m512d z = _mm512_permutex2var_pd(_mm512_permutex2var_pd(v0, sz0, v1), sz1, v2);
+            __m512d rx = simd_fmadd(m[2], z, simd_fmadd(m[1], y, simd_fmadd(m[0], x, t[0])));
+            __m512d ry = simd_fmadd(m[5], z, simd_fmadd(m[4], y, simd_fmadd(m[3], x, t[1])));
+            __m512d rz = simd_fmadd(m[8], z, simd_fmadd(m[7], y, simd_fmadd(m[6], x, t[2])));
+            double *q = out + 3 * i;
+            _mm512_storeu_pd(q, _mm512_permutex2var_pd(_mm512_permutex2var_pd(rx, m00, ry), m01, rz));
+            _mm512_storeu_pd(q + 8, _mm512_permutex2var_pd(_mm512_permutex2var_pd(rx, m10, ry), m11, rz));
+            _mm512_storeu_pd(q + 16, _mm512_permutex2var_pd(_mm512_permutex2var_pd(rx, m20, ry), m21, rz));
+        }
+#elif defined(__AVX2__)
+        // 4 points are 3 registers of interleaved x y z. the lane swaps gather points 0 and 1
+        // in the low halves and points 2 and 3 in the high ones, where in-lane shuffles split
+        // them into x, y and z registers. the merge is the same steps backwards.
+        for (; i + 4 <= n; i += 4)
+        {
+            const double *p = in + 3 * i;
+            __m256d v0 = _mm256_loadu_pd(p), v1 = _mm256_loadu_pd(p + 4), v2 = _mm256_loadu_pd(p + 8);
+            __m256d xy = _mm256_permute2f128_pd(v0, v1, 0x30); // x0 y0 | x2 y2
+            __m256d zx = _mm256_permute2f128_pd(v0, v2, 0x21); // z0 x1 | z2 x3
+            __m256d yz = _mm256_permute2f128_pd(v1, v2, 0x30); // y1 z1 | y3 z3
+            __m256d x = _mm256_shuffle_pd(xy, zx, 0xa), y = _mm256_shuffle_pd(xy, yz, 0x5);
+            __m256d z = _mm256_shuffle_pd(zx, yz, 0xa);
+            __m256d rx = simd_fmadd(m[2], z, simd_fmadd(m[1], y, simd_fmadd(m[0], x, t[0])));
+            __m256d ry = simd_fmadd(m[5], z, simd_fmadd(m[4], y, simd_fmadd(m[3], x, t[1])));
+            __m256d rz = simd_fmadd(m[8], z, simd_fmadd(m[7], y, simd_fmadd(m[6], x, t[2])));
+            xy = _mm256_shuffle_pd(rx, ry, 0x0);
+            zx = _mm256_shuffle_pd(rz, rx, 0xa);
+            yz = _mm256_shuffle_pd(ry, rz, 0xf);
+            double *q = out + 3 * i;
+            _mm256_storeu_pd(q, _mm256_permute2f128_pd(xy, zx, 0x20));
+            _mm256_storeu_pd(q + 4, _mm256_permute2f128_pd(yz, xy, 0x30));
+            _mm256_storeu_pd(q + 8, _mm256_permute2f128_pd(zx, yz, 0x31));
+        }
+#endif
+        for (; i < n; ++ i)
+        {
+            point(in + 3 * i, out + 3 * i);
+        }
+    }
+};
+}
+
+/**
+* out[i] = matrix * in[i]
+* @param matrix to multiply with
+* @param in points to transform
+* @param out transformed points, same size as in. may be the same range as in
+*/
+void transform_batch(const Matrix3D &matrix, const Span<const Vector3D> in, const Span<Vector3D> out)
+{
+    transform_batch(matrix, Vector3D(), in, out);
+}
+
+/**
+* points[i] = matrix * points[i]
+* @param matrix to multiply with
+* @param points points to transform in place
+*/
+void transform_batch(const Matrix3D &matrix, const Span<Vector3D> points)
+{
+    transform_batch(matrix, points, points);
+}
+
+/**
+* out[i] = matrix * in[i] + translation, in a single pass
+* @param matrix to multiply with
+* @param translation to add
+* @param in points to transform
+* @param out transformed points, same size as in. may be the same range as in
+*/
+void transform_batch(const Matrix3D &matrix, const Vector3D &translation, const Span<const Vector3D> in,
+                     const Span<Vector3D> out)
+{
+    INSTRUMENT_SCOPE("transform_batch");
+    if (in.size() != out.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return;
+    }
+    TransformKernel(matrix, translation).block(reinterpret_cast<const double *>(in.data()),
+                                               reinterpret_cast<double *>(out.data()), in.size());
+}
+
+/**
+* out[i] = a[i] * b[i]
+* @param a left matrices
+* @param b right matrices, same size as a
+* @param out the products, same size as a. may be the same range as a or b
+*/
+void multiply_batch(const Span<const Matrix3D> a, const Span<const Matrix3D> b, const Span<Matrix3D> out)
+{
+    INSTRUMENT_SCOPE("multiply_batch");
+    if (a.size() != b.size() || a.size() != out.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return;
+    }
+    const double *pa = reinterpret_cast<const double *>(a.data());
+    const double *pb = reinterpret_cast<const double *>(b.data());
+    double *po = reinterpret_cast<double *>(out.data());
+    for (size_t i = 0; i < a.size(); ++ i)
+    {
+        product(pa + 9 * i, pb + 9 * i, po + 9 * i);
+    }
+}
+
+/**
+* out[i] = chain[0] * chain[1] * ... * chain[i]
+* @param chain matrices to multiply
+* @param out the prefix products, same size as chain. may be the same range as chain
+*/
+void prefix_product(const Span<const Matrix3D> chain, const Span<Matrix3D> out)
+{
+    INSTRUMENT_SCOPE("prefix_product");
+    if (chain.size() != out.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return;
+    }
+    if (chain.empty())
+    {
+        return;
+    }
+    const double *in = reinterpret_cast<const double *>(chain.data());
+    double *po = reinterpret_cast<double *>(out.data());
+#if defined(__AVX2__) && defined(__FMA__)
+    // the running product stays in registers, its elements broadcast in register, so a step
+    // waits on a permute and 3 fmas instead of a store and reload
+    __m256d acc[3], rows[3];
+    auto step = [&](__m256d row) {
+        return _mm256_fmadd_pd(_mm256_permute4x64_pd(row, 0xaa), rows[2],
+                               _mm256_fmadd_pd(_mm256_permute4x64_pd(row, 0x55), rows[1],
+                                               _mm256_mul_pd(_mm256_permute4x64_pd(row, 0x00), rows[0])));
+    };
+    loadRows(in, acc);
+    storeRows(acc, po);
+    for (size_t n = 1; n < chain.size(); ++ n)
+    {
+        loadRows(in + 9 * n, rows);
+        // spelled out, a loop over the rows is not unrolled at -O2 and keeps acc in memory
+        acc[0] = step(acc[0]);
+        acc[1] = step(acc[1]);
+        acc[2] = step(acc[2]);
+        storeRows(acc, po + 9 * n);
+    }
+#else
+    copy(in, in + 9, po);
+    for (size_t n = 1; n < chain.size(); ++ n)
+    {
+        product(po + 9 * (n - 1), in + 9 * n, po + 9 * n);
+    }
+#endif
+}
@@ -0,0 +1,63 @@
+// Created by liorP.
+//
+
+#ifndef EX1_TRANSFORM_H
+#define EX1_TRANSFORM_H
+
+#include "Matrix3D.h"
+#include "Span.h"
+
+// --------------------------------------------------------------------------------------
+// Batched Matrix3D * Vector3D (+ Vector3D) transform over arrays of Vector3D (AoS).
+// The matrix is broadcast into registers once. With AVX-512 the points are transformed 8 at
+// a time: 3 loads of interleaved x y z are split into x, y and z registers by permutes, go
+// through 9 fmas and are merged back by permutes into 3 stores, all in registers. With AVX2
+// the same is done 4 points at a time, with lane swaps and in-lane shuffles. Without either,
+// and for the last points, a scalar loop transforms a point at a time.
+// Batched Matrix3D * Matrix3D products over arrays of Matrix3D, pair by pair and along a
+// chain. Every row of a product is a combination of the rows of the right matrix, one
+// AVX register per row.
+// --------------------------------------------------------------------------------------
+
+/**
+ * out[i] = matrix * in[i]
+ * @param matrix to multiply with
+ * @param in points to transform
+ * @param out transformed points, same size as in. may be the same range as in
+ */
+void transform_batch(const Matrix3D &matrix, Span<const Vector3D> in, Span<Vector3D> out);
+
+/**
+ * points[i] = matrix * points[i]
+ * @param matrix to multiply with
+ * @param points points to transform in place
+ */
+void transform_batch(const Matrix3D &matrix, Span<Vector3D> points);
+
+/**
+ * out[i] = matrix * in[i] + translation, in a single pass
+ * @param matrix to multiply with
+ * @param translation to add
+ * @param in points to transform
+ * @param out transformed points, same size as in. may be the same range as in
+ */
+void transform_batch(const Matrix3D &matrix, const Vector3D &translation, Span<const Vector3D> in,
+                     Span<Vector3D> out);
+
+/**
+ * out[i] = a[i] * b[i]
+ * @param a left matrices
+ * @param b right matrices, same size as a
+ * @param out the products, same size as a. may be the same range as a or b
+ */
+void multiply_batch(Span<const Matrix3D> a, Span<const Matrix3D> b, Span<Matrix3D> out);
+
+/**
+ * out[i] = chain[0] * chain[1] * ... * chain[i], e.g. the global transforms of a chain of
+ * joints from their local ones.
+ * @param chain matrices to multiply
+ * @param out the prefix products, same size as chain. may be the same range as chain
+ */
+void prefix_product(Span<const Matrix3D> chain, Span<Matrix3D> out);
+
+#endif //EX1_TRANSFORM_H
@@ -0,0 +1,584 @@
+// Created by liorP.
+//
+
+#ifndef EX1_VECTOR_H
+#define EX1_VECTOR_H
+
+#include <cmath>
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+#include "Bounds.h"
+#include "Errors.h"
+#include "Instrument.h"
+
+using namespace std;
+
+/**
+ * calls f(0), f(1) ... f(N - 1), unrolled at compile time.
+ * @param f callable taking an index
+ */
+template<typename F, size_t... I>
+constexpr void unroll(F &&f, index_sequence<I...>)
+{
+    (f(I), ...);
+}
+
+/**
+ * calls f(0), f(1) ... f(N - 1), unrolled at compile time.
+ * @param f callable taking an index
+ */
+template<size_t N, typename F>
+constexpr void unroll(F &&f)
+{
+    unroll(f, make_index_sequence<N>());
+}
+
+/**
+ * A Vector class.
+ * This class represents a vector with N coordinates of type T.
+ * All the arithmetic is defined inline in this header (and is constexpr where the std allows it),
+ * with the loops over the coordinates unrolled at compile time, so it can be fully inlined into
+ * the caller's loops and evaluated at compile time.
+ */
+template<size_t N, typename T = double>
+class Vector
+{
+public:
+    /**
+     * the type of a coordinate.
+     */
+    typedef T value_type;
+
+    /**
+     * number of coordinates.
+     */
+    static constexpr size_t dimension = N;
+
+    /**
+     * A constructor.
+     * inits with N coordinates.
+     * @param coordinates N numbers
+     */
+    template<typename... Args, typename = enable_if_t<sizeof...(Args) == N &&
+                                                      conjunction<is_arithmetic<Args>...>::value>>
+    constexpr Vector(Args... coordinates) : _data{static_cast<T>(coordinates)...} {}
+
+    /**
+     * A default constructor.
+     * inits the zero vector
+     */
+    constexpr Vector() : _data{} {}
+
+    /**
+     * A constructor.
+     * @param arr array of N coordinates for the vector
+     */
+    constexpr explicit Vector(const T arr[N]) : _data{}
+    {
+        unroll<N>([&](size_t i) { _data[i] = arr[i]; });
+    }
+
+    /**
+     * A copy constructor - trivial, so Vector is trivially copyable and bulk copies are memcpy.
+     * @param vector
+     */
+    constexpr Vector(const Vector &vector) = default;
+
+    /**
+     * + operator overload
+     * @param vector2 a vector to be added
+     * @return result of 2 vectors addition- Vector
+     */
+    constexpr Vector operator+(const Vector &vector2) const;
+
+    /**
+     * - operator overload
+     * @param vector2 a vector to be deducted
+     * @return result of 2 vectors deduction- Vector
+     */
+    constexpr Vector operator-(const Vector &vector2) const;
+
+    /**
+     * += operator overload. changes the original vector
+     * @param other vector to be added to the current
+     * @return reference to this vector
+     */
+    constexpr Vector &operator+=(const Vector &other);
+
+    /**
+     * -= operator overload. changes the original vector
+     * @param other vector to be deducted from the current
+     * @return reference to this vector
+     */
+    constexpr Vector &operator-=(const Vector &other);
+
+    /**
+     * += operator over load between vector & scalar.
+     * add the scalar to each of the coordinates
+     * @param num scalar to add
+     * @return reference to this vector
+     */
+    constexpr Vector &operator+=(T num);
+
+    /**
+     * -= operator over load between vector & scalar.
+     * deduct the scalar from each of the coordinates
+     * @param num scalar to deduct
+     * @return reference to this vector
+     */
+    constexpr Vector &operator-=(T num);
+
+    /**
+     * - operator overload.
+     * doubles the vector by -1.
+     * @return Vector
+     */
+    constexpr Vector operator-() const;
+
+    /**
+     * * operator overload
+     * @param scalar to increase the vector by
+     * @return Vector
+     */
+    constexpr Vector operator*(T scalar) const;
+
+    /**
+     * / operator overload
+     * @param scalar to decrease the vector by
+     * @return Vector
+     */
+    constexpr Vector operator/(T scalar) const;
+
+    /**
+     * *= operator overload
+     * changes the original vector to be multiplied by a certain scalar.
+     * @param scalar to increase the vector by
+     * @return reference to this vector
+     */
+    constexpr Vector &operator*=(T scalar);
+
+    /**
+     * /= operator overload
+     * changes the original vector to be divided by a certain scalar.
+     * @param scalar to divide the vector by
+     * @return reference to this vector
+     */
+    constexpr Vector &operator/=(T scalar);
+
+    /**
+     *[] operator overload. the index is checked according to BOUNDS_CHECK (see Bounds.h).
+     * @param i index of coordinate to approach to
+     * @return the i'th coordinate of the vector
+     */
+    constexpr T &operator[](int i);
+
+    /**
+     *[] const operator overload. the index is checked according to BOUNDS_CHECK (see Bounds.h).
+     * @param i index of coordinate to approach to
+     * @return the i'th coordinate of the vector
+     */
+    constexpr const T &operator[](int i) const;
+
+    /**
+     * @return the N coordinates, for unchecked indexing
+     */
+    constexpr T *data() { return _data; }
+
+    /**
+     * @return the N coordinates, for unchecked indexing
+     */
+    constexpr const T *data() const { return _data; }
+
+    /**
+     * | operator overload
+     * gives the distance between 2 vectors
+     * @param vector2 vector to calculate dist from
+     * @return distance
+     */
+    inline T operator|(const Vector &vector2) const;
+
+    /**
+     * * operator overload as dot product of 2 vectors
+     * @param vector2 to calculate dot product to
+     * @return dot product
+     */
+    constexpr T operator*(const Vector &vector2) const;
+
+    /**
+     * ^ operator overload. calculate angle between vectors.
+     * @param vector2 calculate angle to
+     * @return angle in radians
+     */
+    inline T operator^(const Vector &vector2) const;
+
+    /**
+     * = operator overload - trivial, like the copy constructor.
+     * @param other vector to copy from
+     * @return reference to the new vector
+     */
+    constexpr Vector &operator=(const Vector &other) = default;
+
+    /**
+     * returns the norm of the vector
+     * @return norm
+     */
+    inline T norm() const;
+
+    /**
+     *calculates the distance between this vector and another
+     * @param other vector to calculate dist from
+     * @return distance
+     */
+    inline T dist(const Vector &other) const;
+
+    /**
+     * returns the squared norm of the vector, the norm without the square root.
+     * @return squared norm
+     */
+    constexpr T norm_squared() const;
+
+    /**
+     * calculates the squared distance between this vector and another, without the square root.
+     * @param other vector to calculate dist from
+     * @return squared distance
+     */
+    constexpr T dist_squared(const Vector &other) const;
+
+private:
+    T _data[N]; /**< the coordinates. */
+
+};
+
+// --------------------------------------------------------------------------------------
+// Inline implementation of the class Vector.
+// --------------------------------------------------------------------------------------
+
+// ------------------ Operators Overloading ------------------------
+
+/**
+* + operator overload
+* @param vector2 a vector to be added
+* @return result of 2 vectors addition- Vector
+*/
+template<size_t N, typename T>
+constexpr Vector<N, T> Vector<N, T>::operator+(const Vector &vector2) const
+{
+    auto ans = Vector(*this);
+    ans += vector2;
+    return ans;
+}
+
+/**
+* - operator overload
+* @param vector2 a vector to be deducted
+* @return result of 2 vectors deduction- Vector
+*/
+template<size_t N, typename T>
+constexpr Vector<N, T> Vector<N, T>::operator-(const Vector &vector2) const
+{
+    auto ans = Vector(*this);
+    ans -= vector2;
+    return ans;
+}
+
+/**
+* += operator overload. changes the original vector
+* @param other vector to be added to the current
+* @return reference to this vector
+*/
+template<size_t N, typename T>
+constexpr Vector<N, T> &Vector<N, T>::operator+=(const Vector &other)
+{
+    unroll<N>([&](size_t i) { _data[i] += other._data[i]; });
+    return *this;
+}
+
+/**
+* -= operator overload. changes the original vector
+* @param other vector to be deducted from the current
+* @return reference to this vector
+*/
+template<size_t N, typename T>
+constexpr Vector<N, T> &Vector<N, T>::operator-=(const Vector &other)
+{
+    unroll<N>([&](size_t i) { _data[i] -= other._data[i]; });
+    return *this;
+}
+
+/**
+* - operator overload.
+* doubles the vector by -1.
+* @return Vector
+*/
+template<size_t N, typename T>
+constexpr Vector<N, T> Vector<N, T>::operator-() const
+{
+    Vector ans;
+    unroll<N>([&](size_t i) { ans._data[i] = - _data[i]; });
+    return ans;
+}
+
+/**
+* * operator overload
+* @param scalar to increase the vector by
+* @return Vector
+*/
+template<size_t N, typename T>
+constexpr Vector<N, T> Vector<N, T>::operator*(const T scalar) const
+{
+    // multi each coordinate by the scalar
+    Vector ans;
+    unroll<N>([&](size_t i) { ans._data[i] = _data[i] * scalar; });
+    return ans;
+}
+
+/**
+* / operator overload
+* @param scalar to decrease the vector by
+* @return Vector
+*/
+template<size_t N, typename T>
+constexpr Vector<N, T> Vector<N, T>::operator/(const T scalar) const
+{
+    if (error_if(scalar == 0))
+    {
+        report_error(ERROR_ZERO);
+    }
+    return *this * (1 / scalar);
+}
+
+/**
+* *= operator overload
+* changes the original vector to be multiplied by a certain scalar.
+* @param scalar to increase the vector by
+* @return reference to this vector
+*/
+template<size_t N, typename T>
+constexpr Vector<N, T> &Vector<N, T>::operator*=(const T scalar)
+{
+    unroll<N>([&](size_t i) { _data[i] *= scalar; });
+    return *this;
+}
+
+/**
+* /= operator overload
+* changes the original vector to be divided by a certain scalar.
+* @param scalar to divide the vector by
+* @return reference to this vector
+*/
+template<size_t N, typename T>
+constexpr Vector<N, T> &Vector<N, T>::operator/=(const T scalar)
+{
+    if (error_if(scalar == 0))
+    {
+        report_error(ERROR_ZERO);
+        return *this;
+    }
+    return *this *= (1 / scalar);
+}
+
+/**
+* | operator overload
+* gives the distance between 2 vectors
+* @param vector2 vector to calculate dist from
+* @return distance
+*/
+template<size_t N, typename T>
+inline T Vector<N, T>::operator|(const Vector &vector2) const
+{
+    return std::sqrt(dist_squared(vector2));
+}
+
+/**
+* * operator overload as dot product of 2 vectors
+* @param vector2 to calculate dot product to
+* @return dot product
+*/
+template<size_t N, typename T>
+constexpr T Vector<N, T>::operator*(const Vector &vector2) const
+{
+    //dot product of 2 vectors
+    T ans = 0;
+    unroll<N>([&](size_t i) { ans += _data[i] * vector2._data[i]; });
+    return ans;
+}
+
+/**
+* ^ operator overload. calculate angle between vectors.
+* @param vector2 calculate angle to
+* @return angle in radians
+*/
+template<size_t N, typename T>
+inline T Vector<N, T>::operator^(const Vector &vector2) const
+{
+    //angle formula
+    return acos(*this * vector2 / (this->norm() * vector2.norm()));
+}
+
+/**
+*[] operator overload. the index is checked according to BOUNDS_CHECK (see Bounds.h).
+* @param i index of coordinate to approach to
+* @return the i'th coordinate of the vector
+*/
+template<size_t N, typename T>
+constexpr T &Vector<N, T>::operator[](const int i)
+{
+    return _data[checked_index<N>(i)];
+}
+
+/**
+*[] const operator overload. the index is checked according to BOUNDS_CHECK (see Bounds.h).
+* @param i index of coordinate to approach to
+* @return the i'th coordinate of the vector
+*/
+template<size_t N, typename T>
+constexpr const T &Vector<N, T>::operator[](const int i) const
+{
+    return _data[checked_index<N>(i)];
+}
+
+/**
+* += operator over load between vector & scalar.
+* add the scalar to each of the coordinates
+* @param num scalar to add
+* @return reference to this vector
+*/
+template<size_t N, typename T>
+constexpr Vector<N, T> &Vector<N, T>::operator+=(const T num)
+{
+    unroll<N>([&](size_t i) { _data[i] += num; });
+    return *this;
+}
+
+/**
+* -= operator over load between vector & scalar.
+* deduct the scalar from each of the coordinates
+* @param num scalar to deduct
+* @return reference to this vector
+*/
+template<size_t N, typename T>
+constexpr Vector<N, T> &Vector<N, T>::operator-=(const T num)
+{
+    unroll<N>([&](size_t i) { _data[i] -= num; });
+    return *this;
+}
+
+// ------------------ Other methods ------------------------
+
+/**
+* returns the norm of the vector
+* @return norm
+*/
+template<size_t N, typename T>
+inline T Vector<N, T>::norm() const
+{
+    INSTRUMENT_CALL("Vector::norm");
+    return std::sqrt(norm_squared());
+}
+
+/**
+*calculates the distance between this vector and another
+* @param other vector to calculate dist from
+* @return distance
+*/
+template<size_t N, typename T>
+inline T Vector<N, T>::dist(const Vector &other) const
+{
+    //same as the operator
+    return *this | other;
+}
+
+/**
+* returns the squared norm of the vector, the norm without the square root.
+* @return squared norm
+*/
+template<size_t N, typename T>
+constexpr T Vector<N, T>::norm_squared() const
+{
+    return *this * *this;
+}
+
+/**
+* calculates the squared distance between this vector and another, without the square root.
+* @param other vector to calculate dist from
+* @return squared distance
+*/
+template<size_t N, typename T>
+constexpr T Vector<N, T>::dist_squared(const Vector &other) const
+{
+    T sum = 0;
+    unroll<N>([&](size_t i) {
+        T difference = _data[i] - other._data[i];
+        sum += difference * difference;
+    });
+    return sum;
+}
+
+// ------------------ Free functions ------------------------
+
+/**
+* * operator overload - multiply vector by scalar
+* @param scalar to multiply by
+* @param other vector to multiply
+* @return the result vector
+*/
+template<size_t N, typename T>
+constexpr Vector<N, T> operator*(typename Vector<N, T>::value_type scalar, const Vector<N, T> &other)
+{
+    return other * scalar;
+}
+
+/**
+* gives the cross product of two 3D vectors.
+* @param a left vector
+* @param b right vector
+* @return a x b
+*/
+template<typename T>
+constexpr Vector<3, T> cross(const Vector<3, T> &a, const Vector<3, T> &b)
+{
+    const T *p = a.data(), *q = b.data();
+    return Vector<3, T>(p[1] * q[2] - p[2] * q[1], p[2] * q[0] - p[0] * q[2], p[0] * q[1] - p[1] * q[0]);
+}
+
+/**
+* << operator overload, to send data of the vector to out-stream.
+* @param os out-stream
+* @param vector vector to print
+* @return out stream with vector
+*/
+template<size_t N, typename T>
+ostream &operator<<(ostream &os, const Vector<N, T> &vector)
+{
+    INSTRUMENT_SCOPE("operator<<(Vector)");
+    for (int i = 0; i < (int) N; ++ i)
+    {
+        if (i != 0)
+        {
+            os << ' ';
+        }
+        os << vector[i];
+    }
+    return os;
+}
+
+/**
+* >> operator overload, to receive data of vector from in stream.
+* @param is in-stream
+* @param vector vector to receive data into
+* @return in stream
+*/
+template<size_t N, typename T>
+istream &operator>>(istream &is, Vector<N, T> &vector)
+{
+    INSTRUMENT_SCOPE("operator>>(Vector)");
+    for (int i = 0; i < (int) N; ++ i)
+    {
+        is >> vector[i];
+    }
+    return is;
+}
+
+#endif //EX1_VECTOR_H
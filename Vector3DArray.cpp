@@ -0,0 +1,435 @@
+// Created by liorP.
+//
+
+#include <algorithm>
+#include <cfloat>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include "Simd.h"
+#include "Vector3DArray.h"
+
+#define SIZE_ERROR "Input sizes differ"
+
+// --------------------------------------------------------------------------------------
+// This file contains the implementation of the class Vector3DArray and its batch kernels.
+// --------------------------------------------------------------------------------------
+
+/**
+ * number of doubles in a cache line - the granularity of the stream lengths.
+ */
+#define LINE_DOUBLES (SIMD_ALIGN / sizeof(double))
+
+/**
+ * the length of each stream, throws bad_alloc if the three streams would not fit a size_t
+ * of bytes.
+ * @param size number of vectors
+ * @return size rounded up to a multiple of LINE_DOUBLES
+ */
+static size_t streamCapacity(size_t size)
+{
+    if (size > SIZE_MAX / (3 * sizeof(double)) - LINE_DOUBLES)
+    {
+        throw bad_alloc();
+    }
+    return (size + LINE_DOUBLES - 1) / LINE_DOUBLES * LINE_DOUBLES;
+}
+
+/**
+ * allocates the three streams in a single aligned, zeroed block. throws bad_alloc if the
+ * allocation fails or its size does not fit a size_t.
+ * @param capacity length of each stream, a multiple of LINE_DOUBLES
+ * @return the block
+ */
+static double *allocateStreams(size_t capacity)
+{
+    if (capacity == 0)
+    {
+        return nullptr;
+    }
+    if (capacity > SIZE_MAX / (3 * sizeof(double)))
+    {
+        throw bad_alloc();
+    }
+    size_t bytes = 3 * capacity * sizeof(double);
+    auto block = static_cast<double *>(aligned_alloc(SIMD_ALIGN, bytes));
+    if (block == nullptr)
+    {
+        throw bad_alloc();
+    }
+    memset(block, 0, bytes);
+    return block;
+}
+
+// ------------------ Constructors ------------------------
+
+/**
+* A constructor.
+* inits size zero vectors.
+* @param size number of vectors
+*/
+Vector3DArray::Vector3DArray(const size_t size) : _size(size), _capacity(streamCapacity(size))
+{
+    _x = allocateStreams(_capacity);
+    _y = _x + _capacity;
+    _z = _y + _capacity;
+}
+
+/**
+* A constructor - converts from an array of vectors.
+* @param vectors the vectors to copy
+*/
+Vector3DArray::Vector3DArray(const vector<Vector3D> &vectors) : Vector3DArray(vectors.size())
+{
+    for (size_t i = 0; i < _size; ++ i)
+    {
+        set(i, vectors[i]);
+    }
+}
+
+/**
+* A copy constructor.
+* @param other array to copy from
+*/
+Vector3DArray::Vector3DArray(const Vector3DArray &other) : Vector3DArray(other._size)
+{
+    if (_capacity != 0)
+    {
+        memcpy(_x, other._x, 3 * _capacity * sizeof(double));
+    }
+}
+
+/**
+* A move constructor.
+* @param other array to take the streams of
+*/
+Vector3DArray::Vector3DArray(Vector3DArray &&other) noexcept : _size(other._size), _capacity(other._capacity),
+                                                               _x(other._x), _y(other._y), _z(other._z)
+{
+    other._size = 0;
+    other._capacity = 0;
+    other._x = other._y = other._z = nullptr;
+}
+
+/**
+* A destructor.
+*/
+Vector3DArray::~Vector3DArray()
+{
+    free(_x);
+}
+
+// ------------------ Methods ------------------------
+
+/**
+* = operator overload.
+* @param other array to copy from
+* @return reference to this array
+*/
+Vector3DArray &Vector3DArray::operator=(Vector3DArray other) noexcept
+{
+    swap(_size, other._size);
+    swap(_capacity, other._capacity);
+    swap(_x, other._x);
+    swap(_y, other._y);
+    swap(_z, other._z);
+    return *this;
+}
+
+/**
+* resizes the array. kept vectors keep their values, new ones are zero.
+* @param size new number of vectors
+*/
+void Vector3DArray::resize(const size_t size)
+{
+    if (size == _size)
+    {
+        return;
+    }
+    Vector3DArray resized(size);
+    size_t kept = min(size, _size);
+    copy(_x, _x + kept, resized._x);
+    copy(_y, _y + kept, resized._y);
+    copy(_z, _z + kept, resized._z);
+    *this = move(resized);
+}
+
+/**
+* converts back to an array of vectors.
+* @return the vectors of this array
+*/
+vector<Vector3D> Vector3DArray::to_vector() const
+{
+    vector<Vector3D> vectors;
+    vectors.reserve(_size);
+    for (size_t i = 0; i < _size; ++ i)
+    {
+        vectors.push_back((*this)[i]);
+    }
+    return vectors;
+}
+
+// ------------------ Batch kernels ------------------------
+
+/**
+* out[i] = a[i] + b[i]
+* @param a first array
+* @param b second array
+* @param out result array
+*/
+void batch_add(const Vector3DArray &a, const Vector3DArray &b, Vector3DArray &out)
+{
+    INSTRUMENT_SCOPE("batch_add");
+    if (a.size() != b.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return;
+    }
+    out.resize(a.size());
+    const double *ax = a.x(), *ay = a.y(), *az = a.z();
+    const double *bx = b.x(), *by = b.y(), *bz = b.z();
+    double *ox = out.x(), *oy = out.y(), *oz = out.z();
+    size_t n = a.size(), i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        simd_store(ox + i, simd_add(simd_load(ax + i), simd_load(bx + i)));
+        simd_store(oy + i, simd_add(simd_load(ay + i), simd_load(by + i)));
+        simd_store(oz + i, simd_add(simd_load(az + i), simd_load(bz + i)));
+    }
+    for (; i < n; ++ i)
+    {
+        ox[i] = ax[i] + bx[i];
+        oy[i] = ay[i] + by[i];
+        oz[i] = az[i] + bz[i];
+    }
+}
+
+/**
+* out[i] = a[i] * scalar
+* @param a array
+* @param scalar double to multiply by
+* @param out result array
+*/
+void batch_scale(const Vector3DArray &a, const double scalar, Vector3DArray &out)
+{
+    INSTRUMENT_SCOPE("batch_scale");
+    out.resize(a.size());
+    const double *ax = a.x(), *ay = a.y(), *az = a.z();
+    double *ox = out.x(), *oy = out.y(), *oz = out.z();
+    simd_t s = simd_set(scalar);
+    size_t n = a.size(), i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        simd_store(ox + i, simd_mul(simd_load(ax + i), s));
+        simd_store(oy + i, simd_mul(simd_load(ay + i), s));
+        simd_store(oz + i, simd_mul(simd_load(az + i), s));
+    }
+    for (; i < n; ++ i)
+    {
+        ox[i] = ax[i] * scalar;
+        oy[i] = ay[i] * scalar;
+        oz[i] = az[i] * scalar;
+    }
+}
+
+/**
+* out[i] = a[i] * b[i] (dot product)
+* @param a first array
+* @param b second array
+* @param out the dot products
+*/
+void batch_dot(const Vector3DArray &a, const Vector3DArray &b, vector<double> &out)
+{
+    INSTRUMENT_SCOPE("batch_dot");
+    if (a.size() != b.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return;
+    }
+    out.resize(a.size());
+    const double *ax = a.x(), *ay = a.y(), *az = a.z();
+    const double *bx = b.x(), *by = b.y(), *bz = b.z();
+    double *o = out.data();
+    size_t n = a.size(), i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        simd_t dot = simd_mul(simd_load(ax + i), simd_load(bx + i));
+        dot = simd_fmadd(simd_load(ay + i), simd_load(by + i), dot);
+        dot = simd_fmadd(simd_load(az + i), simd_load(bz + i), dot);
+        simd_store(o + i, dot);
+    }
+    for (; i < n; ++ i)
+    {
+        o[i] = ax[i] * bx[i] + ay[i] * by[i] + az[i] * bz[i];
+    }
+}
+
+/**
+* out[i] = a[i].norm()
+* @param a array
+* @param out the norms
+*/
+void batch_norm(const Vector3DArray &a, vector<double> &out)
+{
+    INSTRUMENT_SCOPE("batch_norm");
+    out.resize(a.size());
+    const double *ax = a.x(), *ay = a.y(), *az = a.z();
+    double *o = out.data();
+    size_t n = a.size(), i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        simd_t x = simd_load(ax + i), y = simd_load(ay + i), z = simd_load(az + i);
+        simd_t squared = simd_fmadd(z, z, simd_fmadd(y, y, simd_mul(x, x)));
+        simd_store(o + i, simd_sqrt(squared));
+    }
+    for (; i < n; ++ i)
+    {
+        o[i] = sqrt(ax[i] * ax[i] + ay[i] * ay[i] + az[i] * az[i]);
+    }
+}
+
+/**
+* normalizes a vector. where its squared norm would underflow or overflow (a norm outside
+* about 1.5e-154 to 1.3e154), it is scaled by a power of two first, which is exact.
+* @param x first coordinate
+* @param y second coordinate
+* @param z third coordinate
+* @param out receives the unit vector, zero for the zero vector
+* @param i index in out
+*/
+static void normalizeScaled(double x, double y, double z, Vector3DArray &out, size_t i)
+{
+    double squared = x * x + y * y + z * z;
+    if (! (squared >= DBL_MIN && squared <= DBL_MAX))
+    {
+        const double largest = max(abs(x), max(abs(y), abs(z)));
+        if (largest > 0 && isfinite(largest))
+        {
+            int exponent;
+            frexp(largest, &exponent);
+            x = ldexp(x, - exponent);
+            y = ldexp(y, - exponent);
+            z = ldexp(z, - exponent);
+            squared = x * x + y * y + z * z;
+        }
+    }
+    // clamping the squared norm away from zero keeps zero vectors at zero instead of 0 * inf
+    const double scale = 1 / sqrt(max(squared, DBL_MIN));
+    out.x()[i] = x * scale;
+    out.y()[i] = y * scale;
+    out.z()[i] = z * scale;
+}
+
+/**
+* out[i] = a[i] / a[i].norm(), scaled by a reciprocal square root instead of a division.
+* zero vectors stay zero.
+* @param a array
+* @param out result array, may be a itself
+*/
+void batch_normalize(const Vector3DArray &a, Vector3DArray &out)
+{
+    INSTRUMENT_SCOPE("batch_normalize");
+    out.resize(a.size());
+    const double *ax = a.x(), *ay = a.y(), *az = a.z();
+    double *ox = out.x(), *oy = out.y(), *oz = out.z();
+    size_t n = a.size(), i = 0;
+    // a block with a zero, tiny or huge vector is done one vector at a time
+    const simd_t smallest = simd_set(DBL_MIN), largest = simd_set(DBL_MAX);
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        simd_t x = simd_load(ax + i), y = simd_load(ay + i), z = simd_load(az + i);
+        simd_t squared = simd_fmadd(z, z, simd_fmadd(y, y, simd_mul(x, x)));
+        if (simd_outside(squared, smallest, largest))
+        {
+            for (size_t j = i; j < i + SIMD_WIDTH; ++ j)
+            {
+                normalizeScaled(ax[j], ay[j], az[j], out, j);
+            }
+            continue;
+        }
+        simd_t scale = simd_rsqrt(squared);
+        simd_store(ox + i, simd_mul(x, scale));
+        simd_store(oy + i, simd_mul(y, scale));
+        simd_store(oz + i, simd_mul(z, scale));
+    }
+    for (; i < n; ++ i)
+    {
+        normalizeScaled(ax[i], ay[i], az[i], out, i);
+    }
+}
+
+/**
+* out[i] = a[i].dist(b[i])
+* @param a first array
+* @param b second array
+* @param out the distances
+*/
+void batch_dist(const Vector3DArray &a, const Vector3DArray &b, vector<double> &out)
+{
+    INSTRUMENT_SCOPE("batch_dist");
+    if (a.size() != b.size())
+    {
+        cerr << SIZE_ERROR << endl;
+        return;
+    }
+    out.resize(a.size());
+    const double *ax = a.x(), *ay = a.y(), *az = a.z();
+    const double *bx = b.x(), *by = b.y(), *bz = b.z();
+    double *o = out.data();
+    size_t n = a.size(), i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        simd_t x = simd_sub(simd_load(ax + i), simd_load(bx + i));
+        simd_t y = simd_sub(simd_load(ay + i), simd_load(by + i));
+        simd_t z = simd_sub(simd_load(az + i), simd_load(bz + i));
+        simd_t squared = simd_fmadd(z, z, simd_fmadd(y, y, simd_mul(x, x)));
+        simd_store(o + i, simd_sqrt(squared));
+    }
+    for (; i < n; ++ i)
+    {
+        double x = ax[i] - bx[i], y = ay[i] - by[i], z = az[i] - bz[i];
+        o[i] = sqrt(x * x + y * y + z * z);
+    }
+}
+
+/**
+* out[i] = matrix * a[i]
+* @param matrix to multiply with
+* @param a array
+* @param out result array, may be a itself
+*/
+void batch_multiply(const Matrix3D &matrix, const Vector3DArray &a, Vector3DArray &out)
+{
+    INSTRUMENT_SCOPE("batch_multiply");
+    out.resize(a.size());
+    const double *ax = a.x(), *ay = a.y(), *az = a.z();
+    double *ox = out.x(), *oy = out.y(), *oz = out.z();
+    double m[3][3];
+    for (int row = 0; row < 3; ++ row)
+    {
+        for (int col = 0; col < 3; ++ col)
+        {
+            m[row][col] = matrix[row][col];
+        }
+    }
+    // the matrix is broadcast into registers once, then every point is 9 fused mul-adds
+    simd_t m00 = simd_set(m[0][0]), m01 = simd_set(m[0][1]), m02 = simd_set(m[0][2]);
+    simd_t m10 = simd_set(m[1][0]), m11 = simd_set(m[1][1]), m12 = simd_set(m[1][2]);
+    simd_t m20 = simd_set(m[2][0]), m21 = simd_set(m[2][1]), m22 = simd_set(m[2][2]);
+    size_t n = a.size(), i = 0;
+    for (; i + SIMD_WIDTH <= n; i += SIMD_WIDTH)
+    {
+        simd_t x = simd_load(ax + i), y = simd_load(ay + i), z = simd_load(az + i);
+        simd_store(ox + i, simd_fmadd(m02, z, simd_fmadd(m01, y, simd_mul(m00, x))));
+        simd_store(oy + i, simd_fmadd(m12, z, simd_fmadd(m11, y, simd_mul(m10, x))));
+        simd_store(oz + i, simd_fmadd(m22, z, simd_fmadd(m21, y, simd_mul(m20, x))));
+    }
+    for (; i < n; ++ i)
+    {
+        double x = ax[i], y = ay[i], z = az[i];
+        ox[i] = m[0][0] * x + m[0][1] * y + m[0][2] * z;
+        oy[i] = m[1][0] * x + m[1][1] * y + m[1][2] * z;
+        oz[i] = m[2][0] * x + m[2][1] * y + m[2][2] * z;
+    }
+}
@@ -0,0 +1,209 @@
+// Created by liorP.
+//
+
+#ifndef EX1_VECTOR3DARRAY_H
+#define EX1_VECTOR3DARRAY_H
+
+#include <cstddef>
+#include <vector>
+#include "Matrix3D.h"
+
+template<typename E>
+struct ArrayExpr;
+
+/**
+ * A structure-of-arrays container of Vector3D.
+ * The x, y and z coordinates are kept in three separate, cache line aligned streams so the
+ * batch kernels below can process SIMD_WIDTH points per instruction.
+ */
+class Vector3DArray
+{
+public:
+    /**
+     * A constructor.
+     * inits size zero vectors, throws bad_alloc if they do not fit in memory.
+     * @param size number of vectors
+     */
+    explicit Vector3DArray(size_t size = 0);
+
+    /**
+     * A constructor - converts from an array of vectors.
+     * @param vectors the vectors to copy
+     */
+    explicit Vector3DArray(const vector<Vector3D> &vectors);
+
+    /**
+     * A copy constructor.
+     * @param other array to copy from
+     */
+    Vector3DArray(const Vector3DArray &other);
+
+    /**
+     * A move constructor.
+     * @param other array to take the streams of
+     */
+    Vector3DArray(Vector3DArray &&other) noexcept;
+
+    /**
+     * A constructor - evaluates an array expression (see ArrayExpr.h).
+     * @param expr the expression
+     */
+    template<typename E>
+    Vector3DArray(const ArrayExpr<E> &expr);
+
+    /**
+     * A destructor.
+     */
+    ~Vector3DArray();
+
+    /**
+     * = operator overload.
+     * @param other array to copy from
+     * @return reference to this array
+     */
+    Vector3DArray &operator=(Vector3DArray other) noexcept;
+
+    /**
+     * = operator overload - evaluates an array expression (see ArrayExpr.h) in a single pass.
+     * @param expr the expression
+     * @return reference to this array
+     */
+    template<typename E>
+    Vector3DArray &operator=(const ArrayExpr<E> &expr);
+
+    /**
+     * resizes the array. kept vectors keep their values, new ones are zero.
+     * @param size new number of vectors
+     */
+    void resize(size_t size);
+
+    /**
+     * @return number of vectors in the array
+     */
+    size_t size() const { return _size; }
+
+    /**
+     * @return the x stream
+     */
+    double *x() { return _x; }
+
+    /**
+     * @return the x stream
+     */
+    const double *x() const { return _x; }
+
+    /**
+     * @return the y stream
+     */
+    double *y() { return _y; }
+
+    /**
+     * @return the y stream
+     */
+    const double *y() const { return _y; }
+
+    /**
+     * @return the z stream
+     */
+    double *z() { return _z; }
+
+    /**
+     * @return the z stream
+     */
+    const double *z() const { return _z; }
+
+    /**
+     *[] operator overload - gathers the i'th vector from the streams
+     * @param i index of the vector
+     * @return copy of the vector
+     */
+    Vector3D operator[](size_t i) const { return Vector3D(_x[i], _y[i], _z[i]); }
+
+    /**
+     * scatters a vector into the streams.
+     * @param i index of the vector
+     * @param vector value to set
+     */
+    void set(size_t i, const Vector3D &vector)
+    {
+        _x[i] = vector[0];
+        _y[i] = vector[1];
+        _z[i] = vector[2];
+    }
+
+    /**
+     * converts back to an array of vectors.
+     * @return the vectors of this array
+     */
+    vector<Vector3D> to_vector() const;
+
+private:
+    size_t _size; /**< number of vectors. */
+    size_t _capacity; /**< length of each stream, rounded up to a full cache line. */
+    double *_x; /**< the x stream, start of the single allocation. */
+    double *_y; /**< the y stream. */
+    double *_z; /**< the z stream. */
+
+};
+
+// ------------------ Batch kernels ------------------------
+// every kernel resizes its output to the size of its input. binary kernels print an error
+// and leave their output as it is when their inputs differ in size.
+
+/**
+ * out[i] = a[i] + b[i]
+ * @param a first array
+ * @param b second array
+ * @param out result array
+ */
+void batch_add(const Vector3DArray &a, const Vector3DArray &b, Vector3DArray &out);
+
+/**
+ * out[i] = a[i] * scalar
+ * @param a array
+ * @param scalar double to multiply by
+ * @param out result array
+ */
+void batch_scale(const Vector3DArray &a, double scalar, Vector3DArray &out);
+
+/**
+ * out[i] = a[i] * b[i] (dot product)
+ * @param a first array
+ * @param b second array
+ * @param out the dot products
+ */
+void batch_dot(const Vector3DArray &a, const Vector3DArray &b, vector<double> &out);
+
+/**
+ * out[i] = a[i].norm()
+ * @param a array
+ * @param out the norms
+ */
+void batch_norm(const Vector3DArray &a, vector<double> &out);
+
+/**
+ * out[i] = a[i] / a[i].norm(), scaled by a reciprocal square root instead of a division.
+ * zero vectors stay zero. vectors whose squared norm underflows or overflows (a norm below
+ * about 1.5e-154 or above 1.3e154) are scaled by a power of two first, one at a time.
+ * @param a array
+ * @param out result array, may be a itself
+ */
+void batch_normalize(const Vector3DArray &a, Vector3DArray &out);
+
+/**
+ * out[i] = a[i].dist(b[i])
+ * @param a first array
+ * @param b second array
+ * @param out the distances
+ */
+void batch_dist(const Vector3DArray &a, const Vector3DArray &b, vector<double> &out);
+
+/**
+ * out[i] = matrix * a[i]
+ * @param matrix to multiply with
+ * @param a array
+ * @param out result array, may be a itself
+ */
+void batch_multiply(const Matrix3D &matrix, const Vector3DArray &a, Vector3DArray &out);
+
+#endif //EX1_VECTOR3DARRAY_H
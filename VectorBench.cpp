@@ -0,0 +1,177 @@
+// Created by liorP.
+//
+
+#include <sstream>
+#include "BenchData.h"
+#include "Benchmark.h"
+
+// --------------------------------------------------------------------------------------
+// Micro benchmarks of every operator of Vector3D.
+// "latency" runs a chain of BENCH_CHAIN dependent ops, "throughput" runs the op over
+// arrays of BENCH_ARRAY points.
+// --------------------------------------------------------------------------------------
+
+/**
+ * times a chain of dependent ops on a single vector.
+ * @param bench to measure with
+ * @param name of the op
+ * @param op changes the vector it gets, so the next op depends on it
+ */
+template<typename Op>
+static void latency(Bench &bench, const string &name, Op op)
+{
+    Vector3D acc(1.5, - 2.5, 3.5);
+    bench.measure(name + "/latency", BENCH_CHAIN, [&]() {
+        for (int i = 0; i < BENCH_CHAIN; ++ i)
+        {
+            op(acc);
+        }
+        keep(acc);
+    });
+}
+
+/**
+ * times an op over all the indices of the benchmark arrays.
+ * @param bench to measure with
+ * @param name of the op
+ * @param op called with every index
+ */
+template<typename Op>
+static void throughput(Bench &bench, const string &name, Op op)
+{
+    bench.measure(name + "/throughput", BENCH_ARRAY, [&]() {
+        for (size_t i = 0; i < BENCH_ARRAY; ++ i)
+        {
+            op(i);
+        }
+    });
+}
+
+/**
+ * benchmarks the constructors, assignment and element access.
+ * @param bench to measure with
+ */
+static void vectorBasics(Bench &bench)
+{
+    vector<Vector3D> points = bench_points(BENCH_ARRAY), out(BENCH_ARRAY);
+    vector<double> scalars(BENCH_ARRAY);
+    const double *raw = &scalars[0];
+    throughput(bench, "Vector3D(x, y, z)", [&](size_t i) {
+        out[i] = Vector3D(scalars[i], 1.0, 2.0);
+        keep(out[i]);
+    });
+    throughput(bench, "Vector3D(double[3])", [&](size_t i) {
+        out[i] = Vector3D(raw + (i % (BENCH_ARRAY - 2)));
+        keep(out[i]);
+    });
+    throughput(bench, "Vector3D(const Vector3D &)", [&](size_t i) {
+        Vector3D copy(points[i]);
+        keep(copy);
+    });
+    throughput(bench, "Vector3D::operator=", [&](size_t i) { out[i] = points[i]; keep(out[i]); });
+    latency(bench, "Vector3D::operator[]", [](Vector3D &v) { v[0] = v[(int) v[0] & 1] + 1; });
+    throughput(bench, "Vector3D::operator[]", [&](size_t i) { scalars[i] = points[i][(int) (i % 3)]; });
+    throughput(bench, "Vector3D::operator[] const", [&](size_t i) {
+        const Vector3D &point = points[i];
+        scalars[i] = point[0] + point[1] + point[2];
+    });
+}
+
+BENCHMARK(vectorBasics);
+
+/**
+ * benchmarks the arithmetic operators.
+ * @param bench to measure with
+ */
+static void vectorArithmetic(Bench &bench)
+{
+    vector<Vector3D> points = bench_points(BENCH_ARRAY), others = bench_points(BENCH_ARRAY, 2), out(BENCH_ARRAY);
+    const Vector3D shift(0.25, - 0.5, 1.0);
+    latency(bench, "Vector3D::operator+", [&](Vector3D &v) { v = v + shift; });
+    throughput(bench, "Vector3D::operator+", [&](size_t i) { out[i] = points[i] + others[i]; });
+    latency(bench, "Vector3D::operator-", [&](Vector3D &v) { v = v - shift; });
+    throughput(bench, "Vector3D::operator-", [&](size_t i) { out[i] = points[i] - others[i]; });
+    latency(bench, "Vector3D::operator+=(v)", [&](Vector3D &v) { v += shift; });
+    throughput(bench, "Vector3D::operator+=(v)", [&](size_t i) { out[i] += points[i]; });
+    latency(bench, "Vector3D::operator-=(v)", [&](Vector3D &v) { v -= shift; });
+    throughput(bench, "Vector3D::operator-=(v)", [&](size_t i) { out[i] -= points[i]; });
+    latency(bench, "Vector3D::operator+=(d)", [](Vector3D &v) { v += 0.5; });
+    throughput(bench, "Vector3D::operator+=(d)", [&](size_t i) { out[i] += 0.5; });
+    latency(bench, "Vector3D::operator-=(d)", [](Vector3D &v) { v -= 0.5; });
+    throughput(bench, "Vector3D::operator-=(d)", [&](size_t i) { out[i] -= 0.5; });
+    latency(bench, "Vector3D::operator-()", [](Vector3D &v) { v = - v; });
+    throughput(bench, "Vector3D::operator-()", [&](size_t i) { out[i] = - points[i]; });
+    // multiplying by -1 keeps the values away from overflow and denormals
+    latency(bench, "Vector3D::operator*(d)", [](Vector3D &v) { v = v * - 1.0; });
+    throughput(bench, "Vector3D::operator*(d)", [&](size_t i) { out[i] = points[i] * 1.5; });
+    latency(bench, "operator*(d, Vector3D)", [](Vector3D &v) { v = - 1.0 * v; });
+    throughput(bench, "operator*(d, Vector3D)", [&](size_t i) { out[i] = 1.5 * points[i]; });
+    latency(bench, "Vector3D::operator/", [](Vector3D &v) { v = v / - 1.0; });
+    throughput(bench, "Vector3D::operator/", [&](size_t i) { out[i] = points[i] / 1.5; });
+    latency(bench, "Vector3D::operator*=", [](Vector3D &v) { v *= - 1.0; });
+    throughput(bench, "Vector3D::operator*=", [&](size_t i) { out[i] *= - 1.0; });
+    latency(bench, "Vector3D::operator/=", [](Vector3D &v) { v /= - 1.0; });
+    throughput(bench, "Vector3D::operator/=", [&](size_t i) { out[i] /= - 1.0; });
+    keep(out);
+}
+
+BENCHMARK(vectorArithmetic);
+
+/**
+ * benchmarks the products, norm, distance and angle.
+ * @param bench to measure with
+ */
+static void vectorMetrics(Bench &bench)
+{
+    vector<Vector3D> points = bench_points(BENCH_ARRAY), others = bench_points(BENCH_ARRAY, 2);
+    vector<double> scalars(BENCH_ARRAY);
+    const Vector3D other(0.25, - 0.5, 1.0);
+    latency(bench, "Vector3D::operator*(v)", [&](Vector3D &v) { v[0] = v * other; });
+    throughput(bench, "Vector3D::operator*(v)", [&](size_t i) { scalars[i] = points[i] * others[i]; });
+    latency(bench, "Vector3D::operator|", [&](Vector3D &v) { v[0] = v | other; });
+    throughput(bench, "Vector3D::operator|", [&](size_t i) { scalars[i] = points[i] | others[i]; });
+    latency(bench, "Vector3D::dist", [&](Vector3D &v) { v[0] = v.dist(other); });
+    throughput(bench, "Vector3D::dist", [&](size_t i) { scalars[i] = points[i].dist(others[i]); });
+    latency(bench, "Vector3D::norm", [](Vector3D &v) { v[0] = v.norm(); });
+    throughput(bench, "Vector3D::norm", [&](size_t i) { scalars[i] = points[i].norm(); });
+    latency(bench, "Vector3D::operator^", [&](Vector3D &v) { v[0] = v ^ other; });
+    throughput(bench, "Vector3D::operator^", [&](size_t i) { scalars[i] = points[i] ^ others[i]; });
+    keep(scalars);
+}
+
+BENCHMARK(vectorMetrics);
+
+/**
+ * benchmarks the stream operators.
+ * @param bench to measure with
+ */
+static void vectorStreams(Bench &bench)
+{
+    const size_t count = BENCH_ARRAY / 16;
+    vector<Vector3D> points = bench_points(count);
+    bench.measure("operator<<(ostream, Vector3D)/throughput", count, [&]() {
+        ostringstream os;
+        for (const Vector3D &point : points)
+        {
+            os << point << '\n';
+        }
+        keep(os);
+    });
+    ostringstream text;
+    for (const Vector3D &point : points)
+    {
+        text << point << '\n';
+    }
+    const string input = text.str();
+    bench.measure("operator>>(istream, Vector3D)/throughput", count, [&]() {
+        istringstream is(input);
+        Vector3D point;
+        for (size_t i = 0; i < count; ++ i)
+        {
+            is >> point;
+        }
+        keep(point);
+    });
+}
+
+BENCHMARK(vectorStreams);